@@ -0,0 +1,83 @@
+#!/bin/bash
+
+# Runs the restaurant over a grid of parameters and appends one CSV line per run to $CSV.
+# The grid is set by the environment, each variable is a list of values:
+#   NGROUPS number of groups (Poisson arrivals)        RATE    arrival rate (groups/s)
+#   TABLES  number of tables (of SEATS seats each)     EAT     meal time (us)
+#   LOGS    logging backend: file, stdout or null      RUNS    runs per point
+#   PLACEMENT  placements of the entities on CPUs (NONE, ISOLATED, ONECORE, or CUSTOM lists with
+#              the spaces replaced by colons, e.g. CUSTOM:0:1:2:3-7)
+#   REALTIME   scheduling policies of the servers (OFF, FIFO or RR, with an optional priority: FIFO:50)
+#   SHARDS     numbers of shards, with an optional dispatching policy (LEAST or P2C: 4:P2C); the arrival
+#              rate and the number of groups are those of the whole run
+#   COROUTINES numbers of processes hosting the groups as coroutines (0: a process per group)
+#   EVENTS     event loops of the waiter and the receptionist (OFF or ON, with an optional tick: ON:50)
+#   LAUNCH     launch of the groups (EXEC or FORKSERVER; FORKSERVER requires COROUTINES=0)
+#   SLOTS      group slots of each shard, the groups that may be in it at once (see scale.sh)
+
+NGROUPS=${NGROUPS:-"20 50"}
+RATE=${RATE:-20}
+TABLES=${TABLES:-"2 4"}
+SEATS=${SEATS:-4}
+EAT=${EAT:-"50000 200000"}
+LOGS=${LOGS:-"file null"}
+RUNS=${RUNS:-1}
+PLACEMENT=${PLACEMENT:-NONE}
+REALTIME=${REALTIME:-OFF}
+SHARDS=${SHARDS:-1}
+COROUTINES=${COROUTINES:-0}
+EVENTS=${EVENTS:-OFF}
+LAUNCH=${LAUNCH:-EXEC}
+SLOTS=${SLOTS:-16}
+CSV=${CSV:-bench.csv}
+
+cp config.txt config.txt.bench
+trap 'mv config.txt.bench config.txt' EXIT
+
+for groups in $NGROUPS; do
+  for tables in $TABLES; do
+    for eat in $EAT; do
+      for log in $LOGS; do
+        for place in $PLACEMENT; do
+          for rt in $REALTIME; do
+            for shards in $SHARDS; do
+              for hosts in $COROUTINES; do
+                for ev in $EVENTS; do
+                  for launch in $LAUNCH; do
+                    for slots in $SLOTS; do
+                      {
+                        echo "#tables";   for t in $(seq 1 $tables); do echo -n "$SEATS "; done; echo
+                        echo "#arrivals"; echo "POISSON $RATE $groups"
+                        echo "#mealtime"; echo "CONST $eat"
+                        echo "#groupsize"; echo "1 $SEATS"
+                        echo "#realtime"; echo "${rt//:/ }"
+                        echo "#shards";   echo "${shards//:/ }"
+                        echo "#coroutines"; echo "$hosts"
+                        echo "#events";   echo "${ev//:/ }"
+                        echo "#launch";   echo "$launch"
+                        echo "#slots";    echo "$slots"
+                      } > config.txt
+                      case $log in
+                        file)   logFile=bench.log;;
+                        null)   logFile=/dev/null;;
+                        *)      logFile="";;
+                      esac
+                      for i in $(seq 1 $RUNS); do
+                        echo -e "\e[34;1mgroups=$groups tables=$tables eat=$eat log=$log placement=$place realtime=$rt shards=$shards hosts=$hosts events=$ev launch=$launch slots=$slots run $i\e[0m"
+                        rm -f bench.log*
+                        ./probSemSharedMemRestaurant -p "${place//:/ }" "$logFile" "$CSV" > /dev/null || exit 1
+                      done
+                    done
+                  done
+                done
+              done
+            done
+          done
+        done
+      done
+    done
+  done
+done
+rm -f bench.log*
+
+column -s, -t < "$CSV" 2>/dev/null || cat "$CSV"
@@ -1,5 +1,11 @@
 #!/bin/bash
 
+# Runs the restaurant n times. Each run appends a one-line JSON summary to $SUMMARY (runs.jsonl by
+# default, written anew by each batch) and only the runs that fail are reported, with their exit
+# status, wall time and error output; the distributions across all runs are printed at the end (see
+# runStats). The logs go to $LOG (/dev/null by default); VERBOSE=1 prints them and the statistics
+# of every run, as before.
+
 case $# in
     0) n=1000;;
     1) n=$1;;
@@ -11,8 +17,29 @@ if ! [ $n -gt 0 ] 2>/dev/null; then
     exit 1
 fi
 
+SUMMARY=${SUMMARY:-runs.jsonl}
+LOG=${LOG:-/dev/null}
+
+rm -f "$SUMMARY"
+failed=0
 for i in $(seq 1 $n)
 do
-     echo -e "\n\e[34;1mRun n.º $i\e[0m"
-     ./probSemSharedMemRestaurant
+     if [ -n "$VERBOSE" ]; then
+         echo -e "\n\e[34;1mRun n.º $i\e[0m"
+         ./probSemSharedMemRestaurant -s "$SUMMARY" || failed=$((failed + 1))
+     else
+         start=$(date +%s%N)
+         ./probSemSharedMemRestaurant -s "$SUMMARY" "$LOG" > /dev/null 2> run.err
+         rc=$?
+         if [ $rc -ne 0 ]; then
+             failed=$((failed + 1))
+             echo -e "\e[31;1mRun n.º $i failed\e[0m (exit status $rc, $(( ($(date +%s%N) - start) / 1000000 )) ms)"
+             cat run.err
+         fi
+         echo -ne "$i runs, $failed failed\r"
+     fi
 done
+rm -f run.err
+echo -e "\n$n runs, $failed failed"
+
+./runStats "$SUMMARY"
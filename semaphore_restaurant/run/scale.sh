@@ -0,0 +1,63 @@
+#!/bin/bash
+
+# Runs the restaurant with many groups inside at once: the groups arrive much faster than the tables
+# are left, so they pile up in the waiting room, up to the number of group slots. Hosted as coroutines,
+# the groups have no semaphores of their own (see notice.h), so the semaphore set does not grow with
+# the slots. For each point, the most groups inside and waiting at once, the semaphores of the set and
+# the throughput are reported. The points are set by the environment, each variable is a list of values:
+#   SLOTS    group slots (up to MAXGROUPS)             HOSTS    processes hosting the groups (0: a process per group)
+#   NGROUPS  number of groups (Poisson arrivals)       RATE     arrival rate (groups/s)
+#   TABLES   number of tables (of SEATS seats each)    EAT      meal time (us)
+#   COOK     cooking time of a dish (ms)               RUNS     runs per point
+# The dishes are cooked on a station of the kitchen that cooks 64 at once, so the chef, who otherwise cooks
+# each order for 100 to 200 ms, one at a time, does not set the throughput.
+# Each run appends its summary to $SCALE (written anew).
+
+SLOTS=${SLOTS:-"16 256 1024 4096"}
+HOSTS=${HOSTS:-4}
+NGROUPS=${NGROUPS:-4000}
+RATE=${RATE:-4000}
+TABLES=${TABLES:-16}
+SEATS=${SEATS:-4}
+EAT=${EAT:-2000}
+COOK=${COOK:-5}
+RUNS=${RUNS:-1}
+SCALE=${SCALE:-scale.jsonl}
+
+cp config.txt config.txt.scale
+trap 'mv config.txt.scale config.txt; rm -f scale.out scale.err' EXIT
+
+rm -f "$SCALE"
+printf "%6s %6s %4s %12s %12s %11s %10s\n" slots hosts run inside_max waiting_max semaphores groups/s
+for slots in $SLOTS; do
+  for hosts in $HOSTS; do
+    for tables in $TABLES; do
+      for eat in $EAT; do
+        {
+          echo "#tables";     for t in $(seq 1 $tables); do echo -n "$SEATS "; done; echo
+          echo "#arrivals";   echo "POISSON $RATE $NGROUPS"
+          echo "#mealtime";   echo "CONST $eat"
+          echo "#groupsize";  echo "1 $SEATS"
+          echo "#slots";      echo "$slots"
+          echo "#coroutines"; echo "$hosts"
+          echo "#stations";   echo "grill 64"
+          echo "#menu";       echo "steak grill $COOK"
+        } > config.txt
+        for i in $(seq 1 $RUNS); do
+          ./probSemSharedMemRestaurant -s "$SCALE" /dev/null > scale.out 2> scale.err
+          rc=$?
+          if [ $rc -ne 0 ]; then
+            echo -e "\e[31;1mslots=$slots hosts=$hosts run $i failed\e[0m (exit status $rc)"
+            grep -v "opening log" scale.err
+            continue
+          fi
+          sems=$(sed -n 's/.*hosts, \([0-9]*\) semaphores).*/\1/p' scale.out)
+          tail -1 "$SCALE" | awk -F'[:,]' -v slots=$slots -v hosts=$hosts -v run=$i -v sems=$sems '
+            { for (k = 1; k < NF; k++) { gsub (/[{}"]/, "", $k); v[$k] = $(k + 1) } }
+            END { printf "%6d %6d %4d %12d %12d %11d %10.1f\n", slots, hosts, run, v["inside_max"], v["waiting_max"],
+                  sems, v["groups_per_s"] }'
+        done
+      done
+    done
+  done
+done
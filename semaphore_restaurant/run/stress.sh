@@ -0,0 +1,55 @@
+#!/bin/bash
+
+# Runs the restaurant with random delays injected into the entities (see jitter.h) at several levels and
+# reports the runs that stalled or failed and, for each level, the throughput relative to the first one.
+# The levels are set by the environment:
+#   JITTER   delay distributions (us), with the spaces replaced by colons (OFF, CONST:d, UNIFORM:a:b,
+#            NORMAL:mean:dev or EXP:mean); the first level is the baseline
+#   POINTS   points where the delays are injected (MUTEX, REQUEST and/or SAVE, all by default)
+#   RUNS     runs per level                          WATCHDOG time without a change of state (ms)
+#   NGROUPS  number of groups (Poisson arrivals)     RATE     arrival rate (groups/s)
+# Each run appends its summary to $STRESS (written anew); the other sections of config.txt are kept.
+
+JITTER=${JITTER:-"OFF EXP:100 EXP:500 EXP:2000"}
+POINTS=${POINTS:-"MUTEX REQUEST SAVE"}
+RUNS=${RUNS:-10}
+WATCHDOG=${WATCHDOG:-5000}
+NGROUPS=${NGROUPS:-20}
+RATE=${RATE:-5}
+STRESS=${STRESS:-stress.jsonl}
+
+cp config.txt config.txt.stress
+trap 'mv config.txt.stress config.txt; rm -f stress.err' EXIT
+
+rm -f "$STRESS"
+stalled=0
+failed=0
+for jit in $JITTER; do
+  {
+    cat config.txt.stress
+    echo "#arrivals"; echo "POISSON $RATE $NGROUPS"
+    echo "#jitter";   if [ "$jit" = OFF ]; then echo OFF; else echo "${jit//:/ } $POINTS"; fi
+    echo "#watchdog"; echo "$WATCHDOG"
+  } > config.txt
+  for i in $(seq 1 $RUNS); do
+    echo -ne "jitter=$jit run $i\e[K\r"
+    ./probSemSharedMemRestaurant -s "$STRESS" /dev/null > /dev/null 2> stress.err
+    rc=$?
+    if grep -q "Run stalled" stress.err; then
+      stalled=$((stalled + 1))
+      echo -e "\e[31;1mjitter=$jit run $i stalled\e[0m"
+      grep -v "opening log" stress.err
+    elif [ $rc -ne 0 ]; then
+      failed=$((failed + 1))
+      echo -e "\e[31;1mjitter=$jit run $i failed\e[0m (exit status $rc)"
+      grep -v "opening log" stress.err
+    fi
+  done
+done
+echo -e "\e[K$(wc -l < "$STRESS") runs, $stalled stalled, $failed failed"
+
+# throughput (median of the runs) of each level, relative to the baseline
+./runStats -c -g jitter "$STRESS" | awk -F, '
+  $2 == "groups_per_s" { if (base == "") base = $5
+                         printf "%-40s %8.2f groups/s  %6.1f %%\n", $1, $5, (base > 0) ? 100 * $5 / base : 0 }
+  $2 == "stalled=true" { printf "%-40s %8d stalled\n", $1, $3 }'
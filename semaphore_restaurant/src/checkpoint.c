@@ -0,0 +1,188 @@
+/**
+ *  \file checkpoint.c (implementation file)
+ *
+ *  \brief Problem name: Restaurant
+ *
+ *  \brief Checkpoint and resume of a run.
+ *
+ *  The checkpoint file is a header, naming the format and the size of the checkpoint of a shard (so a
+ *  file saved by another build is rejected), followed by the checkpoint, up to the last shard.
+ *
+ *  Defined operations:
+ *     \li checking for a quiescent point
+ *     \li saving a checkpoint
+ *     \li loading a checkpoint
+ *     \li checking the layout of the restaurant against a checkpoint
+ *     \li restoring a shard from a checkpoint.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "probConst.h"
+#include "probDataStruct.h"
+#include "sharedDataSync.h"
+#include "semaphore.h"
+#include "checkpoint.h"
+
+/** \brief format of the checkpoint file */
+#define  CKPTMAGIC      "RESTCKP1"
+
+/**
+ *  \brief Definition of the header of the checkpoint file.
+ */
+typedef struct {
+    /** \brief format (CKPTMAGIC) */
+    char magic[8];
+    /** \brief size of the checkpoint of a shard */
+    unsigned int size;
+} CKPT_HEADER;
+
+/** \brief size of the part of a checkpoint saved for n shards */
+#define  CKPTSIZE(n)    (offsetof (CHECKPOINT, shard) + (n) * sizeof (CKPT_SHARD))
+
+bool checkpointQuiet (SHARED_DATA *sh, unsigned short sem[], bool inside[])
+{
+    FULL_STAT *f = &sh->fSt;
+    int g;
+
+    if (f->closing || (f->receptionistQueue.n > 0) || (f->waiterQueue.n > 0) || (f->nFoodReady > 0) ||
+        f->foodReadyPending) {
+        return false;
+    }
+    if ((sem[RECEPTIONISTREQ] > 0) || (sem[WAITERREQUEST] > 0) || (sem[WAITORDER] > 0) || (sem[ORDERRECEIVED] > 0)) {
+        return false;                                                  /* requests not yet taken by a server */
+    }
+    for (g = 0; g < f->nGroups; g++) {
+        if (!inside[g]) {
+            continue;
+        }
+        switch (f->st.groupStat[g]) {
+            case GOTOREST:
+            case EAT:
+                break;
+            case ATRECEPTION:                                 /* the receptionist must have handled its request */
+                if ((f->reception.groupRecord[g] != WAIT) && (f->reception.groupRecord[g] != ATTABLE)) {
+                    return false;
+                }
+                break;
+            default:                                                   /* waiting on the waiter or the chef */
+                return false;
+        }
+    }
+    return true;
+}
+
+void checkpointSave (char nFic[], CHECKPOINT *ck)
+{
+    FILE *fp;
+    CKPT_HEADER hd;
+
+    memcpy (hd.magic, CKPTMAGIC, sizeof (hd.magic));
+    hd.size = sizeof (CKPT_SHARD);
+    if ((fp = fopen (nFic, "wb")) == NULL) {
+        perror ("error on creating the checkpoint file");
+        exit (EXIT_FAILURE);
+    }
+    if ((fwrite (&hd, sizeof (hd), 1, fp) != 1) || (fwrite (ck, CKPTSIZE (ck->nShards), 1, fp) != 1) ||
+        (fclose (fp) == EOF)) {
+        perror ("error on writing the checkpoint file");
+        exit (EXIT_FAILURE);
+    }
+}
+
+void checkpointLoad (char nFic[], CHECKPOINT *ck)
+{
+    FILE *fp;
+    CKPT_HEADER hd;
+
+    if ((fp = fopen (nFic, "rb")) == NULL) {
+        perror ("error on opening the checkpoint file");
+        exit (EXIT_FAILURE);
+    }
+    if ((fread (&hd, sizeof (hd), 1, fp) != 1) || (memcmp (hd.magic, CKPTMAGIC, sizeof (hd.magic)) != 0) ||
+        (hd.size != sizeof (CKPT_SHARD)) || (fread (ck, CKPTSIZE (1), 1, fp) != 1) ||
+        (ck->nShards < 1) || (ck->nShards > MAXSHARDS) ||
+        (fread (&ck->shard[1], sizeof (CKPT_SHARD), ck->nShards - 1, fp) != (size_t) (ck->nShards - 1))) {
+        fprintf (stderr, "%s: not a checkpoint of this build of the restaurant\n", nFic);
+        exit (EXIT_FAILURE);
+    }
+    fclose (fp);
+}
+
+bool checkpointMatch (CKPT_SHARD *cs, FULL_STAT *p_fSt)
+{
+    FULL_STAT *f = &cs->shared.fSt;
+
+    return (f->nGroups == p_fSt->nGroups) && (f->nTables == p_fSt->nTables) && (f->tableShare == p_fSt->tableShare) &&
+           (f->tableJoin == p_fSt->tableJoin) &&
+           (memcmp (f->tableCapacity, p_fSt->tableCapacity, f->nTables * sizeof (int)) == 0);
+}
+
+void checkpointRestore (CKPT_SHARD *cs, SHARED_DATA *sh, int semgid, long long start, long long taken)
+{
+    FULL_STAT *src = &cs->shared.fSt, *dst = &sh->fSt;
+    unsigned short val[MAXSEMS];
+    long long shift = start - taken;
+    int g, t, st;
+
+    /* state of the entities, groups and tables */
+    dst->st = src->st;
+    dst->groupsWaiting = src->groupsWaiting;
+    memcpy (dst->startTime, src->startTime, sizeof (dst->startTime));
+    memcpy (dst->eatTime, src->eatTime, sizeof (dst->eatTime));
+    memcpy (dst->groupSize, src->groupSize, sizeof (dst->groupSize));
+    memcpy (dst->groupArrival, src->groupArrival, sizeof (dst->groupArrival));
+    memcpy (dst->assignedTable, src->assignedTable, sizeof (dst->assignedTable));
+    memcpy (dst->groupTables, src->groupTables, sizeof (dst->groupTables));
+    memcpy (dst->tableSeats, src->tableSeats, sizeof (dst->tableSeats));
+    dst->reception = src->reception;
+
+    /* times: shifted, and the occupation of tables and seats counted from the start of operations */
+    for (g = 0; g < dst->nGroups; g++) {
+        dst->resumed[g] = cs->inside[g];
+        if (!cs->inside[g]) {
+            continue;
+        }
+        for (st = 0; st < GROUPSTATES; st++) {
+            dst->stateTime[g][st] = (src->stateTime[g][st] != 0) ? src->stateTime[g][st] + shift : 0;
+        }
+        dst->arrivalTime[g] = src->arrivalTime[g] + shift;
+        dst->wakeTime[g] = (src->wakeTime[g] != 0) ? src->wakeTime[g] + shift : 0;
+        dst->reception.seatSince[g] = start;
+    }
+    for (t = 0; t < dst->nTables; t++) {
+        dst->reception.tableSince[t] = start;
+    }
+    dst->admission.depthSince = start;                   /* groups restored waiting are counted from the start */
+    dst->admission.depth.last = dst->groupsWaiting;
+
+    /* semaphores of the requests and of the groups, or notices if the groups are coroutines (the mutex was
+       held when the state was saved, a group holding a request slot downs it again and a seated group at
+       reception waits for its table again); the groups of the saved run may have been launched otherwise */
+    if (semGetAll (semgid, val) == -1) {
+        perror ("error on reading the semaphore set");
+        exit (EXIT_FAILURE);
+    }
+    for (t = MUTEX; (t < WAITFORTABLE) && (t < cs->nSems); t++) {
+        val[t] = cs->sem[t];
+    }
+    val[MUTEX] = 1;
+    val[RECEPTIONISTREQUESTPOSSIBLE] = 1;
+    val[WAITERREQUESTPOSSIBLE] = 1;
+    for (g = 0; g < dst->nGroups; g++) {
+        if (cs->inside[g] && (src->st.groupStat[g] == ATRECEPTION) && (src->reception.groupRecord[g] == ATTABLE)) {
+            if (COROUTINES (dst)) {
+                dst->notice[g][NOTE_TABLE] = 1;
+            }
+            else val[sh->waitForTable[g]] = 1;
+        }
+    }
+    if (semSetAll (semgid, val) == -1) {
+        perror ("error on setting the semaphore set");
+        exit (EXIT_FAILURE);
+    }
+}
@@ -0,0 +1,139 @@
+/**
+ *  \file checkpoint.h (interface file)
+ *
+ *  \brief Problem name: Restaurant
+ *
+ *  \brief Checkpoint and resume of a run.
+ *
+ *  A checkpoint holds, for every shard, the shared region, the values of the semaphores and the slots
+ *  with a group inside, plus the number of groups that arrived so far
+ *  and where the open-loop arrivals stand (their clock and random stream). The position of each entity in
+ *  its life cycle is that of the shared region: the servers keep no state of their own between
+ *  requests (the view of the receptionist is in the shared region, see RECEPTION) and each group is in
+ *  the state recorded in it.
+ *
+ *  The state is only saved at a quiescent point, found by the main program holding the mutex of every
+ *  shard: no request is outstanding or being served, so the servers wait for requests, and every group
+ *  inside is going to the restaurant, waiting for a table (or seated, about to order) or eating. These
+ *  are the points a group can resume from: the sleeps are resumed until their saved wake time and a
+ *  group at reception waits for its table again (a seated one finds its up there once more). A group
+ *  that got the request slot of a server but not yet the mutex is at one of these points as well: it
+ *  asks again for the slot, set free on resume.
+ *
+ *  On resume, the time stops while the run is not running: the saved times are shifted by the time
+ *  from the checkpoint until the start of operations of the resumed run. The statistics start anew,
+ *  and the options of the run (policy, arrivals, events, launch, placement, ...) are those of the
+ *  config file; only the layout of the restaurant (shards, group slots and tables) must be the same.
+ *
+ *  Defined operations:
+ *     \li checking for a quiescent point
+ *     \li saving a checkpoint
+ *     \li loading a checkpoint
+ *     \li checking the layout of the restaurant against a checkpoint
+ *     \li restoring a shard from a checkpoint.
+ */
+
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+
+#include <stdbool.h>
+
+#include "probConst.h"
+#include "probDataStruct.h"
+#include "sharedDataSync.h"
+#include "rng.h"
+
+/**
+ *  \brief Definition of the checkpoint of a shard.
+ */
+typedef struct {
+    /** \brief shared region */
+    SHARED_DATA shared;
+    /** \brief number of semaphores saved (location 0 included) */
+    int nSems;
+    /** \brief value of each semaphore (indexed by location) */
+    unsigned short sem[MAXSEMS];
+    /** \brief set for the slots with a group inside */
+    bool inside[MAXGROUPS];
+} CKPT_SHARD;
+
+/**
+ *  \brief Definition of a checkpoint.
+ */
+typedef struct {
+    /** \brief number of shards */
+    int nShards;
+    /** \brief number of groups that arrived so far */
+    int arrived;
+    /** \brief time at which the state was saved (us) */
+    long long taken;
+    /** \brief time from the start of operations until the state was saved (us) */
+    long long elapsed;
+    /** \brief arrival clock when the state was saved and time of the last arrival on it (us) */
+    long long clock, arrival;
+    /** \brief random stream of the main program after the last arrival */
+    RNG rng;
+    /** \brief checkpoint of each shard */
+    CKPT_SHARD shard[MAXSHARDS];
+} CHECKPOINT;
+
+/**
+ *  \brief Checking for a quiescent point.
+ *
+ *  To be called holding the mutex of the shard.
+ *
+ *  \param sh pointer to the shared memory region of the shard
+ *  \param sem values of the semaphores of the shard (indexed by location)
+ *  \param inside set for the slots with a group inside
+ *
+ *  \return true if the shard can be saved
+ */
+extern bool checkpointQuiet (SHARED_DATA *sh, unsigned short sem[], bool inside[]);
+
+/**
+ *  \brief Saving a checkpoint.
+ *
+ *  The program is terminated if the file can not be written.
+ *
+ *  \param nFic name of the checkpoint file
+ *  \param ck checkpoint
+ */
+extern void checkpointSave (char nFic[], CHECKPOINT *ck);
+
+/**
+ *  \brief Loading a checkpoint.
+ *
+ *  The program is terminated if the file can not be read or was not saved by this build.
+ *
+ *  \param nFic name of the checkpoint file
+ *  \param ck location where the checkpoint is stored
+ */
+extern void checkpointLoad (char nFic[], CHECKPOINT *ck);
+
+/**
+ *  \brief Checking the layout of the restaurant against a checkpoint.
+ *
+ *  \param cs checkpoint of a shard
+ *  \param p_fSt pointer to the full state of the problem, as read from the config file
+ *
+ *  \return true if the number of group slots and the tables are the same
+ */
+extern bool checkpointMatch (CKPT_SHARD *cs, FULL_STAT *p_fSt);
+
+/**
+ *  \brief Restoring a shard from a checkpoint.
+ *
+ *  The state of the restaurant is copied to the shared region, its times shifted, the groups inside
+ *  are marked to be resumed and the semaphores of the requests and of the groups are set. To be called
+ *  before the start of operations, once the groups inside were started.
+ *  The program is terminated if the semaphores can not be set.
+ *
+ *  \param cs checkpoint of the shard
+ *  \param sh pointer to the shared memory region of the shard
+ *  \param semgid semaphore set access identifier of the shard
+ *  \param start start of operations of the resumed run (us)
+ *  \param taken time at which the state was saved (us)
+ */
+extern void checkpointRestore (CKPT_SHARD *cs, SHARED_DATA *sh, int semgid, long long start, long long taken);
+
+#endif /* CHECKPOINT_H_ */
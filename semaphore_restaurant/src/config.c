@@ -0,0 +1,615 @@
+/**
+ *  \file config.c (implementation file)
+ *
+ *  \brief Problem name: Restaurant
+ *
+ *  \brief Reading the simulation parameters from the configuration file.
+ *
+ *  Defined operations:
+ *     \li parsing the configuration file into the full state of the problem
+ *     \li conversion between scheduling policy ids and names
+ *     \li conversion between arrival process ids and names
+ *     \li conversion between server scheduling policy ids and names
+ *     \li conversion between dispatching policy ids and names
+ *     \li description of the injected delays
+ *     \li description of the kitchen stations
+ *     \li description of the admission policy
+ *     \li size of the largest group that can be seated.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <stdbool.h>
+
+#include "probConst.h"
+#include "probDataStruct.h"
+
+/** \brief maximum length of a configuration line */
+#define  LINELEN        256
+
+/** \brief names of the scheduling policies, indexed by policy id */
+static const char *policyNames[NUMPOLICIES] = { "LOWESTID", "FIFO", "SMF", "EARLIEST" };
+
+/** \brief names of the arrival processes, indexed by ARRIVALS_* */
+static const char *arrivalNames[] = { "CONFIG", "POISSON", "BURSTY", "DIURNAL", "FILE" };
+
+/** \brief names of the meal time distributions, indexed by MEAL_* */
+static const char *mealNames[] = { "CONST", "UNIFORM", "NORMAL", "EXP" };
+
+/** \brief names of the server scheduling policies, indexed by REALTIME_* */
+static const char *realtimeNames[] = { "OFF", "FIFO", "RR" };
+
+/** \brief names of the replay modes, indexed by REPLAY_* */
+static const char *replayNames[] = { "OFF", "RECORD", "REPLAY" };
+
+/** \brief names of the dispatching policies, indexed by DISPATCH_* */
+static const char *dispatchNames[] = { "LEAST", "P2C" };
+
+/** \brief names of the launch modes, indexed by LAUNCH_* */
+static const char *launchNames[] = { "EXEC", "FORKSERVER" };
+
+/** \brief names of the checkpoint modes, indexed by CKPT_* */
+static const char *checkpointNames[] = { "OFF", "SAVE", "RESUME" };
+
+/** \brief names of the admission policies, indexed by ADMIT_* */
+static const char *admissionNames[] = { "OFF", "FULL", "WAIT" };
+
+/** \brief names of the points where delays are injected, indexed by bit of JIT_* */
+static const char *jitterNames[] = { "MUTEX", "REQUEST", "SAVE" };
+
+/* internal functions */
+
+static int nameIndex (char *word, const char *names[], int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++) {
+        if (strcasecmp (word, names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static bool nameValid (char *name)
+{
+    int i;
+
+    for (i = 0; name[i] != '\0'; i++) {
+        if (!isalnum ((unsigned char) name[i]) && (name[i] != '_')) {
+            return false;
+        }
+    }
+    return (i > 0);
+}
+
+static void configError (char nFic[], int line, char *msg)
+{
+    fprintf (stderr, "%s:%d: %s\n", nFic, line, msg);
+    exit (EXIT_FAILURE);
+}
+
+/* external functions */
+
+const char *policyName (int policy)
+{
+    return ((policy >= 0) && (policy < NUMPOLICIES)) ? policyNames[policy] : "?";
+}
+
+const char *realtimeName (int realtime)
+{
+    return ((realtime >= REALTIME_OFF) && (realtime <= REALTIME_RR)) ? realtimeNames[realtime] : "?";
+}
+
+const char *arrivalName (int arrivals)
+{
+    return ((arrivals >= 0) && (arrivals <= ARRIVALS_FILE)) ? arrivalNames[arrivals] : "?";
+}
+
+const char *dispatchName (int dispatch)
+{
+    return ((dispatch >= DISPATCH_LEAST) && (dispatch <= DISPATCH_P2C)) ? dispatchNames[dispatch] : "?";
+}
+
+const char *launchName (int launch)
+{
+    return ((launch >= LAUNCH_EXEC) && (launch <= LAUNCH_FORKSERVER)) ? launchNames[launch] : "?";
+}
+
+void jitterName (FULL_STAT *p_fSt, char buf[], int len)
+{
+    int n, k;
+
+    if (p_fSt->jitter == 0) {
+        snprintf (buf, len, "OFF");
+        return;
+    }
+    n = snprintf (buf, len, "%s %g", mealNames[p_fSt->jitterDist], p_fSt->jitterA);
+    if ((p_fSt->jitterDist == MEAL_UNIFORM) || (p_fSt->jitterDist == MEAL_NORMAL)) {
+        n += snprintf (buf + n, (n < len) ? len - n : 0, " %g", p_fSt->jitterB);
+    }
+    for (k = 0; k < 3; k++) {
+        if (p_fSt->jitter & (1 << k)) {
+            n += snprintf (buf + n, (n < len) ? len - n : 0, "%c%s", (p_fSt->jitter & ((1 << k) - 1)) ? '+' : ' ',
+                           jitterNames[k]);
+        }
+    }
+}
+
+void kitchenName (FULL_STAT *p_fSt, char buf[], int len)
+{
+    KITCHEN *k = &p_fSt->kitchen;
+    int n = 0, st;
+
+    if (k->nStations == 0) {
+        snprintf (buf, len, "OFF");
+        return;
+    }
+    for (st = 0; st < k->nStations; st++) {
+        n += snprintf (buf + n, (n < len) ? len - n : 0, "%s%s:%d", (st > 0) ? "+" : "", k->stationName[st],
+                       k->stationCapacity[st]);
+    }
+}
+
+void admissionName (FULL_STAT *p_fSt, char buf[], int len)
+{
+    ADMISSION *a = &p_fSt->admission;
+
+    switch (a->policy) {
+        case ADMIT_FULL:
+            snprintf (buf, len, "FULL %d", a->capacity);
+            break;
+        case ADMIT_WAIT:
+            if (a->capacity >= 0) {
+                snprintf (buf, len, "WAIT %d %d", a->maxWait, a->capacity);
+            }
+            else snprintf (buf, len, "WAIT %d", a->maxWait);
+            break;
+        default:
+            snprintf (buf, len, "OFF");
+    }
+}
+
+int largestGroup (FULL_STAT *p_fSt)
+{
+    int t, seats = 0, maxCap = 0;
+
+    for (t = 0; t < p_fSt->nTables; t++) {
+        seats += p_fSt->tableCapacity[t];
+        if (p_fSt->tableCapacity[t] > maxCap) {
+            maxCap = p_fSt->tableCapacity[t];
+        }
+    }
+    return p_fSt->tableJoin ? seats : maxCap;
+}
+
+void readConfig (char nFic[], FULL_STAT *p_fSt)
+{
+    FILE *fp;
+    char line[LINELEN], section[LINELEN], word[LINELEN];
+    char *p;
+    int nLine = 0, nRows = 0, n, t, offs, slots = NUMSLOTS;
+    GENERATOR *gen = &p_fSt->gen;
+
+    if ((fp = fopen (nFic, "r")) == NULL) {
+        perror ("Could not open config file");
+        exit (EXIT_FAILURE);
+    }
+
+    /* defaults */
+    p_fSt->nGroups = -1;
+    p_fSt->policy = POLICY_LOWESTID;
+    p_fSt->nTables = 0;
+    p_fSt->tableShare = false;
+    p_fSt->tableJoin = false;
+    strcpy (p_fSt->traceFile, "");
+    strcpy (p_fSt->placement, "");
+    p_fSt->semTiming = false;
+    p_fSt->nShards = 1;
+    p_fSt->groupHosts = 0;
+    p_fSt->coStack = COSTACK;
+    p_fSt->launch = LAUNCH_EXEC;
+    p_fSt->eventLoop = false;
+    p_fSt->eventTick = EVTICK;
+    p_fSt->dispatch = DISPATCH_LEAST;
+    p_fSt->realtime = REALTIME_OFF;
+    for (n = 0; n < NSERVERS; n++) {
+        p_fSt->rtPriority[n] = RTPRIORITY;
+    }
+    p_fSt->realtimeDenied = false;
+    p_fSt->replay = REPLAY_OFF;
+    strcpy (p_fSt->replayFile, "");
+    p_fSt->checkpoint = CKPT_OFF;
+    strcpy (p_fSt->checkpointFile, "");
+    p_fSt->checkpointAt = 0;
+    p_fSt->checkpointStop = false;
+    p_fSt->jitter = 0;
+    p_fSt->jitterDist = MEAL_CONST;
+    p_fSt->jitterA = p_fSt->jitterB = 0.0;
+    p_fSt->watchdog = 0;
+    p_fSt->kitchen.nStations = 0;
+    p_fSt->kitchen.nDishes = 0;
+    p_fSt->admission.policy = ADMIT_OFF;
+    p_fSt->admission.capacity = -1;
+    p_fSt->admission.maxWait = 0;
+    p_fSt->seed = 0;
+    gen->arrivals = ARRIVALS_CONFIG;
+    gen->meal = MEAL_CONST;
+    gen->mealA = gen->mealB = 100000.0;
+    gen->minSize = gen->maxSize = GROUPSIZE;
+
+    strcpy (section, "");
+    while (fgets (line, LINELEN, fp) != NULL) {
+        nLine++;
+        for (p = line; isspace ((unsigned char) *p); p++);
+        if (*p == '\0') {                                                                           /* blank line */
+            continue;
+        }
+        if (*p == '#') {                                                            /* section header */
+            if (sscanf (p + 1, "%s", section) != 1) {
+                strcpy (section, "");
+            }
+            continue;
+        }
+
+        if (strcmp (section, "ngroups") == 0) {
+            if ((sscanf (p, "%d", &p_fSt->nGroups) != 1) || (p_fSt->nGroups < 1) || (p_fSt->nGroups > MAXGROUPS)) {
+                configError (nFic, nLine, "number of groups must be between 1 and MAXGROUPS");
+            }
+        }
+        else if (strcmp (section, "startTime") == 0) {
+            if ((nRows >= p_fSt->nGroups) || (p_fSt->nGroups < 0)) {
+                configError (nFic, nLine, "more groups than declared in #ngroups");
+            }
+            n = sscanf (p, "%d %d %d", &p_fSt->startTime[nRows], &p_fSt->eatTime[nRows], &p_fSt->groupSize[nRows]);
+            if (n < 2) {
+                configError (nFic, nLine, "expected <startTime> <timeToEat> [<groupSize>]");
+            }
+            if (n == 2) {
+                p_fSt->groupSize[nRows] = GROUPSIZE;
+            }
+            if (p_fSt->groupSize[nRows] < 1) {
+                configError (nFic, nLine, "group size must be positive");
+            }
+            nRows++;
+        }
+        else if (strcmp (section, "policy") == 0) {
+            sscanf (p, "%s", word);
+            if ((p_fSt->policy = nameIndex (word, policyNames, NUMPOLICIES)) == -1) {
+                configError (nFic, nLine, "unknown policy (LOWESTID, FIFO, SMF or EARLIEST)");
+            }
+        }
+        else if (strcmp (section, "tables") == 0) {
+            while (sscanf (p, "%d%n", &t, &offs) == 1) {
+                if (p_fSt->nTables >= MAXTABLES) {
+                    configError (nFic, nLine, "more than MAXTABLES tables");
+                }
+                if (t < 1) {
+                    configError (nFic, nLine, "table capacity must be positive");
+                }
+                p_fSt->tableCapacity[p_fSt->nTables++] = t;
+                p += offs;
+            }
+        }
+        else if (strcmp (section, "seating") == 0) {
+            while (sscanf (p, "%s%n", word, &offs) == 1) {
+                if (strcasecmp (word, "share") == 0) {
+                    p_fSt->tableShare = true;
+                }
+                else if (strcasecmp (word, "join") == 0) {
+                    p_fSt->tableJoin = true;
+                }
+                else if (strcasecmp (word, "exclusive") != 0) {
+                    configError (nFic, nLine, "unknown seating mode (EXCLUSIVE, SHARE or JOIN)");
+                }
+                p += offs;
+            }
+        }
+        else if (strcmp (section, "arrivals") == 0) {
+            sscanf (p, "%s%n", word, &offs);
+            p += offs;
+            gen->arrivals = nameIndex (word, arrivalNames, 5);
+            switch (gen->arrivals) {
+                case ARRIVALS_CONFIG:
+                    n = 0;
+                    break;
+                case ARRIVALS_POISSON:
+                    n = (sscanf (p, "%lf %d", &gen->rate, &p_fSt->totalGroups) == 2);
+                    break;
+                case ARRIVALS_BURSTY:
+                    n = (sscanf (p, "%lf %d %d %d", &gen->rate, &gen->onTime, &gen->offTime, &p_fSt->totalGroups) == 4) &&
+                        (gen->onTime > 0) && (gen->offTime >= 0);
+                    break;
+                case ARRIVALS_DIURNAL:
+                    n = (sscanf (p, "%lf %lf %d %d", &gen->rate, &gen->amplitude, &gen->period, &p_fSt->totalGroups) == 4) &&
+                        (gen->amplitude >= 0.0) && (gen->amplitude <= 1.0) && (gen->period > 0);
+                    break;
+                case ARRIVALS_FILE:
+                    p_fSt->totalGroups = 0;                                     /* the whole file by default */
+                    n = (sscanf (p, "%255s %d", gen->file, &p_fSt->totalGroups) >= 1);
+                    break;
+                default:
+                    n = 0;
+                    configError (nFic, nLine, "unknown arrival process (CONFIG, POISSON, BURSTY, DIURNAL or FILE)");
+            }
+            if ((gen->arrivals != ARRIVALS_CONFIG) &&
+                (!n || ((gen->arrivals != ARRIVALS_FILE) && (gen->rate <= 0.0)) || (p_fSt->totalGroups < 0))) {
+                configError (nFic, nLine, "expected POISSON <rate> <count>, BURSTY <rate> <on ms> <off ms> <count>,"
+                                          " DIURNAL <rate> <amplitude> <period ms> <count> or FILE <name> [<count>]");
+            }
+        }
+        else if (strcmp (section, "mealtime") == 0) {
+            sscanf (p, "%s%n", word, &offs);
+            if ((gen->meal = nameIndex (word, mealNames, 4)) == -1) {
+                configError (nFic, nLine, "unknown meal time distribution (CONST, UNIFORM, NORMAL or EXP)");
+            }
+            n = sscanf (p + offs, "%lf %lf", &gen->mealA, &gen->mealB);
+            if ((n < 1) || ((n < 2) && ((gen->meal == MEAL_UNIFORM) || (gen->meal == MEAL_NORMAL)))) {
+                configError (nFic, nLine, "missing meal time parameters");
+            }
+        }
+        else if (strcmp (section, "groupsize") == 0) {
+            n = sscanf (p, "%d %d", &gen->minSize, &gen->maxSize);
+            if (n == 1) {
+                gen->maxSize = gen->minSize;
+            }
+            if ((n < 1) || (gen->minSize < 1) || (gen->maxSize < gen->minSize)) {
+                configError (nFic, nLine, "expected <smallest size> [<largest size>]");
+            }
+        }
+        else if (strcmp (section, "trace") == 0) {
+            sscanf (p, "%255s", p_fSt->traceFile);
+        }
+        else if (strcmp (section, "placement") == 0) {
+            strcpy (p_fSt->placement, p);                                /* checked by the main program */
+            p_fSt->placement[strcspn (p_fSt->placement, "\r\n")] = '\0';
+        }
+        else if (strcmp (section, "semtiming") == 0) {
+            sscanf (p, "%s", word);
+            if ((strcasecmp (word, "ON") != 0) && (strcasecmp (word, "OFF") != 0)) {
+                configError (nFic, nLine, "expected ON or OFF");
+            }
+            p_fSt->semTiming = (strcasecmp (word, "ON") == 0);
+        }
+        else if (strcmp (section, "realtime") == 0) {
+            sscanf (p, "%s%n", word, &offs);
+            n = sscanf (p + offs, "%d %d %d", &p_fSt->rtPriority[SRV_CHEF], &p_fSt->rtPriority[SRV_WAITER],
+                        &p_fSt->rtPriority[SRV_RECEPTIONIST]);
+            if (n == 1) {
+                p_fSt->rtPriority[SRV_WAITER] = p_fSt->rtPriority[SRV_RECEPTIONIST] = p_fSt->rtPriority[SRV_CHEF];
+            }
+            if (((p_fSt->realtime = nameIndex (word, realtimeNames, 3)) == -1) || (n == 2)) {
+                configError (nFic, nLine, "expected OFF, FIFO or RR [<priority> | <chef> <waiter> <receptionist>]");
+            }
+        }
+        else if (strcmp (section, "replay") == 0) {
+            n = sscanf (p, "%s %255s", word, p_fSt->replayFile);
+            if (((p_fSt->replay = nameIndex (word, replayNames, 3)) == -1) ||
+                ((p_fSt->replay != REPLAY_OFF) && (n != 2))) {
+                configError (nFic, nLine, "expected OFF, RECORD <file> or REPLAY <file>");
+            }
+        }
+        else if (strcmp (section, "shards") == 0) {
+            strcpy (word, "LEAST");
+            n = sscanf (p, "%d %s", &p_fSt->nShards, word);
+            if ((n < 1) || (p_fSt->nShards < 1) || (p_fSt->nShards > MAXSHARDS) ||
+                ((p_fSt->dispatch = nameIndex (word, dispatchNames, 2)) == -1)) {
+                configError (nFic, nLine, "expected <number of shards, 1 to MAXSHARDS> [LEAST or P2C]");
+            }
+        }
+        else if (strcmp (section, "coroutines") == 0) {
+            n = sscanf (p, "%d %d", &p_fSt->groupHosts, &p_fSt->coStack);
+            if ((n < 1) || (p_fSt->groupHosts < 0) || (p_fSt->groupHosts > MAXHOSTS) || (p_fSt->coStack < 16)) {
+                configError (nFic, nLine, "expected <number of hosts, 0 to MAXHOSTS> [<stack size, KiB, at least 16>]");
+            }
+        }
+        else if (strcmp (section, "launch") == 0) {
+            if ((sscanf (p, "%s", word) != 1) || ((p_fSt->launch = nameIndex (word, launchNames, 2)) == -1)) {
+                configError (nFic, nLine, "expected EXEC or FORKSERVER");
+            }
+        }
+        else if (strcmp (section, "events") == 0) {
+            n = sscanf (p, "%s %d", word, &p_fSt->eventTick);
+            if ((n < 1) || ((strcasecmp (word, "ON") != 0) && (strcasecmp (word, "OFF") != 0)) || (p_fSt->eventTick < 1)) {
+                configError (nFic, nLine, "expected ON or OFF [<housekeeping period, ms>]");
+            }
+            p_fSt->eventLoop = (strcasecmp (word, "ON") == 0);
+        }
+        else if (strcmp (section, "checkpoint") == 0) {
+            sscanf (p, "%s%n", word, &offs);
+            p_fSt->checkpoint = nameIndex (word, checkpointNames, 3);
+            strcpy (word, "STOP");
+            n = sscanf (p + offs, "%255s %d %s", p_fSt->checkpointFile, &p_fSt->checkpointAt, word);
+            p_fSt->checkpointStop = (n == 3);
+            if ((p_fSt->checkpoint == -1) || ((p_fSt->checkpoint != CKPT_OFF) && (n < 1)) ||
+                ((p_fSt->checkpoint == CKPT_RESUME) && (n > 1)) || (p_fSt->checkpointAt < 0) ||
+                (strcasecmp (word, "STOP") != 0)) {
+                configError (nFic, nLine, "expected OFF, SAVE <file> [<ms> [STOP]] or RESUME <file>");
+            }
+        }
+        else if (strcmp (section, "jitter") == 0) {
+            sscanf (p, "%s%n", word, &offs);
+            p_fSt->jitter = 0;
+            if (strcasecmp (word, "OFF") != 0) {
+                int k;
+
+                p += offs;
+                p_fSt->jitterDist = nameIndex (word, mealNames, 4);
+                if ((p_fSt->jitterDist == MEAL_UNIFORM) || (p_fSt->jitterDist == MEAL_NORMAL)) {
+                    n = (sscanf (p, "%lf %lf%n", &p_fSt->jitterA, &p_fSt->jitterB, &offs) == 2);
+                }
+                else n = (sscanf (p, "%lf%n", &p_fSt->jitterA, &offs) == 1);
+                for (p += n ? offs : 0; n && (sscanf (p, "%s%n", word, &offs) == 1); p += offs) {
+                    if ((k = nameIndex (word, jitterNames, 3)) == -1) {
+                        n = 0;
+                    }
+                    else p_fSt->jitter |= 1 << k;
+                }
+                if ((p_fSt->jitterDist == -1) || !n) {
+                    configError (nFic, nLine, "expected OFF or the delay (us): CONST <t>, UNIFORM <lo> <hi>, NORMAL <mean>"
+                                              " <stddev> or EXP <mean>, then where: MUTEX, REQUEST and/or SAVE (all by default)");
+                }
+                if (p_fSt->jitter == 0) {
+                    p_fSt->jitter = JIT_ALL;
+                }
+            }
+        }
+        else if (strcmp (section, "watchdog") == 0) {
+            if ((sscanf (p, "%d", &p_fSt->watchdog) != 1) || (p_fSt->watchdog < 0)) {
+                configError (nFic, nLine, "expected <ms without a change of state> (0 for no watchdog)");
+            }
+        }
+        else if (strcmp (section, "stations") == 0) {
+            KITCHEN *k = &p_fSt->kitchen;
+
+            if (k->nStations == MAXSTATIONS) {
+                configError (nFic, nLine, "more than MAXSTATIONS stations");
+            }
+            if ((sscanf (p, "%15s %d", k->stationName[k->nStations], &k->stationCapacity[k->nStations]) != 2) ||
+                (k->stationCapacity[k->nStations] < 1)) {
+                configError (nFic, nLine, "expected <station name> <dishes cooked at once>");
+            }
+            if (!nameValid (k->stationName[k->nStations])) {
+                configError (nFic, nLine, "station names are made of letters, digits and underscores");
+            }
+            k->nStations += 1;
+        }
+        else if (strcmp (section, "menu") == 0) {
+            KITCHEN *k = &p_fSt->kitchen;
+            const char *stations[MAXSTATIONS];
+            int d = k->nDishes;
+
+            if (d == MAXDISHES) {
+                configError (nFic, nLine, "more than MAXDISHES dishes");
+            }
+            n = sscanf (p, "%15s %s %d %d", k->dishName[d], word, &k->dishMin[d], &k->dishMax[d]);
+            if (n == 3) {
+                k->dishMax[d] = k->dishMin[d];
+            }
+            if ((n < 3) || (k->dishMin[d] < 0) || (k->dishMax[d] < k->dishMin[d])) {
+                configError (nFic, nLine, "expected <dish name> <station> <cooking time, ms> [<longest time, ms>]");
+            }
+            if (!nameValid (k->dishName[d])) {
+                configError (nFic, nLine, "dish names are made of letters, digits and underscores");
+            }
+            for (t = 0; t < k->nStations; t++) {
+                stations[t] = k->stationName[t];
+            }
+            if ((k->dishStation[d] = nameIndex (word, stations, k->nStations)) == -1) {
+                configError (nFic, nLine, "unknown station (stations are listed in #stations, before #menu)");
+            }
+            k->nDishes += 1;
+        }
+        else if (strcmp (section, "admission") == 0) {
+            ADMISSION *a = &p_fSt->admission;
+
+            sscanf (p, "%s%n", word, &offs);
+            a->capacity = -1;
+            switch (a->policy = nameIndex (word, admissionNames, 3)) {
+                case ADMIT_OFF:
+                    n = 1;
+                    break;
+                case ADMIT_FULL:
+                    n = (sscanf (p + offs, "%d", &a->capacity) == 1) && (a->capacity >= 0);
+                    break;
+                case ADMIT_WAIT:
+                    n = (sscanf (p + offs, "%d %d", &a->maxWait, &a->capacity) >= 1) && (a->maxWait >= 0) &&
+                        (a->capacity >= -1);
+                    break;
+                default:
+                    n = 0;
+            }
+            if (!n) {
+                configError (nFic, nLine, "expected OFF, FULL <waiting room capacity> or WAIT <longest estimated wait, ms>"
+                                          " [<waiting room capacity>]");
+            }
+        }
+        else if (strcmp (section, "seed") == 0) {
+            if (sscanf (p, "%u", &p_fSt->seed) != 1) {
+                configError (nFic, nLine, "expected <seed>");
+            }
+        }
+        else if (strcmp (section, "slots") == 0) {
+            if ((sscanf (p, "%d", &slots) != 1) || (slots < 1) || (slots > MAXGROUPS)) {
+                configError (nFic, nLine, "number of slots must be between 1 and MAXGROUPS");
+            }
+        }
+        else {
+            configError (nFic, nLine, "value outside of a known section");
+        }
+    }
+    fclose (fp);
+
+    /* open-loop generation: groups are created on the fly, one slot per group in the restaurant */
+    if (gen->arrivals != ARRIVALS_CONFIG) {
+        p_fSt->nGroups = slots;
+        for (n = 0; n < slots; n++) {
+            p_fSt->startTime[n] = 0;
+            p_fSt->eatTime[n] = 0;
+            p_fSt->groupSize[n] = gen->maxSize;                              /* checked against tables below */
+        }
+        nRows = slots;
+    }
+    else {
+        p_fSt->totalGroups = p_fSt->nGroups;
+    }
+
+    if (p_fSt->nTables == 0) {
+        for (t = 0; t < NUMTABLES; t++) {
+            p_fSt->tableCapacity[t] = TABLECAP;
+        }
+        p_fSt->nTables = NUMTABLES;
+    }
+
+    if (p_fSt->nGroups < 0) {
+        configError (nFic, nLine, "missing #ngroups section");
+    }
+    if (nRows != p_fSt->nGroups) {
+        configError (nFic, nLine, "fewer groups than declared in #ngroups");
+    }
+    if ((p_fSt->replay != REPLAY_OFF) && (gen->arrivals != ARRIVALS_CONFIG)) {
+        configError (nFic, nLine, "#replay requires the groups listed in the file (CONFIG arrivals)");
+    }
+    if (p_fSt->launch == LAUNCH_FORKSERVER) {
+        if (p_fSt->groupHosts > 0) {
+            configError (nFic, nLine, "#coroutines and #launch FORKSERVER can not be combined");
+        }
+        p_fSt->groupHosts = 1;                                     /* the template is the host of every group */
+    }
+    if ((p_fSt->replay != REPLAY_OFF) && (p_fSt->groupHosts > 0)) {
+        configError (nFic, nLine, "#replay requires a process per group (no #coroutines or #launch FORKSERVER)");
+    }
+    if ((p_fSt->replay != REPLAY_OFF) && (p_fSt->checkpoint != CKPT_OFF)) {
+        configError (nFic, nLine, "#replay and #checkpoint can not be combined");
+    }
+    if ((p_fSt->replay != REPLAY_OFF) && (p_fSt->jitter != 0)) {
+        configError (nFic, nLine, "#replay and #jitter can not be combined");
+    }
+    if ((p_fSt->replay != REPLAY_OFF) && p_fSt->eventLoop) {
+        configError (nFic, nLine, "#replay requires the servers to wait on semaphores (no #events)");
+    }
+    if ((p_fSt->kitchen.nStations > 0) != (p_fSt->kitchen.nDishes > 0)) {
+        configError (nFic, nLine, "#stations and #menu go together");
+    }
+    if ((p_fSt->replay != REPLAY_OFF) && (p_fSt->kitchen.nStations > 0)) {
+        configError (nFic, nLine, "#replay requires the chef to cook each order at once (no #stations)");
+    }
+    if (p_fSt->groupHosts > p_fSt->nGroups) {
+        p_fSt->groupHosts = p_fSt->nGroups;                                           /* a host per group at most */
+    }
+    if ((p_fSt->nShards > 1) && (gen->arrivals == ARRIVALS_CONFIG)) {
+        configError (nFic, nLine, "#shards requires an open-loop arrival process or a workload file");
+    }
+
+    /* every group must fit somewhere, otherwise it would wait forever (groups of a workload file are
+       checked as they are read) */
+    for (n = 0; (gen->arrivals != ARRIVALS_FILE) && (n < p_fSt->nGroups); n++) {
+        if (p_fSt->groupSize[n] > largestGroup (p_fSt)) {
+            fprintf (stderr, "%s: group %d does not fit at any table\n", nFic, n);
+            exit (EXIT_FAILURE);
+        }
+    }
+}
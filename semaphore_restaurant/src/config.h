@@ -0,0 +1,174 @@
+/**
+ *  \file config.h (interface file)
+ *
+ *  \brief Problem name: Restaurant
+ *
+ *  \brief Reading the simulation parameters from the configuration file.
+ *
+ *  Defined operations:
+ *     \li parsing the configuration file into the full state of the problem
+ *     \li conversion between scheduling policy ids and names
+ *     \li conversion between arrival process ids and names
+ *     \li conversion between server scheduling policy ids and names
+ *     \li description of the injected delays
+ *     \li description of the kitchen stations
+ *     \li description of the admission policy
+ *     \li size of the largest group that can be seated.
+ */
+
+#ifndef CONFIG_H_
+#define CONFIG_H_
+
+#include "probDataStruct.h"
+
+/**
+ *  \brief Parsing the configuration file.
+ *
+ *  The file is made of sections. Each section starts with a comment line whose first word names
+ *  the section and is followed by its values:
+ *       \li <tt>#ngroups</tt> number of groups
+ *       \li <tt>#startTime timeToEat groupSize</tt> one line per group (size is optional, GROUPSIZE by default)
+ *       \li <tt>#policy</tt> receptionist scheduling policy (optional, LOWESTID by default)
+ *       \li <tt>#tables</tt> capacity of each table (optional, NUMTABLES tables of TABLECAP seats by default)
+ *       \li <tt>#seating</tt> EXCLUSIVE, or SHARE and/or JOIN tables (optional, EXCLUSIVE by default)
+ *       \li <tt>#arrivals</tt> CONFIG (groups listed above, default) or an open-loop arrival process:
+ *           <tt>POISSON rate count</tt>, <tt>BURSTY rate onMs offMs count</tt> or
+ *           <tt>DIURNAL rate amplitude periodMs count</tt> (rate in groups per second, count 0 for no limit),
+ *           or groups streamed from a binary workload file: <tt>FILE name [count]</tt> (the whole file by default)
+ *       \li <tt>#mealtime</tt> meal time distribution of generated groups (us): <tt>CONST t</tt>,
+ *           <tt>UNIFORM lo hi</tt>, <tt>NORMAL mean stddev</tt> or <tt>EXP mean</tt>
+ *       \li <tt>#groupsize</tt> size range of generated groups: <tt>smallest [largest]</tt>
+ *       \li <tt>#slots</tt> number of generated groups that may be in the restaurant at once (NUMSLOTS by
+ *           default, MAXGROUPS at most)
+ *       \li <tt>#trace</tt> name of a file where every logged state is also written with its time (optional)
+ *       \li <tt>#placement</tt> CPUs of the entities: NONE (default), ISOLATED, ONECORE or
+ *           <tt>CUSTOM chef waiter receptionist groups</tt> (see placement.h)
+ *       \li <tt>#semtiming</tt> ON measures, for every semaphore, the time from an up until the down it
+ *           unblocks returns (OFF by default)
+ *       \li <tt>#realtime</tt> scheduling policy of the servers: OFF (default), <tt>FIFO</tt> or <tt>RR</tt>,
+ *           followed by their priority or by the priorities of the chef, waiter and receptionist (RTPRIORITY by default)
+ *       \li <tt>#replay</tt> <tt>RECORD file</tt> saves the seed and the order of the semaphore grants of the run,
+ *           <tt>REPLAY file</tt> runs again with them (CONFIG arrivals only, OFF by default)
+ *       \li <tt>#shards</tt> number of independent restaurants (1 by default, open-loop arrivals only), each with
+ *           its own tables, servers and group slots, and how arriving groups are routed to them:
+ *           <tt>LEAST</tt> groups waiting (default) or <tt>P2C</tt>, the less loaded of two random shards
+ *       \li <tt>#coroutines</tt> <tt>hosts [stack]</tt> runs the groups as coroutines, spread over that many
+ *           processes (0, the default, runs a process per group), with stacks of that many KiB (COSTACK by default)
+ *       \li <tt>#launch</tt> how the group processes are launched: <tt>EXEC</tt> (default), a fork and exec per group,
+ *           or <tt>FORKSERVER</tt>, a fork per group of a template process that is already attached to the shared
+ *           region and the semaphore set (it can not be combined with <tt>#coroutines</tt>)
+ *       \li <tt>#events</tt> ON runs the waiter and the receptionist as event loops on eventfds (see events.h),
+ *           with a housekeeping timer of that period: <tt>ON [ms]</tt> (EVTICK by default); OFF by default
+ *       \li <tt>#checkpoint</tt> <tt>SAVE file [ms [STOP]]</tt> saves the state of the run to the file that many ms
+ *           after the start of operations and on every SIGUSR1 (on SIGUSR1 only if 0 or missing), closing the
+ *           restaurant once saved with STOP; <tt>RESUME file</tt> starts the run from the saved state
+ *           (see checkpoint.h); OFF by default
+ *       \li <tt>#jitter</tt> random delays injected into the entities (see jitter.h): OFF (default) or their
+ *           distribution (us), as in <tt>#mealtime</tt>, followed by the points where they are injected:
+ *           <tt>MUTEX</tt>, <tt>REQUEST</tt> and/or <tt>SAVE</tt> (all by default)
+ *       \li <tt>#watchdog</tt> time without a change of state, while no group is going to the restaurant
+ *           or eating, after which the run is taken as stalled and killed (ms, 0 by default: no watchdog)
+ *       \li <tt>#stations</tt> stations of the kitchen, one per line: <tt>name capacity</tt>, the number of dishes
+ *           it cooks at once (none by default: the chef cooks each order at once, for a random time); the names
+ *           of stations and dishes are made of letters, digits and underscores (they name keys of the summary)
+ *       \li <tt>#menu</tt> dishes, one per line: <tt>name station ms [longest ms]</tt>, the station type it is
+ *           cooked on and its cooking time, drawn uniformly; each person of a group orders one, drawn at random
+ *       \li <tt>#admission</tt> what happens to a group that can not be seated when it checks in: OFF (default),
+ *           it waits for a table; <tt>FULL capacity</tt>, it is turned away if that many groups are waiting;
+ *           <tt>WAIT ms [capacity]</tt>, it is turned away if its estimated wait is longer (or the room is full)
+ *       \li <tt>#seed</tt> random seed of the run (optional, chosen at start by default).
+ *
+ *  With an open-loop arrival process, <tt>#ngroups</tt> and the group list are not used. Meal times and
+ *  sizes of the groups of a workload file are read from the file.
+ *
+ *  The program is terminated if the file can not be read or is malformed.
+ *
+ *  \param nFic name of the configuration file
+ *  \param p_fSt pointer to the location where the full internal state of the problem is stored
+ */
+extern void readConfig (char nFic[], FULL_STAT *p_fSt);
+
+/**
+ *  \brief Name of a scheduling policy.
+ *
+ *  \param policy policy id
+ *
+ *  \return policy name
+ */
+extern const char *policyName (int policy);
+
+/**
+ *  \brief Name of an arrival process.
+ *
+ *  \param arrivals arrival process id (ARRIVALS_*)
+ *
+ *  \return arrival process name
+ */
+extern const char *arrivalName (int arrivals);
+
+/**
+ *  \brief Name of a scheduling policy of the servers.
+ *
+ *  \param realtime policy id (REALTIME_*)
+ *
+ *  \return policy name
+ */
+extern const char *realtimeName (int realtime);
+
+/**
+ *  \brief Name of a dispatching policy.
+ *
+ *  \param dispatch policy id (DISPATCH_*)
+ *
+ *  \return policy name
+ */
+extern const char *dispatchName (int dispatch);
+
+/**
+ *  \brief Name of a launch mode.
+ *
+ *  \param launch launch mode (LAUNCH_*)
+ *
+ *  \return launch mode name
+ */
+extern const char *launchName (int launch);
+
+/**
+ *  \brief Description of the injected delays.
+ *
+ *  \param p_fSt pointer to the location where the full internal state of the problem is stored
+ *  \param buf location where the description is stored: OFF, or the distribution and the points
+ *         (e.g. <tt>EXP 500 MUTEX+SAVE</tt>)
+ *  \param len size of buf
+ */
+extern void jitterName (FULL_STAT *p_fSt, char buf[], int len);
+
+/**
+ *  \brief Description of the kitchen stations.
+ *
+ *  \param p_fSt pointer to the location where the full internal state of the problem is stored
+ *  \param buf location where the description is stored: OFF, or each station and its capacity
+ *         (e.g. <tt>GRILL:2+FRYER:1</tt>)
+ *  \param len size of buf
+ */
+extern void kitchenName (FULL_STAT *p_fSt, char buf[], int len);
+
+/**
+ *  \brief Description of the admission policy.
+ *
+ *  \param p_fSt pointer to the location where the full internal state of the problem is stored
+ *  \param buf location where the description is stored: OFF, <tt>FULL capacity</tt> or <tt>WAIT ms [capacity]</tt>
+ *  \param len size of buf
+ */
+extern void admissionName (FULL_STAT *p_fSt, char buf[], int len);
+
+/**
+ *  \brief Size of the largest group that can be seated.
+ *
+ *  \param p_fSt pointer to the location where the full internal state of the problem is stored
+ *
+ *  \return capacity of the largest table, or the number of seats if tables can be joined
+ */
+extern int largestGroup (FULL_STAT *p_fSt);
+
+#endif /* CONFIG_H_ */
@@ -0,0 +1,123 @@
+/**
+ *  \file events.c (implementation file)
+ *
+ *  \brief Problem name: Restaurant
+ *
+ *  \brief Event channels of the event-driven servers.
+ *
+ *  Channels are eventfds and the housekeeping timer a timerfd, both watched (level-triggered) by an
+ *  epoll set of the server. Reading a ready descriptor returns, and clears, its count.
+ *
+ *  Defined operations:
+ *     \li creation of the channels
+ *     \li destruction of the channels
+ *     \li posting an event
+ *     \li creation of the event loop of a server
+ *     \li waiting for events.
+ */
+
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/eventfd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+#include "probConst.h"
+#include "events.h"
+
+/** \brief epoll set of the calling server (-1 if none) */
+static int epfd = -1;
+
+/** \brief descriptor of each source of the event loop (indexed by EV_*, up to EV_TICK) */
+static int source[NEVENTS + 1];
+
+int eventCreate (int fd[])
+{
+    int e;
+
+    for (e = 0; e < NEVENTS; e++) {
+        if ((fd[e] = eventfd (0, EFD_NONBLOCK)) == -1) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void eventDestroy (int fd[])
+{
+    int e;
+
+    for (e = 0; e < NEVENTS; e++) {
+        close (fd[e]);
+    }
+}
+
+int eventPost (int fd)
+{
+    uint64_t one = 1;
+
+    return (write (fd, &one, sizeof (one)) == sizeof (one)) ? 0 : -1;
+}
+
+int eventLoopCreate (int fd[], int first, int n, int tick)
+{
+    struct epoll_event ev;
+    struct itimerspec period;
+    int e;
+
+    if ((epfd = epoll_create1 (EPOLL_CLOEXEC)) == -1) {
+        return -1;
+    }
+    for (e = 0; e <= NEVENTS; e++) {
+        source[e] = -1;
+    }
+    for (e = first; e < first + n; e++) {
+        source[e] = fd[e];
+    }
+    if ((source[EV_TICK] = timerfd_create (CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)) == -1) {
+        return -1;
+    }
+    period.it_interval.tv_sec = tick / 1000;
+    period.it_interval.tv_nsec = (tick % 1000) * 1000000L;
+    period.it_value = period.it_interval;
+    if (timerfd_settime (source[EV_TICK], 0, &period, NULL) == -1) {
+        return -1;
+    }
+    for (e = 0; e <= NEVENTS; e++) {
+        if (source[e] != -1) {
+            ev.events = EPOLLIN;
+            ev.data.u32 = (uint32_t) e;
+            if (epoll_ctl (epfd, EPOLL_CTL_ADD, source[e], &ev) == -1) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int eventWait (unsigned long long count[])
+{
+    struct epoll_event ev[NEVENTS + 1];
+    uint64_t v;
+    int n, k, e;
+
+    for (e = 0; e <= NEVENTS; e++) {
+        count[e] = 0;
+    }
+    while ((n = epoll_wait (epfd, ev, NEVENTS + 1, -1)) == -1) {
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+    for (k = 0; k < n; k++) {
+        e = (int) ev[k].data.u32;
+        if (read (source[e], &v, sizeof (v)) == sizeof (v)) {
+            count[e] = v;
+        }
+        else if (errno != EAGAIN) {
+            return -1;
+        }
+    }
+    return n;
+}
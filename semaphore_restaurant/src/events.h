@@ -0,0 +1,82 @@
+/**
+ *  \file events.h (interface file)
+ *
+ *  \brief Problem name: Restaurant
+ *
+ *  \brief Event channels of the event-driven servers.
+ *
+ *  A channel is an eventfd: posting adds one to its counter and a server waiting on it wakes up. The
+ *  eventfds are created by the main program before the entities and inherited by them, so every entity
+ *  uses the same descriptor numbers, kept in the shared region (see EV_* in probConst.h).
+ *
+ *  An event-driven server waits on an epoll set with its channels and a periodic timer (EV_TICK, for
+ *  housekeeping). Each wakeup reports the count of every ready source, so all of them are handled in
+ *  one pass.
+ *
+ *  Defined operations:
+ *     \li creation of the channels
+ *     \li destruction of the channels
+ *     \li posting an event
+ *     \li creation of the event loop of a server
+ *     \li waiting for events.
+ */
+
+#ifndef EVENTS_H_
+#define EVENTS_H_
+
+/**
+ *  \brief Creation of the channels.
+ *
+ *  The eventfds are non-blocking and are kept across exec.
+ *
+ *  \param fd descriptors of the channels (NEVENTS)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+extern int eventCreate (int fd[]);
+
+/**
+ *  \brief Destruction of the channels.
+ *
+ *  \param fd descriptors of the channels (NEVENTS)
+ */
+extern void eventDestroy (int fd[]);
+
+/**
+ *  \brief Posting an event.
+ *
+ *  \param fd descriptor of the channel
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+extern int eventPost (int fd);
+
+/**
+ *  \brief Creation of the event loop of the calling server.
+ *
+ *  \param fd descriptors of the channels (NEVENTS)
+ *  \param first first channel of the server
+ *  \param n number of channels of the server
+ *  \param tick period of the housekeeping timer (ms)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+extern int eventLoopCreate (int fd[], int first, int n, int tick);
+
+/**
+ *  \brief Waiting for events.
+ *
+ *  Blocks until at least one source of the event loop is ready.
+ *
+ *  \param count number of events of each channel and number of timer expirations (indexed by EV_*, up
+ *  to EV_TICK; 0 for the sources that were not ready)
+ *
+ *  \return number of sources ready, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+extern int eventWait (unsigned long long count[]);
+
+#endif /* EVENTS_H_ */
@@ -0,0 +1,85 @@
+/**
+ *  \file jitter.c (implementation file)
+ *
+ *  \brief Problem name: Restaurant
+ *
+ *  \brief Injection of random delays into the entities (stress mode).
+ *
+ *  The delays around the <em>downs</em> of the mutex are injected by functions set with semSetHooks,
+ *  so <tt>#jitter</tt> can not be combined with <tt>#replay</tt>, which sets them too.
+ *
+ *  Defined operations:
+ *     \li starting the injection of delays in an entity
+ *     \li injecting a delay at a point.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "probConst.h"
+#include "probDataStruct.h"
+#include "sharedDataSync.h"
+#include "semaphore.h"
+#include "rng.h"
+#include "jitter.h"
+
+/** \brief points where delays are injected (JIT_* bit mask, 0 until started) */
+static int points;
+
+/** \brief distribution of the delays (MEAL_*) and its parameters (us) */
+static int dist;
+static double distA, distB;
+
+/** \brief random number stream of the delays */
+static RNG rng;
+
+/* internal functions */
+
+/** \brief delay before and after every down of the mutex (see semSetHooks) */
+static void mutexDelay (int semgid, unsigned int sindex)
+{
+    if (sindex == MUTEX) {
+        jitterAt (JIT_MUTEX);
+    }
+}
+
+void jitterStart (FULL_STAT *p_fSt, unsigned int entity)
+{
+    points = p_fSt->jitter;
+    if (points == 0) {
+        return;
+    }
+    dist = p_fSt->jitterDist;
+    distA = p_fSt->jitterA;
+    distB = p_fSt->jitterB;
+    rngSeed (&rng, p_fSt->seed, JITTERSTREAM (entity));
+    if (points & JIT_MUTEX) {
+        semSetHooks (mutexDelay, mutexDelay);
+    }
+}
+
+void jitterAt (int point)
+{
+    double v;
+
+    if ((points & point) == 0) {
+        return;
+    }
+    switch (dist) {
+        case MEAL_UNIFORM:
+            v = distA + rngUniform (&rng) * (distB - distA);
+            break;
+        case MEAL_NORMAL:
+            v = distA + distB * rngNormal (&rng);
+            break;
+        case MEAL_EXP:
+            v = rngExp (&rng, distA);
+            break;
+        default:
+            v = distA;
+    }
+    if (v >= 1.0) {
+        usleep ((unsigned int) v);
+    }
+}
@@ -0,0 +1,54 @@
+/**
+ *  \file jitter.h (interface file)
+ *
+ *  \brief Problem name: Restaurant
+ *
+ *  \brief Injection of random delays into the entities (stress mode).
+ *
+ *  With <tt>#jitter</tt>, each entity sleeps for a random time, drawn from the configured distribution,
+ *  at the chosen points of its code (JIT_*): before and after every <em>down</em> of the mutex (see
+ *  semSetHooks), between storing a request for a server and the <em>up</em> of its request semaphore
+ *  (or the post of its event channel), and inside saveState. The delays widen the windows in which
+ *  the order of the operations of the entities may change, to bring out hangs and throughput cliffs
+ *  that the tight timing of the simulation hides. The watchdog of the main program (<tt>#watchdog</tt>)
+ *  tells a run that stalled from a slow one.
+ *
+ *  Each entity draws its delays from a random number stream of its own, so they do not change the
+ *  times drawn by the simulation itself.
+ *
+ *  Defined operations:
+ *     \li starting the injection of delays in an entity
+ *     \li injecting a delay at a point.
+ */
+
+#ifndef JITTER_H_
+#define JITTER_H_
+
+#include "probDataStruct.h"
+
+/** \brief random number stream of the delays of entity e (REPLAY_*, or REPLAY_GROUP plus the arrival number) */
+#define  JITTERSTREAM(e)    (0x80000000u | (unsigned int) (e))
+
+/** \brief entity id of the process hosting the groups of host h (coroutines, fork server) */
+#define  JITTERHOST(h)      (0x40000000u | (unsigned int) (h))
+
+/**
+ *  \brief Starting the injection of delays in an entity.
+ *
+ *  Does nothing if no point was chosen. A forked process should start it again, with a stream of its own.
+ *
+ *  \param p_fSt pointer to the location where the full internal state of the problem is stored
+ *  \param entity entity id (REPLAY_*, REPLAY_GROUP plus the arrival number for groups, or JITTERHOST)
+ */
+extern void jitterStart (FULL_STAT *p_fSt, unsigned int entity);
+
+/**
+ *  \brief Injecting a delay at a point.
+ *
+ *  The entity sleeps for a random time if the point was chosen and the injection was started.
+ *
+ *  \param point point of the code (JIT_*)
+ */
+extern void jitterAt (int point);
+
+#endif /* JITTER_H_ */
@@ -0,0 +1,215 @@
+/**
+ *  \file logFilter.c (implementation file)
+ *
+ *  \brief Problem name: Restaurant
+ *
+ *  Filter of the log written by saveState(): the states of the entities that did not change since the
+ *  previous line are replaced by a dot, so that changes stand out.
+ *
+ *  Upon execution, the following parameters are accepted:
+ *    \li <tt>-g ngroups</tt> number of groups (by default, taken from the header of the log)
+ *    \li name of the log file (stdin if missing).
+ *
+ *  A log file is mapped and read in place, stdin is read as a stream. Lines that are not state lines
+ *  (title, header, messages) are copied unchanged.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "probConst.h"
+
+/** \brief maximum length of a line read from a stream (a state line has two columns per group slot) */
+#define  LINELEN        (64 + 2 * 8 * MAXGROUPS)
+
+/** \brief maximum length of a field */
+#define  FIELDLEN       16
+
+/** \brief number of groups (-1 until known) */
+static int nGroups = -1;
+
+/** \brief number of fields of a state line */
+static int nFields;
+
+/** \brief width of each field */
+static int *width;
+
+/** \brief fields of the previous state line */
+static char (*prev)[FIELDLEN];
+
+/** \brief fields of the current line */
+static const char **field;
+static int *len;
+
+/** \brief output buffer */
+static char out[1 << 20];
+static size_t nOut;
+
+/* internal functions */
+
+/** \brief setting the layout of a state line for a number of groups */
+static void setGroups (int n)
+{
+    int f = 0, g;
+
+    nGroups = n;
+    nFields = 2 * n + 4;
+    width = malloc (nFields * sizeof (int));
+    prev = calloc (nFields, FIELDLEN);
+    field = malloc (nFields * sizeof (char *));
+    len = malloc (nFields * sizeof (int));
+    if ((width == NULL) || (prev == NULL) || (field == NULL) || (len == NULL)) {
+        perror ("error on allocating the line layout");
+        exit (EXIT_FAILURE);
+    }
+    width[f++] = 3;                                                                                      /* chef */
+    width[f++] = 2;                                                                                    /* waiter */
+    width[f++] = 2;                                                                              /* receptionist */
+    for (g = 0; g < n; g++) {
+        width[f++] = 3;                                                                                    /* groups */
+    }
+    width[f++] = 4;                                                                      /* groups waiting (gWT) */
+    for (g = 0; g < n; g++) {
+        width[f++] = 3;                                                                                    /* tables */
+    }
+}
+
+/** \brief writing the output buffer */
+static void flushOut (void)
+{
+    if (fwrite (out, 1, nOut, stdout) != nOut) {
+        perror ("error on writing the filtered log");
+        exit (EXIT_FAILURE);
+    }
+    nOut = 0;
+}
+
+/** \brief appending text to the output, right aligned in a width (0 for no alignment) */
+static void put (const char *s, int n, int w)
+{
+    if (nOut + n + w + 1 > sizeof (out)) {
+        flushOut ();
+        if (n + w + 1 > (int) sizeof (out)) {                                           /* a huge line */
+            fwrite (s, 1, n, stdout);
+            return;
+        }
+    }
+    for (; w > n; w--) {
+        out[nOut++] = ' ';
+    }
+    memcpy (out + nOut, s, n);
+    nOut += n;
+}
+
+/** \brief filtering a line (without the newline) */
+static void filterLine (const char *line, int n)
+{
+    const char *p = line, *end = line + n;
+    int f = 0, nTok = 0;
+
+    /* the header names the groups: G00 G01 ... */
+    if ((nGroups == -1) && (n > 2) && (strncmp (line, " CH", 3) == 0)) {
+        for (p = line; p < end - 1; p++) {
+            nTok += ((*p == 'G') && (p[1] >= '0') && (p[1] <= '9'));
+        }
+        setGroups (nTok);
+        p = line;
+    }
+
+    if (nGroups >= 0) {
+        while ((p < end) && (f <= nFields)) {
+            while ((p < end) && (*p == ' ')) {
+                p++;
+            }
+            if (p == end) {
+                break;
+            }
+            if (f < nFields) {
+                field[f] = p;
+            }
+            while ((p < end) && (*p != ' ')) {
+                p++;
+            }
+            if (f < nFields) {
+                len[f] = p - field[f];
+            }
+            f++;
+        }
+    }
+    if ((nGroups < 0) || (f != nFields)) {                                               /* not a state line */
+        put (line, n, 0);
+        put ("\n", 1, 0);
+        return;
+    }
+
+    for (f = 0; f < nFields; f++) {
+        if ((f < nGroups + 3) && (len[f] < FIELDLEN) && (strncmp (prev[f], field[f], len[f]) == 0) &&
+            (prev[f][len[f]] == '\0')) {
+            put (".", 1, width[f]);
+        }
+        else put (field[f], len[f], width[f]);
+        put (" ", 1, 0);
+        if (len[f] < FIELDLEN) {
+            memcpy (prev[f], field[f], len[f]);
+            prev[f][len[f]] = '\0';
+        }
+    }
+    put ("\n", 1, 0);
+}
+
+/**
+ *  \brief Main program.
+ */
+int main (int argc, char *argv[])
+{
+    static char line[LINELEN];
+    struct stat st;
+    const char *map, *p, *end, *nl;
+    int opt, fd;
+
+    while ((opt = getopt (argc, argv, "g:")) != -1) {
+        if ((opt != 'g') || (atoi (optarg) < 0)) {
+            fprintf (stderr, "USAGE: %s [-g «number of groups»] [«log file»]\n", argv[0]);
+            exit (EXIT_FAILURE);
+        }
+        setGroups (atoi (optarg));
+    }
+
+    if (optind == argc) {                                                                         /* stream */
+        while (fgets (line, LINELEN, stdin) != NULL) {
+            filterLine (line, strcspn (line, "\n"));
+        }
+        flushOut ();
+        return EXIT_SUCCESS;
+    }
+
+    if (((fd = open (argv[optind], O_RDONLY)) == -1) || (fstat (fd, &st) == -1)) {
+        perror ("error on opening the log file");
+        exit (EXIT_FAILURE);
+    }
+    if (st.st_size == 0) {
+        return EXIT_SUCCESS;
+    }
+    if ((map = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED) {
+        perror ("error on mapping the log file");
+        exit (EXIT_FAILURE);
+    }
+    madvise ((void *) map, st.st_size, MADV_SEQUENTIAL);
+    for (p = map, end = map + st.st_size; p < end; p = nl + 1) {
+        if ((nl = memchr (p, '\n', end - p)) == NULL) {
+            nl = end;
+        }
+        filterLine (p, nl - p);
+    }
+    flushOut ();
+    munmap ((void *) map, st.st_size);
+    close (fd);
+
+    return EXIT_SUCCESS;
+}
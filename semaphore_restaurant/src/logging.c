@@ -9,6 +9,13 @@
  *     \li file initialization
  *     \li writing the present full state as a single line at the end of the file.
  *
+ *  If a trace file is configured, each state is also written to it as a line with the time (us, monotonic
+ *  clock), the chef, waiter and receptionist states and the state of each group. Lines are written
+ *  under the same mutual exclusion as the log, so they are in time order. See traceExport.c.
+ *
+ *  Each state saved counts as progress for the watchdog of the main program, and a delay may be
+ *  injected while it is logged (JIT_SAVE, see jitter.h).
+ *
  *  \author Nuno Lau - December 2023
  */
 
@@ -23,9 +30,40 @@
 
 #include "probConst.h"
 #include "probDataStruct.h"
+#include "statistics.h"
+#include "jitter.h"
+
+/** \brief longest line of the state (as if every column were an int at its widest) */
+#define  LINELEN        (32 + 2 * 12 * MAXGROUPS)
 
 /* internal functions */
 
+/**
+ *  \brief Writing an integer right-aligned in a column (as printf "%*d"), without the cost of printf: a
+ *  line has two columns per group slot.
+ */
+static char *putColumn (char *p, int width, int v)
+{
+    char digits[12];
+    unsigned int u = (v < 0) ? 0u - (unsigned int) v : (unsigned int) v;
+    int n = 0;
+
+    do {
+        digits[n++] = (char) ('0' + u % 10);
+        u /= 10;
+    } while (u > 0);
+    if (v < 0) {
+        digits[n++] = '-';
+    }
+    for (; width > n; width--) {
+        *p++ = ' ';
+    }
+    while (n > 0) {
+        *p++ = digits[--n];
+    }
+    return p;
+}
+
 static FILE *openLog(char nFic[], char mode[])
 {
     FILE *fic;
@@ -80,6 +118,23 @@ static void printHeader(FILE *fic, FULL_STAT *p_fSt)
     fprintf(fic,"\n");
 }
 
+static void saveTrace(FULL_STAT *p_fSt)
+{
+    FILE *fic;
+    int g;
+
+    if ((fic = fopen (p_fSt->traceFile, "a")) == NULL) {
+        perror ("error on opening trace file");
+        exit (EXIT_FAILURE);
+    }
+    fprintf(fic,"%lld %u %u %u",timeNow(),p_fSt->st.chefStat,p_fSt->st.waiterStat,p_fSt->st.receptionistStat);
+    for(g=0; g < p_fSt->nGroups; g++) {
+        fprintf(fic," %u",p_fSt->st.groupStat[g]);
+    }
+    fprintf(fic,"\n");
+    closeLog(fic);
+}
+
 /* external functions */
 
 /**
@@ -106,6 +161,12 @@ void createLog (char nFic[], FULL_STAT *p_fSt)
     printHeader(fic, p_fSt);
 
     closeLog(fic);
+
+    if (strlen (p_fSt->traceFile) > 0) {                                                     /* empty trace file */
+        fic = openLog(p_fSt->traceFile,"w");
+        fprintf(fic,"# restaurant trace: time chef waiter receptionist and %d groups\n",p_fSt->nGroups);
+        closeLog(fic);
+    }
 }
 
 /**
@@ -126,31 +187,40 @@ void createLog (char nFic[], FULL_STAT *p_fSt)
 void saveState (char nFic[], FULL_STAT *p_fSt)
 {
     FILE *fic;                                                                                      /* file descriptor */
+    static char line[LINELEN];                                                    /* the line, written at once */
+    char *p = line;
 
     fic = openLog(nFic,"a");
 
-    fprintf(fic,"%3d",p_fSt->st.chefStat);
-    fprintf(fic,"%3d",p_fSt->st.waiterStat);
-    fprintf(fic,"%3d",p_fSt->st.receptionistStat);
-    fprintf(fic," ");
+    p = putColumn(p,3,p_fSt->st.chefStat);
+    p = putColumn(p,3,p_fSt->st.waiterStat);
+    p = putColumn(p,3,p_fSt->st.receptionistStat);
+    *p++ = ' ';
     int g;
     for(g=0; g < p_fSt->nGroups; g++) {
-        fprintf(fic,"%4d",p_fSt->st.groupStat[g]);
+        p = putColumn(p,4,p_fSt->st.groupStat[g]);
     }
 
-    fprintf(fic,"%5d",p_fSt->groupsWaiting);
+    p = putColumn(p,5,p_fSt->groupsWaiting);
 
     for(g=0; g < p_fSt->nGroups; g++) {
         if(p_fSt->assignedTable[g]!=-1)
-            fprintf(fic,"%4d",p_fSt->assignedTable[g]);
+            p = putColumn(p,4,p_fSt->assignedTable[g]);
         else {
-            fprintf(fic,"%4s",".");
+            memcpy(p,"   .",4);
+            p += 4;
         }
     }
 
-
-    fprintf(fic,"\n");
+    *p++ = '\n';
+    fwrite(line,1,p-line,fic);
+    jitterAt(JIT_SAVE);
 
     closeLog(fic);
+
+    if (strlen (p_fSt->traceFile) > 0) {
+        saveTrace(p_fSt);
+    }
+    __atomic_add_fetch (&p_fSt->progress, 1, __ATOMIC_RELAXED);
 }
 
@@ -0,0 +1,59 @@
+/**
+ *  \file notice.c (implementation file)
+ *
+ *  \brief Problem name: Restaurant
+ *
+ *  \brief Notices to the groups.
+ *
+ *  The counts of the notices are changed with atomic operations, as the servers post them and the hosts
+ *  take them without holding the mutex.
+ *
+ *  Defined operations:
+ *     \li posting a notice
+ *     \li taking a notice
+ *     \li semaphore of a notice.
+ */
+
+#include <stdbool.h>
+
+#include "probConst.h"
+#include "probDataStruct.h"
+#include "sharedDataSync.h"
+#include "semaphore.h"
+#include "notice.h"
+
+int noticePost (int semgid, SHARED_DATA *sh, int g, int note)
+{
+    if (!COROUTINES (&sh->fSt)) {
+        return semUp (semgid, noticeSem (sh, g, note));
+    }
+    __atomic_add_fetch (&sh->fSt.notice[g][note], 1, __ATOMIC_SEQ_CST);
+    return semUp (semgid, sh->groupHost[g % sh->fSt.groupHosts]);
+}
+
+bool noticeTake (SHARED_DATA *sh, int g, int note)
+{
+    unsigned int n = __atomic_load_n (&sh->fSt.notice[g][note], __ATOMIC_SEQ_CST);
+
+    while (n > 0) {
+        if (__atomic_compare_exchange_n (&sh->fSt.notice[g][note], &n, n - 1, false, __ATOMIC_SEQ_CST,
+                                         __ATOMIC_SEQ_CST)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+unsigned int noticeSem (SHARED_DATA *sh, int g, int note)
+{
+    switch (note) {
+        case NOTE_TABLE:
+            return sh->waitForTable[g];
+        case NOTE_REQUEST:
+            return sh->requestReceived[g];
+        case NOTE_FOOD:
+            return sh->foodArrived[g];
+        default:
+            return sh->tableDone[g];
+    }
+}
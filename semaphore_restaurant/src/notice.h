@@ -0,0 +1,68 @@
+/**
+ *  \file notice.h (interface file)
+ *
+ *  \brief Problem name: Restaurant
+ *
+ *  \brief Notices to the groups.
+ *
+ *  The servers tell a group that it may go on (it got a table or was turned away, its request was
+ *  received, its food arrived, its payment was received) by posting a notice (NOTE_*). When each group
+ *  runs in a process of its own, a notice is an <em>up</em> of the semaphore of the group that stands
+ *  for it. When the groups run as coroutines, they have no semaphores: a notice is a count in the
+ *  shared region (<tt>notice[slot][NOTE_*]</tt>), and the semaphore of the host of the group is upped,
+ *  so a host waits on one semaphore whatever the number of its groups. The count is raised before the
+ *  <em>up</em> and taken after the host wakes up, so no notice is lost.
+ *
+ *  Defined operations:
+ *     \li posting a notice
+ *     \li taking a notice
+ *     \li semaphore of a notice.
+ */
+
+#ifndef NOTICE_H_
+#define NOTICE_H_
+
+#include <stdbool.h>
+
+#include "sharedDataSync.h"
+
+/**
+ *  \brief Posting a notice.
+ *
+ *  \param semgid semaphore set access identifier
+ *  \param sh pointer to the shared region
+ *  \param g group id
+ *  \param note notice (NOTE_*)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+extern int noticePost (int semgid, SHARED_DATA *sh, int g, int note);
+
+/**
+ *  \brief Taking a notice.
+ *
+ *  Only for groups run as coroutines: the count of the notice is lowered if it is not 0.
+ *
+ *  \param sh pointer to the shared region
+ *  \param g group id
+ *  \param note notice (NOTE_*)
+ *
+ *  \return true if a notice was taken, false if none was posted
+ */
+extern bool noticeTake (SHARED_DATA *sh, int g, int note);
+
+/**
+ *  \brief Semaphore of a notice.
+ *
+ *  Only for groups run in processes of their own.
+ *
+ *  \param sh pointer to the shared region
+ *  \param g group id
+ *  \param note notice (NOTE_*)
+ *
+ *  \return semaphore location in the set
+ */
+extern unsigned int noticeSem (SHARED_DATA *sh, int g, int note);
+
+#endif /* NOTICE_H_ */
@@ -0,0 +1,216 @@
+/**
+ *  \file placement.c (implementation file)
+ *
+ *  \brief Problem name: Restaurant
+ *
+ *  \brief Placement of the entity processes on CPUs and scheduling policy of the servers.
+ *
+ *  CPU sets are intersected with the affinity of the main program, so a placement never names a
+ *  CPU the entities could not run on (taskset or cgroup limits are honoured). The affinity is set
+ *  with sched_setaffinity between fork and exec, and it is kept by the new program.
+ *
+ *  Defined operations:
+ *     \li parsing a placement
+ *     \li pinning an entity process
+ *     \li checking that a real-time policy is permitted
+ *     \li setting the scheduling policy of a server process.
+ */
+
+#define _GNU_SOURCE                                                             /* CPU sets, affinity */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+
+#include "probConst.h"
+#include "placement.h"
+
+/** \brief maximum length of a CPU list */
+#define  LISTLEN        256
+
+/* internal functions */
+
+/** \brief adding the CPUs of a list of CPUs, ranges and NUMA nodes to a set; false if malformed */
+static bool cpuList (const char *list, cpu_set_t *set, int depth)
+{
+    char buf[LISTLEN], node[LISTLEN], path[64], *tok, *save;
+    FILE *fp;
+    int a, b, n, offs;
+
+    if ((strlen (list) >= LISTLEN) || (depth > 1)) {
+        return false;
+    }
+    strcpy (buf, list);
+    for (tok = strtok_r (buf, ",", &save); tok != NULL; tok = strtok_r (NULL, ",", &save)) {
+        if (strncasecmp (tok, "node", 4) == 0) {                                            /* NUMA node */
+            if ((sscanf (tok + 4, "%d%n", &n, &offs) != 1) || (tok[4 + offs] != '\0')) {
+                return false;
+            }
+            snprintf (path, sizeof (path), "/sys/devices/system/node/node%d/cpulist", n);
+            if ((fp = fopen (path, "r")) == NULL) {
+                return false;
+            }
+            n = (fgets (node, LISTLEN, fp) != NULL);
+            fclose (fp);
+            node[strcspn (node, "\n")] = '\0';
+            if (!n || !cpuList (node, set, depth + 1)) {
+                return false;
+            }
+            continue;
+        }
+        n = sscanf (tok, "%d%n-%d%n", &a, &offs, &b, &offs);
+        if (n == 1) {
+            b = a;
+        }
+        if ((n < 1) || (tok[offs] != '\0') || (a < 0) || (b < a) || (b >= CPU_SETSIZE)) {
+            return false;
+        }
+        for (; a <= b; a++) {
+            CPU_SET (a, set);
+        }
+    }
+    return true;
+}
+
+/** \brief n-th CPU of a set, counting round */
+static int nthCpu (cpu_set_t *set, int n)
+{
+    int c;
+
+    n %= CPU_COUNT (set);
+    for (c = 0; c < CPU_SETSIZE; c++) {
+        if (CPU_ISSET (c, set) && (n-- == 0)) {
+            return c;
+        }
+    }
+    return -1;
+}
+
+/** \brief scheduler policy of a REALTIME_* id */
+static int schedPolicy (int realtime)
+{
+    return (realtime == REALTIME_RR) ? SCHED_RR : SCHED_FIFO;
+}
+
+/* external functions */
+
+int placementParse (const char *spec, PLACEMENT *pl)
+{
+    cpu_set_t allowed;
+    char word[16], list[4][LISTLEN];
+    int k, n, c;
+
+    memset (pl, 0, sizeof (PLACEMENT));
+    if (sched_getaffinity (0, sizeof (allowed), &allowed) == -1) {
+        return -1;
+    }
+    n = CPU_COUNT (&allowed);
+    if ((spec == NULL) || (sscanf (spec, "%15s", word) != 1) || (strcasecmp (word, "NONE") == 0)) {
+        pl->mode = PLACE_NONE;
+        return 0;
+    }
+    if (strcasecmp (word, "ISOLATED") == 0) {
+        pl->mode = PLACE_ISOLATED;
+        for (k = PLACE_CHEF; k <= PLACE_RECEPTIONIST; k++) {
+            CPU_SET (nthCpu (&allowed, k), &pl->cpus[k]);
+        }
+        for (k = 3; k < n; k++) {
+            CPU_SET (nthCpu (&allowed, k), &pl->cpus[PLACE_GROUPS]);
+        }
+        if (n <= 3) {
+            pl->cpus[PLACE_GROUPS] = allowed;
+        }
+        pl->spread = true;
+        return 0;
+    }
+    if (strcasecmp (word, "ONECORE") == 0) {
+        pl->mode = PLACE_ONECORE;
+        c = nthCpu (&allowed, 0);
+        for (k = PLACE_CHEF; k <= PLACE_GROUPS; k++) {
+            CPU_SET (c, &pl->cpus[k]);
+        }
+        return 0;
+    }
+    if ((strcasecmp (word, "CUSTOM") == 0) &&
+        (sscanf (spec, "%*s %255s %255s %255s %255s", list[0], list[1], list[2], list[3]) == 4)) {
+        pl->mode = PLACE_CUSTOM;
+        for (k = PLACE_CHEF; k <= PLACE_GROUPS; k++) {
+            if (!cpuList (list[k], &pl->cpus[k], 0)) {
+                break;
+            }
+            CPU_AND (&pl->cpus[k], &pl->cpus[k], &allowed);
+            if (CPU_COUNT (&pl->cpus[k]) == 0) {
+                break;
+            }
+        }
+        if (k > PLACE_GROUPS) {
+            return 0;
+        }
+    }
+    errno = EINVAL;
+    return -1;
+}
+
+void placementApply (PLACEMENT *pl, int kind, int index)
+{
+    cpu_set_t one;
+
+    if (pl->mode == PLACE_NONE) {
+        return;
+    }
+    if ((kind == PLACE_GROUPS) && pl->spread && (index >= 0)) {
+        CPU_ZERO (&one);
+        CPU_SET (nthCpu (&pl->cpus[kind], index), &one);
+        if (sched_setaffinity (0, sizeof (one), &one) == -1) {
+            perror ("error on setting the CPU affinity of a group");
+            exit (EXIT_FAILURE);
+        }
+    }
+    else if (sched_setaffinity (0, sizeof (cpu_set_t), &pl->cpus[kind]) == -1) {
+        perror ("error on setting the CPU affinity");
+        exit (EXIT_FAILURE);
+    }
+}
+
+int realtimeCheck (int realtime, int priority[])
+{
+    struct sched_param own, param;
+    int policy = schedPolicy (realtime), ownPolicy, s;
+
+    param.sched_priority = 0;
+    for (s = 0; s < NSERVERS; s++) {
+        if ((priority[s] < sched_get_priority_min (policy)) || (priority[s] > sched_get_priority_max (policy))) {
+            errno = EINVAL;
+            return -1;
+        }
+        if (priority[s] > param.sched_priority) {
+            param.sched_priority = priority[s];
+        }
+    }
+    if (((ownPolicy = sched_getscheduler (0)) == -1) || (sched_getparam (0, &own) == -1)) {
+        return -1;
+    }
+    if (sched_setscheduler (0, policy, &param) == -1) {
+        return -1;
+    }
+    if (sched_setscheduler (0, ownPolicy, &own) == -1) {
+        perror ("error on restoring the scheduling policy");
+        exit (EXIT_FAILURE);
+    }
+    return 0;
+}
+
+void realtimeApply (int realtime, int priority)
+{
+    struct sched_param param;
+
+    if (realtime == REALTIME_OFF) {
+        return;
+    }
+    param.sched_priority = priority;
+    if (sched_setscheduler (0, schedPolicy (realtime), &param) == -1) {
+        perror ("warning: real-time scheduling not set, the default policy is kept");
+    }
+}
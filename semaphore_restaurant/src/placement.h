@@ -0,0 +1,108 @@
+/**
+ *  \file placement.h (interface file)
+ *
+ *  \brief Problem name: Restaurant
+ *
+ *  \brief Placement of the entity processes on CPUs and scheduling policy of the servers.
+ *
+ *  A placement is given by a line of text:
+ *     \li <tt>NONE</tt> the scheduler places the entities (default)
+ *     \li <tt>ISOLATED</tt> the chef, the waiter and the receptionist on a CPU of their own, each group on
+ *         one of the remaining CPUs, round robin (CPUs are reused if there are fewer than four)
+ *     \li <tt>ONECORE</tt> every entity on the same CPU
+ *     \li <tt>CUSTOM chef waiter receptionist groups</tt> the CPUs of each kind of entity, as a list of CPUs
+ *         and ranges (<tt>0-3,6</tt>) and/or NUMA nodes (<tt>node1</tt>).
+ *
+ *  Only the CPUs the main program may run on are used.
+ *
+ *  The chef, the waiter and the receptionist may also be run with a real-time policy (SCHED_FIFO or
+ *  SCHED_RR), so they preempt the groups as soon as a request is made. Whether it is permitted
+ *  (root, CAP_SYS_NICE or RLIMIT_RTPRIO) is checked before any entity is created.
+ *
+ *  Defined operations:
+ *     \li parsing a placement
+ *     \li pinning an entity process
+ *     \li checking that a real-time policy is permitted
+ *     \li setting the scheduling policy of a server process.
+ */
+
+#ifndef PLACEMENT_H_
+#define PLACEMENT_H_
+
+#include <sched.h>                                             /* CPU sets need _GNU_SOURCE in the includer */
+#include <stdbool.h>
+
+/** \brief placement modes */
+#define  PLACE_NONE         0
+#define  PLACE_ISOLATED     1
+#define  PLACE_ONECORE      2
+#define  PLACE_CUSTOM       3
+
+/** \brief kinds of entity, index of their CPU sets */
+#define  PLACE_CHEF         0
+#define  PLACE_WAITER       1
+#define  PLACE_RECEPTIONIST 2
+#define  PLACE_GROUPS       3
+
+/**
+ *  \brief Definition of a placement.
+ */
+typedef struct {
+    /** \brief placement mode (PLACE_*) */
+    int mode;
+    /** \brief CPUs of each kind of entity (indexed by PLACE_CHEF .. PLACE_GROUPS) */
+    cpu_set_t cpus[4];
+    /** \brief each group is pinned to one CPU of its set, in turn, instead of the whole set */
+    bool spread;
+} PLACEMENT;
+
+/**
+ *  \brief Parsing a placement.
+ *
+ *  \param spec placement, as described above (case is ignored)
+ *  \param pl pointer to the placement
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, if the placement is malformed or names no CPU that may be used (<tt>errno</tt> is EINVAL)
+ */
+extern int placementParse (const char *spec, PLACEMENT *pl);
+
+/**
+ *  \brief Pinning the calling process.
+ *
+ *  To be called by the child process, before exec, so the placement is in force from its first
+ *  instruction. The program is terminated if the affinity can not be set.
+ *
+ *  \param pl pointer to the placement
+ *  \param kind kind of entity (PLACE_CHEF .. PLACE_GROUPS)
+ *  \param index group id (slot), used to spread the groups (-1 for a process that launches groups: all their CPUs)
+ */
+extern void placementApply (PLACEMENT *pl, int kind, int index);
+
+/**
+ *  \brief Checking that a real-time policy is permitted.
+ *
+ *  The calling process is switched to the policy with the highest of the priorities, then back to its
+ *  own policy.
+ *
+ *  \param realtime scheduling policy (REALTIME_FIFO or REALTIME_RR)
+ *  \param priority priorities of the servers (indexed by SRV_*)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, if a priority is out of range (<tt>errno</tt> is EINVAL) or the policy is not permitted
+ *  (<tt>errno</tt> is EPERM)
+ */
+extern int realtimeCheck (int realtime, int priority[]);
+
+/**
+ *  \brief Setting the scheduling policy of the calling process.
+ *
+ *  To be called by the child process, before exec. If it fails, a warning is written and the process
+ *  keeps the default policy.
+ *
+ *  \param realtime scheduling policy (REALTIME_*, nothing is done for REALTIME_OFF)
+ *  \param priority real-time priority
+ */
+extern void realtimeApply (int realtime, int priority);
+
+#endif /* PLACEMENT_H_ */
@@ -13,10 +13,18 @@
 
 /* Generic parameters */
 
-/** \brief maximum number of groups */
-#define  MAXGROUPS       16 
-/** \brief number of tables */
+/** \brief maximum number of groups (group slots of a shard) */
+#define  MAXGROUPS     4096
+/** \brief default number of group slots of a shard, with open-loop arrivals */
+#define  NUMSLOTS        16
+/** \brief maximum number of tables */
+#define  MAXTABLES       16
+/** \brief default number of tables */
 #define  NUMTABLES        2 
+/** \brief default table capacity (seats) */
+#define  TABLECAP         4
+/** \brief default group size (persons) */
+#define  GROUPSIZE        4
 /** \brief controls time taken to cook */
 #define  MAXCOOK        100
 
@@ -25,6 +33,24 @@
 /** \brief controls eat time standard deviation */
 #define  EATDEV           4 
 
+/** \brief maximum number of processes hosting the groups of a restaurant as coroutines */
+#define  MAXHOSTS         8
+/** \brief default stack size of a group coroutine (KiB) */
+#define  COSTACK         64
+
+/** \brief maximum number of locations in the semaphore set (location 0 included, see sharedDataSync.h) */
+#define  MAXSEMS         (8 + 4 * MAXGROUPS + MAXHOSTS)
+/** \brief number of kinds of semaphores whose wakeup latency is measured: location 0, the 7 of the servers,
+    the 4 arrays of the groups and the semaphores of the hosts (see sharedDataSync.h) */
+#define  SEMKINDS        13
+
+/** \brief log2 of the number of histogram buckets per power of two */
+#define  HISTSUBBITS      3
+/** \brief number of histogram buckets per power of two */
+#define  HISTSUB         (1 << HISTSUBBITS)
+/** \brief number of histogram buckets (covers values up to 2^40) */
+#define  HISTBUCKETS     (HISTSUB * 40)
+
 /** \brief id of table request (group->receptionist) */
 #define TABLEREQ   1
 /** \brief id of bill request (group->receptionist) */
@@ -33,6 +59,8 @@
 #define FOODREQ   3
 /** \brief id of food ready (chef->waiter) */
 #define FOODREADY 4
+/** \brief id of closing request, the poison pill that ends a server (launcher->receptionist, launcher->waiter) */
+#define CLOSEREQ  5
 
 /* Client state constants */
 
@@ -50,6 +78,21 @@
 #define  CHECKOUT          6
 /** \brief client is leaving */
 #define  LEAVING           7
+/** \brief size of arrays indexed by group state */
+#define  GROUPSTATES       8
+
+/* Server ids (index of the arrays of the chef, waiter and receptionist) */
+
+/** \brief chef */
+#define  SRV_CHEF           0
+/** \brief waiter */
+#define  SRV_WAITER         1
+/** \brief receptionist */
+#define  SRV_RECEPTIONIST   2
+/** \brief number of servers */
+#define  NSERVERS           3
+/** \brief the groups, in arrays indexed by entity (after the servers) */
+#define  ENT_GROUPS         NSERVERS
 
 /* Chef state constants */
 
@@ -76,5 +119,182 @@
 /** \brief waiter reiceives payment */
 #define  RECVPAY            2
 
+/* Receptionist view of each group (see RECEPTION) */
+
+/** \brief the group did not check in yet (or the slot is free) */
+#define TOARRIVE            0
+/** \brief the group waits for a table */
+#define WAIT                1
+/** \brief the group was given a table */
+#define ATTABLE             2
+/** \brief the group paid */
+#define DONE                3
+
+/* Receptionist scheduling policies (order in which waiting groups get a table) */
+
+/** \brief lowest group id first */
+#define  POLICY_LOWESTID    0
+/** \brief first come (to the receptionist) first served */
+#define  POLICY_FIFO        1
+/** \brief shortest expected meal first */
+#define  POLICY_SMF         2
+/** \brief earliest arrival at the restaurant first */
+#define  POLICY_EARLIEST    3
+/** \brief number of scheduling policies */
+#define  NUMPOLICIES        4
+
+/* Arrival processes */
+
+/** \brief groups and their start times are listed in the config file */
+#define  ARRIVALS_CONFIG    0
+/** \brief Poisson arrivals */
+#define  ARRIVALS_POISSON   1
+/** \brief Poisson arrivals during on periods, none during off periods */
+#define  ARRIVALS_BURSTY    2
+/** \brief Poisson arrivals with a sinusoidal rate */
+#define  ARRIVALS_DIURNAL   3
+/** \brief arrivals streamed from a binary workload file */
+#define  ARRIVALS_FILE      4
+
+/** \brief maximum length of the name of a workload file */
+#define  WLNAMELEN        256
+
+/* Record and replay of the order of semaphore grants */
+
+/** \brief grants are neither recorded nor replayed */
+#define  REPLAY_OFF         0
+/** \brief grants are recorded */
+#define  REPLAY_RECORD      1
+/** \brief grants are replayed in a recorded order */
+#define  REPLAY_REPLAY      2
+
+/* Scheduling policy of the servers */
+
+/** \brief default scheduler */
+#define  REALTIME_OFF       0
+/** \brief SCHED_FIFO */
+#define  REALTIME_FIFO      1
+/** \brief SCHED_RR */
+#define  REALTIME_RR        2
+/** \brief default real-time priority */
+#define  RTPRIORITY        10
+
+/* State of a group slot, when groups are hosted as coroutines */
+
+/** \brief no group */
+#define  SLOT_FREE          0
+/** \brief a group was placed in the slot by the main program, its host has not started it yet */
+#define  SLOT_READY         1
+/** \brief the group is run by its host */
+#define  SLOT_RUNNING       2
+/** \brief the group left, the slot is to be freed by the main program */
+#define  SLOT_DONE          3
+
+/* Notices to the groups run as coroutines, which take the place of their semaphores (see notice.h) */
+
+/** \brief the group was given a table or turned away (waitForTable) */
+#define  NOTE_TABLE         0
+/** \brief the waiter received the food request of the group (requestReceived) */
+#define  NOTE_REQUEST       1
+/** \brief the food of the group arrived (foodArrived) */
+#define  NOTE_FOOD          2
+/** \brief the payment of the group was received (tableDone) */
+#define  NOTE_PAID          3
+/** \brief number of kinds of notices */
+#define  NOTICES            4
+
+/* How the group processes are launched */
+
+/** \brief fork and exec of the group program for each group */
+#define  LAUNCH_EXEC        0
+/** \brief fork of an attached template process of the group program for each group (no exec) */
+#define  LAUNCH_FORKSERVER  1
+
+/* Checkpoint and resume of a run (see checkpoint.h) */
+
+/** \brief no checkpoint */
+#define  CKPT_OFF           0
+/** \brief the state of the run is saved once quiescent, after a time or on SIGUSR1 */
+#define  CKPT_SAVE          1
+/** \brief the run starts from a saved state */
+#define  CKPT_RESUME        2
+/** \brief longest time spent looking for a quiescent point to save the state at (ms) */
+#define  CKPTWAIT        5000
+
+/* Jitter injection and watchdog (see jitter.h) */
+
+/** \brief random delay before and after every down of the mutex */
+#define  JIT_MUTEX          1
+/** \brief random delay between storing a request for a server and the up of its request semaphore */
+#define  JIT_REQUEST        2
+/** \brief random delay inside saveState, while the state is logged */
+#define  JIT_SAVE           4
+/** \brief all the points where delays are injected */
+#define  JIT_ALL            (JIT_MUTEX | JIT_REQUEST | JIT_SAVE)
+/** \brief period of the checks of the watchdog (ms) */
+#define  WATCHDOGTICK     100
+
+/* Admission of the groups to the waiting room (see semSharedMemReceptionist.c) */
+
+/** \brief every group that can not be seated waits */
+#define  ADMIT_OFF          0
+/** \brief a group that can not be seated is turned away if the waiting room is full */
+#define  ADMIT_FULL         1
+/** \brief a group that can not be seated is turned away if its estimated wait is too long (or the room is full) */
+#define  ADMIT_WAIT         2
+/** \brief number of slots of a timeline */
+#define  TIMESLOTS         64
+/** \brief initial length of a slot of a timeline (ms), doubled whenever the slots run out */
+#define  TIMESLOT         100
+
+/* Kitchen of several stations cooking the dishes of a menu (see semSharedMemChef.c) */
+
+/** \brief maximum number of station types */
+#define  MAXSTATIONS        8
+/** \brief maximum number of dishes on the menu */
+#define  MAXDISHES         16
+/** \brief maximum length of the name of a station or of a dish */
+#define  KITCHENNAMELEN    16
+/** \brief maximum number of dishes in the kitchen at once, cooking or waiting for a station */
+#define  KITCHENDISHES    256
+
+/* Sharding: independent restaurants fed by a front-door dispatcher */
+
+/** \brief maximum number of shards */
+#define  MAXSHARDS          8
+/** \brief arriving groups go to the shard with the fewest groups waiting for a table */
+#define  DISPATCH_LEAST     0
+/** \brief arriving groups go to the less loaded of two shards drawn at random */
+#define  DISPATCH_P2C       1
+
+/* Event channels of the event-driven servers, index of their eventfds (see events.h) */
+
+/** \brief requests of the groups to the waiter */
+#define  EV_WAITER          0
+/** \brief ready food notices of the chef to the waiter */
+#define  EV_FOODREADY       1
+/** \brief closing of the restaurant, to the waiter */
+#define  EV_CLOSEWAITER     2
+/** \brief requests of the groups to the receptionist */
+#define  EV_RECEPTIONIST    3
+/** \brief closing of the restaurant, to the receptionist */
+#define  EV_CLOSERECEPT     4
+/** \brief number of channels */
+#define  NEVENTS            5
+/** \brief housekeeping timer of a server (not a channel) */
+#define  EV_TICK            NEVENTS
+/** \brief default period of the housekeeping timer (ms) */
+#define  EVTICK           100
+
+/* Meal time distributions */
+
+/** \brief constant meal time */
+#define  MEAL_CONST         0
+/** \brief uniformly distributed meal time */
+#define  MEAL_UNIFORM       1
+/** \brief normally distributed meal time */
+#define  MEAL_NORMAL        2
+/** \brief exponentially distributed meal time */
+#define  MEAL_EXP           3
 
 #endif /* PROBCONST_H_ */
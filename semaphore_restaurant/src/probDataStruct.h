@@ -27,6 +27,169 @@ typedef struct {
     int reqGroup;
 } request;
 
+/**
+ *  \brief Definition of the queue of requests to an event-driven server
+ *
+ *  A group has at most one request to each server at a time, so a queue never holds more than
+ *  MAXGROUPS requests.
+ */
+typedef struct {
+    /** \brief requests, in the order they were made */
+    request req[MAXGROUPS];
+    /** \brief number of requests */
+    int n;
+} REQUEST_QUEUE;
+
+/**
+ *  \brief Definition of a latency histogram (values in microseconds)
+ */
+typedef struct {
+    /** \brief number of samples */
+    unsigned long count;
+    /** \brief sum of samples */
+    double sum;
+    /** \brief largest sample */
+    long long max;
+    /** \brief number of samples in each bucket */
+    unsigned long bucket[HISTBUCKETS];
+} HISTOGRAM;
+
+
+/**
+ *  \brief Definition of a timeline: the largest value of a level in each slot of time
+ *
+ *  The slots start at the start of operations; when they run out, pairs of slots are merged and
+ *  their length doubled, so a timeline covers a run of any length.
+ */
+typedef struct {
+    /** \brief length of a slot (us) */
+    long long slot;
+    /** \brief number of slots up to the last change */
+    int n;
+    /** \brief largest value in each slot */
+    int max[TIMESLOTS];
+    /** \brief value since the last change */
+    int last;
+} TIMELINE;
+
+
+/**
+ *  \brief Definition of the workload generator parameters (open-loop arrivals)
+ */
+typedef struct {
+    /** \brief arrival process (ARRIVALS_*) */
+    int arrivals;
+    /** \brief mean arrival rate (groups per second, during on periods if bursty) */
+    double rate;
+    /** \brief duration of on periods (bursty, ms) */
+    int onTime;
+    /** \brief duration of off periods (bursty, ms) */
+    int offTime;
+    /** \brief relative amplitude of the rate variation (diurnal, 0 .. 1) */
+    double amplitude;
+    /** \brief period of the rate variation (diurnal, ms) */
+    int period;
+    /** \brief meal time distribution (MEAL_*) */
+    int meal;
+    /** \brief first meal time parameter (us) */
+    double mealA;
+    /** \brief second meal time parameter (us) */
+    double mealB;
+    /** \brief smallest group size */
+    int minSize;
+    /** \brief largest group size */
+    int maxSize;
+    /** \brief name of the binary workload file (file arrivals) */
+    char file[WLNAMELEN];
+} GENERATOR;
+
+
+/**
+ *  \brief Definition of the view of the receptionist on the groups and tables
+ *
+ *  Kept in the shared region, not by the receptionist process, so that it is part of a checkpoint.
+ */
+typedef struct {
+    /** \brief evolution of each group, as seen by the receptionist (TOARRIVE, WAIT, ATTABLE or DONE) */
+    int groupRecord[MAXGROUPS];
+    /** \brief order in which groups checked in at reception */
+    long long checkInOrder[MAXGROUPS];
+    /** \brief number of groups that checked in so far */
+    long long nCheckIns;
+    /** \brief time at which each table got occupied (us) */
+    long long tableSince[MAXTABLES];
+    /** \brief time at which each group was seated (us) */
+    long long seatSince[MAXGROUPS];
+    /** \brief tables joined for a single group (not to be shared) */
+    bool tableJoined[MAXTABLES];
+} RECEPTION;
+
+
+/**
+ *  \brief Definition of the admission of the groups to the waiting room and of its statistics
+ *
+ *  A group that can not be seated when it checks in waits for a table, unless the admission policy
+ *  turns it away: it then leaves at once.
+ */
+typedef struct {
+    /** \brief admission policy (ADMIT_*) */
+    int policy;
+    /** \brief largest number of groups waiting for a table (-1: no limit) */
+    int capacity;
+    /** \brief longest estimated wait of an admitted group (ms, ADMIT_WAIT) */
+    int maxWait;
+    /** \brief number of groups seated at once or admitted to the waiting room */
+    unsigned long admitted;
+    /** \brief number of groups turned away because the waiting room was full */
+    unsigned long rejectedFull;
+    /** \brief number of groups turned away because their estimated wait was too long */
+    unsigned long rejectedWait;
+    /** \brief total time groups held their tables and number of groups that left them (estimate of the wait) */
+    long long stayTime;
+    unsigned long stays;
+    /** \brief number of groups waiting integrated over time (us) and time of its last change (us) */
+    long long depthArea;
+    long long depthSince;
+    /** \brief number of groups waiting over time */
+    TIMELINE depth;
+} ADMISSION;
+
+
+/**
+ *  \brief Definition of the kitchen: its stations, the menu and their statistics
+ *
+ *  Each person of a group orders a dish of the menu, which is cooked on a station of its type; a station
+ *  cooks as many dishes at once as its capacity. With no stations, the chef cooks a whole order at once.
+ */
+typedef struct {
+    /** \brief number of station types (0: no stations) */
+    int nStations;
+    /** \brief name of each station type */
+    char stationName[MAXSTATIONS][KITCHENNAMELEN];
+    /** \brief number of dishes each station type cooks at once */
+    int stationCapacity[MAXSTATIONS];
+    /** \brief number of dishes on the menu */
+    int nDishes;
+    /** \brief name of each dish */
+    char dishName[MAXDISHES][KITCHENNAMELEN];
+    /** \brief station type each dish is cooked on */
+    int dishStation[MAXDISHES];
+    /** \brief shortest and longest cooking time of each dish (ms, drawn uniformly) */
+    int dishMin[MAXDISHES], dishMax[MAXDISHES];
+    /** \brief time at which the next dish being cooked is done (us, 0 if none) */
+    long long nextDone;
+    /** \brief total time each station type cooked, summed over its units (us) */
+    long long stationBusy[MAXSTATIONS];
+    /** \brief number of dishes cooked on each station type */
+    unsigned long stationDishes[MAXSTATIONS];
+    /** \brief time dishes waited for a free unit of each station type (us) */
+    HISTOGRAM stationWait[MAXSTATIONS];
+    /** \brief longest queue of dishes waiting for each station type */
+    int stationQueueMax[MAXSTATIONS];
+    /** \brief time from taking an order until its last dish is done (us) */
+    HISTOGRAM orderTime;
+} KITCHEN;
+
 
 /**
  *  \brief Definition of <em>state of the intervening entities</em> data type.
@@ -51,8 +214,64 @@ typedef struct
 {   /** \brief state of all intervening entities */
     STAT st;
 
-    /** \brief number of groups */
+    /** \brief number of groups (slots, in open-loop mode a slot is reused once its group leaves) */
     int nGroups;
+    /** \brief number of groups that visit the restaurant during the simulation (0 if unbounded) */
+    int totalGroups;
+    /** \brief set when the restaurant is closing: no more groups arrive, servers exit on CLOSEREQ */
+    bool closing;
+    /** \brief workload generator parameters */
+    GENERATOR gen;
+    /** \brief name of the trace file, a timestamped copy of the log (empty if not traced) */
+    char traceFile[WLNAMELEN];
+    /** \brief placement of the entities on CPUs (see placement.h, empty if none) */
+    char placement[WLNAMELEN];
+    /** \brief scheduling policy of the servers (REALTIME_*) */
+    int realtime;
+    /** \brief real-time priority of each server (indexed by SRV_*) */
+    int rtPriority[NSERVERS];
+    /** \brief set if a real-time policy was requested but is not permitted (servers use the default one) */
+    bool realtimeDenied;
+    /** \brief number of shards, independent restaurants with regions and servers of their own */
+    int nShards;
+    /** \brief how the dispatcher routes arriving groups to shards (DISPATCH_*) */
+    int dispatch;
+    /** \brief number of processes hosting the groups as coroutines (0: a process per group) */
+    int groupHosts;
+    /** \brief stack size of a group coroutine (KiB) */
+    int coStack;
+    /** \brief how the group processes are launched (LAUNCH_*) */
+    int launch;
+    /** \brief set if the waiter and the receptionist run event loops on eventfds instead of waiting on semaphores */
+    bool eventLoop;
+    /** \brief period of the housekeeping timer of the event loops (ms) */
+    int eventTick;
+    /** \brief descriptors of the event channels (indexed by EV_*, inherited by every entity) */
+    int eventFd[NEVENTS];
+    /** \brief set if the time from each up until the down it unblocks returns is measured */
+    bool semTiming;
+    /** \brief record or replay of the order of semaphore grants (REPLAY_*) */
+    int replay;
+    /** \brief name of the file of the grant log (recorded or replayed) */
+    char replayFile[WLNAMELEN];
+    /** \brief checkpoint of the run (CKPT_*) */
+    int checkpoint;
+    /** \brief name of the checkpoint file (saved or resumed from) */
+    char checkpointFile[WLNAMELEN];
+    /** \brief time after the start of operations at which the state is saved (ms, 0: on SIGUSR1 only) */
+    int checkpointAt;
+    /** \brief set if the restaurant closes once the state is saved */
+    bool checkpointStop;
+    /** \brief points where random delays are injected (JIT_* bit mask, 0: none) */
+    int jitter;
+    /** \brief distribution of the injected delays (MEAL_*, the distributions of the meal times) */
+    int jitterDist;
+    /** \brief parameters of the distribution of the injected delays (us) */
+    double jitterA, jitterB;
+    /** \brief time without a change of state after which a run is taken as stalled (ms, 0: no watchdog) */
+    int watchdog;
+    /** \brief random seed of the run, each entity draws from a stream of it of its own (0: chosen at start) */
+    unsigned int seed;
     /** \brief number of groups waiting for table */
     int groupsWaiting;
 
@@ -61,21 +280,115 @@ typedef struct
     /** \brief estimated eat time of groups */
     int eatTime[MAXGROUPS];
 
-    /** \brief saves the table that is being used by each group */
+    /** \brief number of persons in each group */
+    int groupSize[MAXGROUPS];
+
+    /** \brief number of tables */
+    int nTables;
+    /** \brief number of seats of each table */
+    int tableCapacity[MAXTABLES];
+    /** \brief groups with free seats left at their table may share it with other groups */
+    bool tableShare;
+    /** \brief groups larger than any table may join several vacant tables */
+    bool tableJoin;
+    /** \brief number of seats in use at each table */
+    int tableSeats[MAXTABLES];
+
+    /** \brief saves the table that is being used by each group (lowest one, if several were joined) */
     int assignedTable[MAXGROUPS];
+    /** \brief set of tables (bit mask) used by each group */
+    unsigned int groupTables[MAXGROUPS];
+
+    /** \brief scheduling policy used by receptionist to choose next waiting group */
+    int policy;
+    /** \brief view of the receptionist on the groups and tables */
+    RECEPTION reception;
+    /** \brief stations and menu of the kitchen */
+    KITCHEN kitchen;
+    /** \brief admission of the groups to the waiting room */
+    ADMISSION admission;
+    /** \brief set for the group of each slot that was turned away (cleared when the slot is reused) */
+    bool rejected[MAXGROUPS];
+    /** \brief set for the group of each slot whose process, forked by the fork server, failed (cleared when the
+        slot is reused) */
+    bool failed[MAXGROUPS];
+    /** \brief number of group processes forked by the fork server that failed, and the wait status of the first */
+    int workersFailed;
+    int workerStatus;
+    /** \brief arrival number of the group in each slot (0 .. totalGroups - 1), names its random number stream */
+    int groupArrival[MAXGROUPS];
+    /** \brief state of each group slot, when groups are hosted (SLOT_*) */
+    int slotState[MAXGROUPS];
+    /** \brief notices posted to the group of each slot, not yet taken (coroutines only, indexed by NOTE_*) */
+    unsigned int notice[MAXGROUPS][NOTICES];
+    /** \brief time at which each group arrived at the restaurant (us) */
+    long long arrivalTime[MAXGROUPS];
+    /** \brief time at which each group going to the restaurant arrives, or each eating group ends its meal (us) */
+    long long wakeTime[MAXGROUPS];
+    /** \brief set for the groups restored from a checkpoint, which resume in the state they were in */
+    bool resumed[MAXGROUPS];
 
     /** \brief flag of food request from waiter to chef */
     int foodOrder;
     /** \brief group associated to food request from waiter to chef */
     int foodGroup;
 
+    /** \brief groups whose food is ready to be taken to table (chef->waiter) */
+    int foodReady[MAXGROUPS];
+    /** \brief number of groups in foodReady */
+    int nFoodReady;
+    /** \brief set while the chef has notified the waiter (waiterRequest) and foodReady was not yet collected */
+    bool foodReadyPending;
+
 
     /** \brief used by groups to store request to receptionist */
     request receptionistRequest;
 
-    /** \brief used by groups and chef to store request to waiter */
+    /** \brief used by groups to store request to waiter (chef uses foodReady) */
     request waiterRequest;
 
+    /** \brief requests of the groups to the receptionist, when it runs an event loop */
+    REQUEST_QUEUE receptionistQueue;
+
+    /** \brief requests of the groups to the waiter, when it runs an event loop */
+    REQUEST_QUEUE waiterQueue;
+
+    /** \brief time at which the simulation started (us) */
+    long long startRun;
+    /** \brief time at which the simulation ended (us) */
+    long long endRun;
+    /** \brief time from arrival at restaurant until being seated */
+    HISTOGRAM tableWait;
+    /** \brief time of the last up of the request semaphore of each server (us, indexed by SRV_*) */
+    long long wakeupStamp[NSERVERS];
+    /** \brief time from the up of its request semaphore until a waiting server runs (us, indexed by SRV_*) */
+    HISTOGRAM wakeup[NSERVERS];
+    /** \brief time at which each group entered each of its states (us, indexed by state) */
+    long long stateTime[MAXGROUPS][GROUPSTATES];
+    /** \brief time at which each server was launched (us, indexed by SRV_*) */
+    long long serverSpawn[NSERVERS];
+    /** \brief time at which the group of each slot was launched (us) */
+    long long groupSpawn[MAXGROUPS];
+    /** \brief time from launch until ready to run, waiting for the start excluded (us, by SRV_* and ENT_GROUPS) */
+    HISTOGRAM startup[NSERVERS + 1];
+    /** \brief time from the launch of a group, or the start of operations if later, until its first request (us) */
+    HISTOGRAM firstRequest;
+    /** \brief requests handled per wakeup by each event-driven server (indexed by SRV_*) */
+    HISTOGRAM batch[NSERVERS];
+    /** \brief number of states saved so far, by all entities (progress seen by the watchdog) */
+    unsigned long progress;
+    /** \brief time of the last housekeeping tick of each event-driven server (us, indexed by SRV_*) */
+    long long heartbeat[NSERVERS];
+    /** \brief time of the last up of each semaphore (ns, indexed by location in the set) */
+    long long semUpTime[MAXSEMS];
+    /** \brief time from an up until the down it unblocks returns (ns, indexed by kind of semaphore, see SEMKINDS) */
+    HISTOGRAM semWakeup[SEMKINDS];
+    /** \brief hosts with coroutines waiting on each semaphore (bit mask, indexed by location in the set) */
+    unsigned int semNotify[MAXSEMS];
+    /** \brief total time each table was occupied (us) */
+    long long tableBusy[MAXTABLES];
+    /** \brief total time seats were occupied, summed over all seats (us) */
+    long long seatBusy;
 
 } FULL_STAT;
 
@@ -8,21 +8,67 @@
  *
  *  Generator process of the intervening entities.
  *
- *  Upon execution, one parameter is requested:
- *    \li name of the logging file.
+ *  Upon execution, two optional parameters are accepted:
+ *    \li name of the logging file (stdout if missing or empty)
+ *    \li name of a CSV file to which a line with the results of the run is appended.
+ *
+ *  They may be preceded by <tt>-p placement</tt>, the placement of the entities on CPUs (see placement.h),
+ *  which overrides the <tt>#placement</tt> section of the config file, and by <tt>-s file</tt>, the name of
+ *  a file to which a one-line JSON summary of the run is appended (see writeSummary and runStats.c).
+ *
+ *  The exit status is EXIT_FAILURE if an intervening entity process failed (exited with a non-zero
+ *  status or was killed by a signal).
+ *
+ *  Groups are either all created at start (groups listed in the config file) or created at their
+ *  arrival time, each in a free group slot, by an open-loop workload generator or as they are read
+ *  from a binary workload file.
+ *
+ *  With several shards (<tt>#shards</tt>), as many independent restaurants are run, each with its own
+ *  shared region, semaphore set, servers and group slots, and a front-door dispatcher routes every
+ *  arriving group to one of them by the number of groups waiting there. The log and trace files of
+ *  shard s are then named after the configured ones with the suffix <tt>.s</tt>.
+ *
+ *  With <tt>#coroutines</tt>, the groups of each shard are not processes of their own but coroutines
+ *  run by a few group processes (hosts, see semSharedMemGroup.c): a group is started by marking its
+ *  slot ready and notifying its host, and the host marks the slot done, and ups a semaphore of the
+ *  main program, when the group leaves. With <tt>#launch FORKSERVER</tt>, the single host of each shard
+ *  is a template that forks a process for each group, already attached, without exec.
+ *
+ *  The startup latency of every entity (from its launch until it is ready to run) is reported.
+ *
+ *  With <tt>#checkpoint SAVE</tt>, the state of the run is saved at a quiescent point, after a time or on
+ *  SIGUSR1, and with <tt>#checkpoint RESUME</tt> the run starts from a saved state: the groups inside are
+ *  started again, each resuming where it was, and the arrivals go on (see checkpoint.h).
+ *
+ *  With <tt>#watchdog</tt>, a run in which no state changes for that time while groups are inside (and
+ *  none is going to the restaurant or eating) is taken as stalled: the state of each shard is printed,
+ *  the processes are killed and the run fails. It is meant for the stress runs of <tt>#jitter</tt>
+ *  (see jitter.h).
+ *
+ *  The restaurant closes when all groups have been created or when SIGINT or SIGTERM is received
+ *  (a second one kills the generator): no more groups arrive, the groups inside are served and then
+ *  the servers are sent a closing request.
  *
  *  \author Nuno Lau - December 2023
  */
 
+#define _GNU_SOURCE                                                             /* CPU sets, affinity */
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <unistd.h>
+#include <signal.h>
+#include <errno.h>
 #include <sys/wait.h>
+#include <sys/resource.h>
+#include <sys/time.h>
 #include <sys/types.h>
 #include <sys/ipc.h>
 #include <string.h>
+#include <limits.h>
 #include <math.h>
+#include <time.h>
 
 #include "probConst.h"
 #include "probDataStruct.h"
@@ -30,6 +76,15 @@
 #include "sharedDataSync.h"
 #include "semaphore.h"
 #include "sharedMemory.h"
+#include "statistics.h"
+#include "config.h"
+#include "workload.h"
+#include "workloadFile.h"
+#include "replay.h"
+#include "rng.h"
+#include "placement.h"
+#include "events.h"
+#include "checkpoint.h"
 
 /** \brief name of chef process */
 #define   CHEF               "./chef"
@@ -42,200 +97,1833 @@
 
 /** \brief name of chef process */
 #define   RECEPTIONIST       "./receptionist"
+
+/** \brief group process identifier of a slot whose group is hosted (coroutine or fork server) */
+#define   HOSTED             -1
+
+/** \brief longest wait for a hosted group to leave (us), before looking for terminated processes */
+#define   LEFTWAIT           100000
+
+/** \brief time between two looks for a quiescent point to save the state at (us) */
+#define   CKPTPOLL           200
+
+/** \brief semaphore implementation the program was built with */
+#ifndef   SEMBACKEND
+#define   SEMBACKEND         "semaphore"
+#endif
+
+/** \brief random number stream of the open-loop workload generator */
+static RNG rng;
+
+/** \brief placement of the entities on CPUs */
+static PLACEMENT placement;
+
+/** \brief number of shards */
+static int nShards = 1;
+
+/** \brief chef, waiter and receptionist process identifiers (indexed by shard) */
+static int pidCH[MAXSHARDS], pidWT[MAXSHARDS], pidRT[MAXSHARDS];
+
+/** \brief number of processes hosting the groups of each shard (0: a process per group) */
+static int nHosts;
+
+/** \brief process identifiers of the hosts of the groups (indexed by shard and host) */
+static int pidHS[MAXSHARDS][MAXHOSTS];
+
+/** \brief semaphore set whose semaphore 1 is upped by the hosts each time a group leaves */
+static int leftgid;
+
+/** \brief CPU time (user + system) of the terminated chef, waiter, receptionist and groups (us) */
+static long long cpuCH, cpuWT, cpuRT, cpuGR;
+
+/** \brief number of groups that left the restaurant */
+static int nServed;
+
+/** \brief number of groups that left each shard */
+static int served[MAXSHARDS];
+
+/** \brief number of groups in the restaurant (in all the shards) and the most there were at once */
+static int nInside, insideMax;
+
+/** \brief time groups spent in each state (us, indexed by state) */
+static HISTOGRAM stateWait[GROUPSTATES];
+
+/** \brief time from ordering food until food arrives (us) */
+static HISTOGRAM foodWait;
+
+/** \brief number of processes of the chef, waiter, receptionist and groups (hosts included) that failed,
+    and the wait status of the first one of each kind (indexed by SRV_* and ENT_GROUPS) */
+static int nFailed[NSERVERS + 1];
+static int failStatus[NSERVERS + 1];
+
+/** \brief start of the program (us) */
+static long long wallStart;
+
+/** \brief names of the group states in the statistics, indexed by state */
+static const char *stateNames[GROUPSTATES] = { "", "going", "reception", "ordering", "food wait", "eating", "checkout", "" };
+
+/** \brief names of the group states in the keys of the JSON summary, indexed by state */
+static const char *stateKeys[GROUPSTATES] = { "", "going", "reception", "ordering", "food_wait", "eating", "checkout", "" };
+
+/** \brief set by SIGINT or SIGTERM: stop creating groups and close the restaurant */
+static volatile sig_atomic_t stopRequested = 0;
+
+/** \brief set by SIGUSR1 or SIGALRM (the time of the checkpoint): save the state of the run */
+static volatile sig_atomic_t checkpointRequested = 0;
+
+/** \brief set once the watchdog found the run stalled and killed its processes */
+static bool stalled;
+
+/** \brief progress seen by the watchdog (states saved by all shards) and the time it was last seen to change (us) */
+static unsigned long lastProgress;
+static long long progressSince;
+
+/** \brief checkpoint the run resumes from */
+static CHECKPOINT resumed;
+
+/** \brief number of checkpoints saved, time of the last one after the start of operations and groups inside then (us) */
+static int nCheckpoints;
+static long long checkpointElapsed;
+static int checkpointInside;
+
+/** \brief time of the arrival clock at the start of operations, time of the last arrival on it (us) and random
+    stream after that arrival, saved in a checkpoint; a resumed run goes on with the clock of the saved one */
+static long long arrivalShift;
+static long long lastArrival;
+static RNG lastRng;
+
 /**
- *  \brief Main program.
+ *  \brief Handler of SIGINT and SIGTERM.
  *
- *  Its role is starting the simulation by generating the intervening entities processes (pilot, hostess and passengers)
- *  and waiting for their termination.
+ *  \param sig signal number
  */
-int main (int argc, char *argv[])
+static void onStop (int sig)
 {
-    char nFic[51];                                                                              /*name of logging file */
-    char nFicErr[] = "error_        ";                                                     /* base name of error files */
-    int shmid,                                                                      /* shared memory access identifier */
-        semgid;                                                                     /* semaphore set access identifier */
-    unsigned int  m;                                                                             /* counting variables */
-    SHARED_DATA *sh;                                                                /* pointer to shared memory region */
-    int pidCH,                                                                             /* pilot process identifier */
-        pidWT,                                                                     /* hostess process identifier array */
-        pidRT,                                                                     /* hostess process identifier array */
-        pidGR[MAXGROUPS];                                                     /* passengers processes identifier array */
-    int key;                                                           /*access key to shared memory and semaphore set */
-    char num[2][12];                                                     /* numeric value conversion (up to 10 digits) */
-    int status,                                                                                    /* execution status */
-        info;                                                                                               /* info id */
-    int g, t;
+    (void) sig;
+    stopRequested = 1;
+}
 
-    /* getting log file name */
-    if(argc==2) {
-        strcpy(nFic, argv[1]);
-    }
-    else strcpy(nFic, "");
+/**
+ *  \brief Handler of SIGUSR1 and SIGALRM.
+ *
+ *  \param sig signal number
+ */
+static void onCheckpoint (int sig)
+{
+    (void) sig;
+    checkpointRequested = 1;
+}
+
+/**
+ *  \brief Handler of the ticks of the watchdog.
+ *
+ *  It only interrupts the wait of the main program for its processes, so the watchdog is checked.
+ *
+ *  \param sig signal number
+ */
+static void onWatchdog (int sig)
+{
+    (void) sig;
+}
+
+/**
+ *  \brief Creation of a group process.
+ *
+ *  \param g group id (slot)
+ *  \param nFic name of the logging file
+ *  \param key access key to shared memory and semaphore set (as a string)
+ *
+ *  \return process identifier of the group
+ */
+static int spawnGroup (int g, char nFic[], char key[])
+{
+    char nFicErr[16];                                                                    /* name of error file */
+    char num[12];                                                        /* numeric value conversion (group id) */
+    int pid;
 
-    /* composing command line */
-    if ((key = ftok (".", 'a')) == -1) {
-        perror ("error on generating the key");
+    if ((pid = fork ()) < 0) {
+        perror ("error on the fork operation for the group");
         exit (EXIT_FAILURE);
     }
-    sprintf (num[1], "%d", key);
+    sprintf(num,"%d",g);
+    sprintf(nFicErr,"error_GR%02d",g);
+    if (pid == 0) {
+        signal (SIGINT, SIG_IGN);                             /* a ^C closes the restaurant, it does not kill groups */
+        placementApply (&placement, PLACE_GROUPS, g);
+        if (execl (GROUP, GROUP, num, nFic, key, nFicErr, NULL) < 0) { 
+            perror ("error on the generation of the group process");
+            exit (EXIT_FAILURE);
+        }
+    }
+    return pid;
+}
+
+/**
+ *  \brief Creation of a process hosting groups as coroutines, or of the template of the fork server.
+ *
+ *  A host is pinned like a group, the template (whose groups are processes of their own) to the CPUs of
+ *  all the groups. Each host leads a process group of its own, which the processes forked by the template
+ *  join, so the watchdog kills them all at once (see watchdogCheck).
+ *
+ *  \param h host id
+ *  \param launch how the group processes are launched (LAUNCH_*)
+ *  \param nFic name of the logging file
+ *  \param key access key to shared memory and semaphore set (as a string)
+ *  \param leftKey access key to the semaphore set of the main program (as a string)
+ *
+ *  \return process identifier of the host
+ */
+static int spawnHost (int h, int launch, char nFic[], char key[], char leftKey[])
+{
+    char num[12];                                                         /* numeric value conversion (host id) */
+    int pid;
 
-    /* creating and initializing the shared memory region and the log file */
-    if ((shmid = shmemCreate (key, sizeof (SHARED_DATA))) == -1) { 
-        perror ("error on creating the shared memory region");
+    if ((pid = fork ()) < 0) {
+        perror ("error on the fork operation for the group host");
         exit (EXIT_FAILURE);
     }
-    if (shmemAttach (shmid, (void **) &sh) == -1) { 
-        perror ("error on mapping the shared region on the process address space");
-        exit (EXIT_FAILURE);
+    sprintf (num, "%d", h);
+    if (pid == 0) {
+        setpgid (0, 0);
+        signal (SIGINT, SIG_IGN);
+        placementApply (&placement, PLACE_GROUPS, (launch == LAUNCH_FORKSERVER) ? -1 : h);
+        if (execl (GROUP, GROUP, "-h", num, nFic, key, leftKey, NULL) < 0) {
+            perror ("error on the generation of the group host process");
+            exit (EXIT_FAILURE);
+        }
     }
+    setpgid (pid, pid);                                   /* also here, so it is set before any kill */
+    return pid;
+}
 
-    /* initialize random generator */
-    srandom ((unsigned int) getpid ());                                
-
-    /* initialize problem internal status */
-    sh->fSt.st.chefStat         = WAIT_FOR_ORDER;                     /* the chef waits for an order */
-    sh->fSt.st.waiterStat       = WAIT_FOR_REQUEST;                /* the waiter waits for a request */
-    sh->fSt.st.receptionistStat = WAIT_FOR_REQUEST;          /* the receptionist waits for a request */
-    for (g = 0; g < MAXGROUPS; g++) {
-        sh->fSt.st.groupStat[g] = GOTOREST;                                /* groups are initialized */
-        sh->fSt.assignedTable[g] = -1;                                     /* groups are initialized */
-    }
-    sh->fSt.groupsWaiting=0;
-
-    FILE *fp = fopen("config.txt","r");
-    if(fp==NULL) {
-        perror("Could not open config file");
-        exit(EXIT_FAILURE);
-    }
-
-    /* parse config file */
-    fscanf(fp,"%*[^\n]");
-    fscanf(fp,"%d ",&sh->fSt.nGroups);
-    fscanf(fp,"%*[^\n]");
-    for(g=0;g < sh->fSt.nGroups;g++) {
-       fscanf(fp,"%d %d", &sh->fSt.startTime[g], &sh->fSt.eatTime[g]);
-    }
-   
-    /* create log file */
-    createLog (nFic, &sh->fSt);                                  
-    saveState(nFic,&sh->fSt);
-
-    /* initialize semaphore ids */
-    sh->mutex                       = MUTEX;                                /* mutual exclusion semaphore id */
-    sh->receptionistReq             = RECEPTIONISTREQ;                                                      
-    sh->receptionistRequestPossible = RECEPTIONISTREQUESTPOSSIBLE;                                                      
-    sh->waiterRequest               = WAITERREQUEST;                                                      
-    sh->waiterRequestPossible       = WAITERREQUESTPOSSIBLE;                                                      
-    sh->waitOrder                   = WAITORDER;                                                      
-    sh->orderReceived               = ORDERRECEIVED;                                                      
-    for(g=0;g<sh->fSt.nGroups;g++) {
-       sh->waitForTable[g]          = WAITFORTABLE+g;                                                      
-    }
-    for(t=0;t<NUMTABLES;t++) {
-       sh->foodArrived[t]           = FOODARRIVED+t;                                                      
-       sh->tableDone[t]             = TABLEDONE+t;                                                      
-       sh->requestReceived[t]       = REQUESTRECEIVED+t;                              
-    }
-
-    /* creating and initializing the semaphore set */
-    if ((semgid = semCreate (key, SEM_NU)) == -1) { 
-        perror ("error on creating the semaphore set");
-        exit (EXIT_FAILURE);
+/**
+ *  \brief Binding the semaphore operations of the main program to a shard.
+ *
+ *  The ups are stamped in the shard, if semaphore timing is on, and notify the hosts of its groups
+ *  waiting on the semaphores upped.
+ *
+ *  \param semgid semaphore set access identifier of the shard
+ *  \param sh pointer to the shared memory region of the shard
+ */
+static void bindShard (int semgid, SHARED_DATA *sh)
+{
+    if (sh->fSt.semTiming) {
+        semTimingStart (&sh->fSt, semgid);
     }
-    if (semUp (semgid, sh->mutex) == -1) {                   /* enabling access to critical region */
-        perror ("error on executing the up operation for semaphore access");
-        exit (EXIT_FAILURE);
+    if (nHosts > 0) {
+        semSetNotify (semgid, sh->fSt.semNotify, SEM_NU + 1, GROUPHOST);
     }
-    if (semUp (semgid, sh->waiterRequestPossible) == -1) {                   /* enabling access to critical region */
-        perror ("error on executing the up operation for semaphore access");
-        exit (EXIT_FAILURE);
+}
+
+/**
+ *  \brief Starting the group of a slot.
+ *
+ *  A group process is created or, if groups are hosted (as coroutines or by the fork server), the slot
+ *  is marked ready and its host is notified. The state of the group must have been set.
+ *
+ *  \param semgid semaphore set access identifier
+ *  \param sh pointer to the shared memory region
+ *  \param pidGR group processes identifier array (0 for free slots)
+ *  \param g group id (slot)
+ *  \param nFic name of the logging file
+ *  \param key access key to shared memory and semaphore set (as a string)
+ *
+ *  \return number of processes created
+ */
+static int startGroup (int semgid, SHARED_DATA *sh, int pidGR[], int g, char nFic[], char key[])
+{
+    sh->fSt.groupSpawn[g] = timeNow ();
+    nInside += 1;
+    insideMax = (nInside > insideMax) ? nInside : insideMax;
+    if (nHosts == 0) {
+        pidGR[g] = spawnGroup (g, nFic, key);
+        return 1;
     }
-    if (semUp (semgid, sh->receptionistRequestPossible) == -1) {                   /* enabling access to critical region */
-        perror ("error on executing the up operation for semaphore access");
+    pidGR[g] = HOSTED;
+    __atomic_store_n (&sh->fSt.slotState[g], SLOT_READY, __ATOMIC_SEQ_CST);
+    if (semUp (semgid, sh->groupHost[g % nHosts]) == -1) {
+        perror ("error on the up operation for semaphore access");
         exit (EXIT_FAILURE);
     }
+    return 0;
+}
 
-    /* generation of intervening entities processes */                            
-    /* group processes */
-    strcpy (nFicErr + 6, "GR");
-    for (g = 0; g < sh->fSt.nGroups; g++) {           
-        if ((pidGR[g] = fork ()) < 0) {
-            perror ("error on the fork operation for the group");
-            exit (EXIT_FAILURE);
+/**
+ *  \brief Finding a free group slot.
+ *
+ *  \param pidGR group processes identifier array (0 for free slots)
+ *  \param nSlots number of group slots
+ *
+ *  \return slot id or -1 if all slots are in use
+ */
+static int freeSlot (int pidGR[], int nSlots)
+{
+    int g;
+
+    for (g = 0; g < nSlots; g++) {
+        if (pidGR[g] == 0) {
+            return g;
         }
-        sprintf(num[0],"%d",g);
-        sprintf(nFicErr+8,"%02d",g); 
-        if (pidGR[g] == 0)
-            if (execl (GROUP, GROUP, num[0], nFic, num[1], nFicErr, NULL) < 0) { 
-                perror ("error on the generation of the group process");
-                exit (EXIT_FAILURE);
-            }
     }
-    /* waiter process */
-    strcpy (nFicErr + 6, "WT");
-    if ((pidWT = fork ()) < 0)  {                            
-        perror ("error on the fork operation for the waiter");
-        exit (EXIT_FAILURE);
+    return -1;
+}
+
+/**
+ *  \brief Counting the group slots in use.
+ *
+ *  \param pidGR group processes identifier array (0 for free slots)
+ *  \param nSlots number of group slots
+ *
+ *  \return number of groups in the restaurant
+ */
+static int busySlots (int pidGR[], int nSlots)
+{
+    int g, n = 0;
+
+    for (g = 0; g < nSlots; g++) {
+        if (pidGR[g] != 0) {
+            n += 1;
+        }
     }
-    if (pidWT == 0) {
-        if (execl (WAITER, WAITER, nFic, num[1], nFicErr, NULL) < 0) {
-            perror ("error on the generation of the waiter process");
-            exit (EXIT_FAILURE);
+    return n;
+}
+
+/**
+ *  \brief Recording the time a group spent in each state.
+ *
+ *  Groups that did not go through all states (a group process that failed) are not recorded.
+ *
+ *  \param stamp time at which the group entered each state (us, indexed by state)
+ */
+static void recordLifecycle (long long stamp[])
+{
+    int st;
+
+    for (st = GOTOREST; st <= LEAVING; st++) {
+        if (stamp[st] == 0) {
+            return;
         }
     }
-    /* chef process */
-    strcpy (nFicErr + 6, "CH");
-    if ((pidCH = fork ()) < 0) {               
-        perror ("error on the fork operation for the chef");
-        exit (EXIT_FAILURE);
+    for (st = GOTOREST; st < LEAVING; st++) {
+        histAdd (&stateWait[st], stamp[st + 1] - stamp[st]);
     }
-    if (pidCH == 0)
-        if (execl (CHEF, CHEF, nFic, num[1], nFicErr, NULL) < 0) { 
-            perror ("error on the generation of the chef process");
-            exit (EXIT_FAILURE);
-        }
+    histAdd (&foodWait, stamp[EAT] - stamp[FOOD_REQUEST]);
+}
 
-    /* receptionist process */
-    strcpy (nFicErr + 6, "RT");
-    if ((pidRT = fork ()) < 0) {               
-        perror ("error on the fork operation for the chef");
-        exit (EXIT_FAILURE);
+/**
+ *  \brief Checking that the run makes progress.
+ *
+ *  The run is stalled if, with groups inside, no state was saved for the time of the watchdog, no
+ *  group is sleeping (going to the restaurant or eating, see wakeTime) and no dish is cooking (see
+ *  KITCHEN): every entity is then blocked for good. The state of each shard is printed, the processes
+ *  are killed and no more groups arrive. A host is killed with its process group, so the group processes
+ *  forked by the template of the fork server are not left behind.
+ *
+ *  \param pidGR group processes identifier arrays of the shards (0 for free slots)
+ *  \param shard pointers to the shared memory regions of the shards
+ */
+static void watchdogCheck (int pidGR[][MAXGROUPS], SHARED_DATA *shard[])
+{
+    unsigned long progress = 0;
+    long long now;
+    int s, g, inside = 0, sleeping = 0;
+
+    if ((shard[0]->fSt.watchdog == 0) || stalled) {
+        return;
     }
-    if (pidRT == 0)
-        if (execl (RECEPTIONIST, RECEPTIONIST, nFic, num[1], nFicErr, NULL) < 0) { 
-            perror ("error on the generation of the receptionist process");
-            exit (EXIT_FAILURE);
+    now = timeNow ();
+    for (s = 0; s < nShards; s++) {
+        progress += __atomic_load_n (&shard[s]->fSt.progress, __ATOMIC_RELAXED);
+        sleeping += (__atomic_load_n (&shard[s]->fSt.kitchen.nextDone, __ATOMIC_RELAXED) > now);
+        for (g = 0; g < shard[s]->fSt.nGroups; g++) {
+            if (pidGR[s][g] != 0) {
+                inside += 1;
+                sleeping += (__atomic_load_n (&shard[s]->fSt.wakeTime[g], __ATOMIC_RELAXED) > now);
+            }
         }
+    }
+    if ((progress != lastProgress) || (inside == 0) || (sleeping > 0)) {
+        lastProgress = progress;
+        progressSince = now;
+        return;
+    }
+    if (now - progressSince < 1000LL * shard[0]->fSt.watchdog) {
+        return;
+    }
 
-    /* signaling start of operations */
-    if (semSignal (semgid) == -1) {
-        perror ("error on signaling start of operations");
+    stalled = true;
+    stopRequested = 1;
+    fprintf (stderr, "\nRun stalled: no change of state for %d ms with %d groups inside, its processes are killed\n",
+             shard[0]->fSt.watchdog, inside);
+    for (s = 0; s < nShards; s++) {
+        fprintf (stderr, "shard %d: chef %d, waiter %d, receptionist %d, groups (slot:state)", s,
+                 shard[s]->fSt.st.chefStat, shard[s]->fSt.st.waiterStat, shard[s]->fSt.st.receptionistStat);
+        for (g = 0; g < shard[s]->fSt.nGroups; g++) {
+            if (pidGR[s][g] != 0) {
+                fprintf (stderr, " %d:%d", g, shard[s]->fSt.st.groupStat[g]);
+            }
+        }
+        fprintf (stderr, "\n");
+        kill (pidCH[s], SIGKILL);
+        kill (pidWT[s], SIGKILL);
+        kill (pidRT[s], SIGKILL);
+        for (g = 0; g < nHosts; g++) {
+            kill (-pidHS[s][g], SIGKILL);
+        }
+        for (g = 0; g < shard[s]->fSt.nGroups; g++) {
+            if (pidGR[s][g] > 0) {
+                kill (pidGR[s][g], SIGKILL);
+            }
+        }
+    }
+}
+
+/**
+ *  \brief Recording the exit status of an intervening entity process.
+ *
+ *  \param kind kind of entity (SRV_* or ENT_GROUPS)
+ *  \param status wait status of the process
+ */
+static void recordExit (int kind, int status)
+{
+    if (WIFEXITED (status) && (WEXITSTATUS (status) == EXIT_SUCCESS)) {
+        return;
+    }
+    if (nFailed[kind]++ == 0) {
+        failStatus[kind] = status;
+    }
+}
+
+/**
+ *  \brief Waiting for the termination of an intervening entity process.
+ *
+ *  If the process is a group, the time it spent in each state is recorded and its slot becomes free.
+ *  The CPU time and the exit status of the process are added to those of its entity; a template of
+ *  the fork server that failed because group processes it forked did stands for them, with the
+ *  status of the first one. The watchdog is checked first, and again if the wait is interrupted by
+ *  one of its ticks.
+ *
+ *  \param pidGR group processes identifier arrays of the shards (0 for free slots)
+ *  \param shard pointers to the shared memory regions of the shards
+ *  \param options options of waitpid (WNOHANG to return if no process has terminated)
+ *
+ *  \return process identifier of the terminated process or 0 (also if interrupted by a signal, or with
+ *          WNOHANG if none is left)
+ */
+static int reapChild (int pidGR[][MAXGROUPS], SHARED_DATA *shard[], int options)
+{
+    int pid, status, g, s, k;
+    struct rusage ru;
+    long long cpu;
+    bool ok;
+
+    watchdogCheck (pidGR, shard);
+    pid = wait4 (-1, &status, options, &ru);
+    if ((pid == -1) && (errno == EINTR)) {
+        watchdogCheck (pidGR, shard);
+        return 0;
+    }
+    if ((pid == -1) && (errno == ECHILD) && (options & WNOHANG)) {
+        return 0;                                                  /* all reaped, after the watchdog killed them */
+    }
+    if (pid == -1) { 
+        perror ("error on waiting for an intervening process");
         exit (EXIT_FAILURE);
     }
+    if (pid <= 0) {
+        return 0;
+    }
+    cpu = 1000000LL * (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) + ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+    for (s = 0; s < nShards; s++) {
+        for (g = 0; g < nHosts; g++) {
+            if (pid == pidHS[s][g]) {
+                cpuGR += cpu;
+                if ((shard[s]->fSt.workersFailed > 0) && WIFEXITED (status) && (WEXITSTATUS (status) == EXIT_FAILURE)) {
+                    for (k = 0; k < shard[s]->fSt.workersFailed; k++) {      /* the group processes of the template */
+                        recordExit (ENT_GROUPS, shard[s]->fSt.workerStatus);
+                    }
+                }
+                else recordExit (ENT_GROUPS, status);
+                return pid;
+            }
+        }
+        if (pid == pidCH[s]) {
+            cpuCH += cpu;
+            recordExit (SRV_CHEF, status);
+            return pid;
+        }
+        if (pid == pidWT[s]) {
+            cpuWT += cpu;
+            recordExit (SRV_WAITER, status);
+            return pid;
+        }
+        if (pid == pidRT[s]) {
+            cpuRT += cpu;
+            recordExit (SRV_RECEPTIONIST, status);
+            return pid;
+        }
+    }
+    cpuGR += cpu;
+    recordExit (ENT_GROUPS, status);
+    ok = WIFEXITED (status) && (WEXITSTATUS (status) == EXIT_SUCCESS);             /* killed groups were not served */
+    for (s = 0; s < nShards; s++) {
+        for (g = 0; g < shard[s]->fSt.nGroups; g++) {
+            if (pidGR[s][g] == pid) {
+                recordLifecycle (shard[s]->fSt.stateTime[g]);
+                ok = ok && !shard[s]->fSt.rejected[g];                          /* nor were those turned away */
+                served[s] += ok;
+                pidGR[s][g] = 0;
+                nInside -= 1;
+            }
+        }
+    }
+    nServed += ok;
+    return pid;
+}
 
-    /* waiting for the termination of the intervening entities processes */
-    m = 0;
-    do {
-        info = wait (&status);
-        if (info == -1) { 
-            perror ("error on aiting for an intervening process");
-            exit (EXIT_FAILURE);
+/**
+ *  \brief Freeing the slots of the hosted groups that left.
+ *
+ *  The time each group spent in each state is recorded. Groups turned away, or whose process forked
+ *  by the fork server failed, are not counted as served.
+ *
+ *  \param pidGR group processes identifier arrays of the shards (0 for free slots)
+ *  \param shard pointers to the shared memory regions of the shards
+ *
+ *  \return number of slots freed
+ */
+static int reapHosted (int pidGR[][MAXGROUPS], SHARED_DATA *shard[])
+{
+    int s, g, n = 0;
+    bool ok;
+
+    for (s = 0; s < nShards; s++) {
+        for (g = 0; g < shard[s]->fSt.nGroups; g++) {
+            if ((pidGR[s][g] == HOSTED) && (__atomic_load_n (&shard[s]->fSt.slotState[g], __ATOMIC_SEQ_CST) == SLOT_DONE)) {
+                recordLifecycle (shard[s]->fSt.stateTime[g]);
+                ok = !shard[s]->fSt.rejected[g] && !shard[s]->fSt.failed[g];
+                nServed += ok;
+                served[s] += ok;
+                shard[s]->fSt.slotState[g] = SLOT_FREE;
+                pidGR[s][g] = 0;
+                nInside -= 1;
+                n += 1;
+            }
         }
-        m += 1;
-    } while (m < 3+sh->fSt.nGroups);
+    }
+    return n;
+}
 
-    /* destruction of semaphore set and shared region */
-    if (semDestroy (semgid) == -1) {
-        perror ("error on destructing the semaphore set");
-        exit (EXIT_FAILURE);
+/**
+ *  \brief Waiting for a group to leave.
+ *
+ *  With a process per group, for the termination of an intervening entity process (see reapChild).
+ *  With hosted groups, until a host reports a group leaving or LEFTWAIT expires; the processes that
+ *  terminated meanwhile are reaped.
+ *
+ *  \param pidGR group processes identifier arrays of the shards (0 for free slots)
+ *  \param shard pointers to the shared memory regions of the shards
+ *
+ *  \return number of processes reaped
+ */
+static int waitGroup (int pidGR[][MAXGROUPS], SHARED_DATA *shard[])
+{
+    int n = 0;
+
+    if (nHosts == 0) {
+        return reapChild (pidGR, shard, 0) > 0;
     }
-    if (shmemDettach (sh) == -1) { 
-        perror ("error on unmapping the shared region off the process address space");
-        exit (EXIT_FAILURE);
+    if ((reapHosted (pidGR, shard) == 0) && (semTimedDown (leftgid, 1, LEFTWAIT) == 0)) {
+        reapHosted (pidGR, shard);
     }
-    if (shmemDestroy (shmid) == -1) { 
-        perror ("error on destructing the shared region");
-        exit (EXIT_FAILURE);
+    while (reapChild (pidGR, shard, WNOHANG) > 0) {
+        n += 1;
+    }
+    return n;
+}
+
+/**
+ *  \brief Load of a shard, as seen by the dispatcher.
+ *
+ *  The number of groups waiting for a table, then the number of groups inside, to break ties. The
+ *  count is read without the mutex of the shard: a stale value only makes for a worse choice.
+ *
+ *  \param sh pointer to the shared memory region of the shard
+ *  \param pidGR group processes identifier array of the shard (0 for free slots)
+ *
+ *  \return load of the shard (lower is better)
+ */
+static long shardLoad (SHARED_DATA *sh, int pidGR[])
+{
+    return (long) __atomic_load_n (&sh->fSt.groupsWaiting, __ATOMIC_RELAXED) * (MAXGROUPS + 1) +
+           busySlots (pidGR, sh->fSt.nGroups);
+}
+
+/**
+ *  \brief Choosing the shard of an arriving group.
+ *
+ *  Only shards with a free group slot are candidates. DISPATCH_LEAST takes the least loaded of them
+ *  (the lowest id on ties), DISPATCH_P2C the less loaded of two of them drawn at random, which needs
+ *  no global view of the load.
+ *
+ *  \param shard pointers to the shared memory regions of the shards
+ *  \param pidGR group processes identifier arrays of the shards (0 for free slots)
+ *  \param dispatch dispatching policy (DISPATCH_*)
+ *
+ *  \return shard id or -1 if all slots of all shards are in use
+ */
+static int dispatchGroup (SHARED_DATA *shard[], int pidGR[][MAXGROUPS], int dispatch)
+{
+    int cand[MAXSHARDS], n = 0, s, a, b, best;
+
+    for (s = 0; s < nShards; s++) {
+        if (freeSlot (pidGR[s], shard[s]->fSt.nGroups) != -1) {
+            cand[n++] = s;
+        }
+    }
+    if (n == 0) {
+        return -1;
+    }
+    if ((dispatch == DISPATCH_P2C) && (n > 2)) {
+        a = (int) rngBelow (&rng, n);
+        b = (int) rngBelow (&rng, n - 1);
+        b += (b >= a);                                                          /* two distinct candidates */
+        a = cand[a];
+        cand[1] = cand[b];
+        cand[0] = a;
+        n = 2;
+    }
+    for (best = cand[0], s = 1; s < n; s++) {
+        if (shardLoad (shard[cand[s]], pidGR[cand[s]]) < shardLoad (shard[best], pidGR[best])) {
+            best = cand[s];
+        }
+    }
+    return best;
+}
+
+/**
+ *  \brief Closing the restaurant.
+ *
+ *  Sets the closing flag and sends the closing request (poison pill) to the receptionist and to the
+ *  waiter, who passes it on to the chef; event-driven servers get it on their closing channels. It must
+ *  only be called when there are no groups left in the restaurant, so the servers have no outstanding
+ *  work. The hosts of the groups are woken up, so they see the restaurant is closing.
+ *
+ *  \param semgid semaphore set access identifier
+ *  \param sh pointer to shared memory region
+ */
+static void closeRestaurant (int semgid, SHARED_DATA *sh)
+{
+    int h;
+
+    if (sh->fSt.eventLoop) {                                      /* event-driven servers: closing channels */
+        if (semDown (semgid, sh->mutex) == -1) {                                         /* enter critical region */
+            perror ("error on the down operation for semaphore access");
+            exit (EXIT_FAILURE);
+        }
+        sh->fSt.closing = true;
+        if (semUp (semgid, sh->mutex) == -1) {                                            /* exit critical region */
+            perror ("error on the up operation for semaphore access");
+            exit (EXIT_FAILURE);
+        }
+        if ((eventPost (sh->fSt.eventFd[EV_CLOSERECEPT]) == -1) || (eventPost (sh->fSt.eventFd[EV_CLOSEWAITER]) == -1)) {
+            perror ("error on posting the closing event");
+            exit (EXIT_FAILURE);
+        }
+    }
+    else {
+        if (semDown (semgid, sh->receptionistRequestPossible) == -1) {
+            perror ("error on the down operation for semaphore access");
+            exit (EXIT_FAILURE);
+        }
+        if (semDown (semgid, sh->mutex) == -1) {                                             /* enter critical region */
+            perror ("error on the down operation for semaphore access");
+            exit (EXIT_FAILURE);
+        }
+        sh->fSt.closing = true;
+        sh->fSt.receptionistRequest.reqType = CLOSEREQ;
+        sh->fSt.receptionistRequest.reqGroup = -1;
+        if (semUp (semgid, sh->receptionistReq) == -1) {
+            perror ("error on the up operation for semaphore access");
+            exit (EXIT_FAILURE);
+        }
+        if (semUp (semgid, sh->mutex) == -1) {                                                /* exit critical region */
+            perror ("error on the up operation for semaphore access");
+            exit (EXIT_FAILURE);
+        }
+
+        if (semDown (semgid, sh->waiterRequestPossible) == -1) {
+            perror ("error on the down operation for semaphore access");
+            exit (EXIT_FAILURE);
+        }
+        if (semDown (semgid, sh->mutex) == -1) {                                             /* enter critical region */
+            perror ("error on the down operation for semaphore access");
+            exit (EXIT_FAILURE);
+        }
+        sh->fSt.waiterRequest.reqType = CLOSEREQ;
+        sh->fSt.waiterRequest.reqGroup = -1;
+        if (semUp (semgid, sh->waiterRequest) == -1) {
+            perror ("error on the up operation for semaphore access");
+            exit (EXIT_FAILURE);
+        }
+        if (semUp (semgid, sh->mutex) == -1) {                                                /* exit critical region */
+            perror ("error on the up operation for semaphore access");
+            exit (EXIT_FAILURE);
+        }
+    }
+    for (h = 0; h < sh->fSt.groupHosts; h++) {
+        if (semUp (semgid, sh->groupHost[h]) == -1) {
+            perror ("error on the up operation for semaphore access");
+            exit (EXIT_FAILURE);
+        }
+    }
+}
+
+/**
+ *  \brief Saving the state of the run, if requested.
+ *
+ *  The mutexes of all shards are taken, so no entity changes the state meanwhile, and the state is
+ *  saved if every shard is quiescent (see checkpointQuiet); otherwise the mutexes are released and the
+ *  state is looked at again, for up to CKPTWAIT ms. With <tt>STOP</tt>, the restaurant is then closed.
+ *
+ *  \param shard pointers to the shared memory regions of the shards
+ *  \param semid semaphore set access identifiers of the shards
+ *  \param pidGR group processes identifier arrays of the shards (0 for free slots)
+ *  \param arrived number of groups that arrived so far
+ */
+static void pollCheckpoint (SHARED_DATA *shard[], int semid[], int pidGR[][MAXGROUPS], int arrived)
+{
+    static CHECKPOINT ck;
+    SHARED_DATA *sh;
+    long long deadline = timeNow () + 1000LL * CKPTWAIT;
+    bool quiet;
+    int s, g;
+
+    if (!checkpointRequested) {
+        return;
+    }
+    checkpointRequested = 0;
+    do {
+        for (s = 0; s < nShards; s++) {
+            if (semDown (semid[s], shard[s]->mutex) == -1) {                              /* enter critical region */
+                perror ("error on the down operation for semaphore access");
+                exit (EXIT_FAILURE);
+            }
+        }
+        for (quiet = true, s = 0; quiet && (s < nShards); s++) {
+            sh = shard[s];
+            for (g = 0; g < sh->fSt.nGroups; g++) {
+                ck.shard[s].inside[g] = (pidGR[s][g] != 0) && (sh->fSt.st.groupStat[g] != LEAVING);
+            }
+            if (semGetAll (semid[s], ck.shard[s].sem) == -1) {
+                perror ("error on reading the semaphore set");
+                exit (EXIT_FAILURE);
+            }
+            if ((quiet = checkpointQuiet (sh, ck.shard[s].sem, ck.shard[s].inside))) {
+                ck.shard[s].shared = *sh;
+                ck.shard[s].nSems = SEM_NU + 1;
+            }
+        }
+        ck.taken = timeNow ();
+        for (s = 0; s < nShards; s++) {
+            if (semUp (semid[s], shard[s]->mutex) == -1) {                                 /* exit critical region */
+                perror ("error on the up operation for semaphore access");
+                exit (EXIT_FAILURE);
+            }
+        }
+        if (!quiet) {
+            usleep (CKPTPOLL);
+        }
+    } while (!quiet && (timeNow () < deadline));
+
+    if (quiet) {
+        ck.nShards = nShards;
+        ck.arrived = arrived;
+        ck.elapsed = ck.taken - shard[0]->fSt.startRun;
+        ck.clock = arrivalShift + ck.elapsed;
+        ck.arrival = lastArrival;
+        ck.rng = lastRng;
+        checkpointSave (shard[0]->fSt.checkpointFile, &ck);
+        nCheckpoints += 1;
+        checkpointElapsed = ck.elapsed;
+        for (checkpointInside = 0, s = 0; s < nShards; s++) {
+            for (g = 0; g < shard[s]->fSt.nGroups; g++) {
+                checkpointInside += ck.shard[s].inside[g];
+            }
+        }
+    }
+    else fprintf (stderr, "no quiescent point found in %d ms, the state of the run was not saved\n", CKPTWAIT);
+    if (shard[0]->fSt.checkpointStop) {
+        stopRequested = 1;
+    }
+}
+
+/**
+ *  \brief Printing the statistics of the run.
+ *
+ *  Reports the scheduling policy, the mean and 99th percentile of the time groups waited for a
+ *  table (from arrival at the restaurant), the fraction of time tables were occupied and the
+ *  fraction of time seats were occupied, the percentiles of the time groups spent in each state
+ *  and the CPU time of the entities. With several shards, the state is that of all shards merged
+ *  (see mergeShards).
+ *
+ *  \param p_fSt pointer to the location where the full internal state of the problem is stored
+ */
+static void printStats (FULL_STAT *p_fSt)
+{
+    long long busy = 0;
+    double duration = (double) (p_fSt->endRun - p_fSt->startRun);
+    int t, st, seats = 0;
+
+    for (t = 0; t < p_fSt->nTables; t++) {
+        busy += p_fSt->tableBusy[t];
+        seats += p_fSt->tableCapacity[t];
+    }
+    printf ("\nPolicy %s: %lu groups seated, mean wait %.1f ms, p99 wait %.1f ms, table utilization %.1f %%,"
+            " seat utilization %.1f %%\n",
+            policyName (p_fSt->policy), p_fSt->tableWait.count, histMean (&p_fSt->tableWait) / 1000.0,
+            histPercentile (&p_fSt->tableWait, 99.0) / 1000.0,
+            100.0 * busy / (p_fSt->nTables * nShards * duration), 100.0 * p_fSt->seatBusy / (seats * nShards * duration));
+    printf ("%-12s %9s %9s %9s %9s   (ms, %lu groups)\n", "state", "p50", "p90", "p99", "max", stateWait[GOTOREST].count);
+    for (st = GOTOREST; st < LEAVING; st++) {
+        printf ("%-12s %9.1f %9.1f %9.1f %9.1f\n", stateNames[st], histPercentile (&stateWait[st], 50.0) / 1000.0,
+                histPercentile (&stateWait[st], 90.0) / 1000.0, histPercentile (&stateWait[st], 99.0) / 1000.0,
+                stateWait[st].max / 1000.0);
+    }
+    printf ("CPU time: chef %.1f ms, waiter %.1f ms, receptionist %.1f ms, groups %.1f ms (%d groups, %.1f groups/s)\n",
+            cpuCH / 1000.0, cpuWT / 1000.0, cpuRT / 1000.0, cpuGR / 1000.0, nServed, 1e6 * nServed / duration);
+    printf ("Groups inside at once: %d at most (per shard: %d slots, %d hosts, %d semaphores)\n", insideMax,
+            p_fSt->nGroups, p_fSt->groupHosts, SEMS (p_fSt));
+    printf ("Wakeup latency (us, p50/p99): chef %lld/%lld, waiter %lld/%lld, receptionist %lld/%lld (scheduling %s%s)\n",
+            histPercentile (&p_fSt->wakeup[SRV_CHEF], 50.0), histPercentile (&p_fSt->wakeup[SRV_CHEF], 99.0),
+            histPercentile (&p_fSt->wakeup[SRV_WAITER], 50.0), histPercentile (&p_fSt->wakeup[SRV_WAITER], 99.0),
+            histPercentile (&p_fSt->wakeup[SRV_RECEPTIONIST], 50.0), histPercentile (&p_fSt->wakeup[SRV_RECEPTIONIST], 99.0),
+            realtimeName (p_fSt->realtime), p_fSt->realtimeDenied ? ", not permitted" : "");
+    printf ("Startup latency (us, p50/p99): groups %lld/%lld, chef %lld, waiter %lld, receptionist %lld (launch %s)\n",
+            histPercentile (&p_fSt->startup[ENT_GROUPS], 50.0), histPercentile (&p_fSt->startup[ENT_GROUPS], 99.0),
+            p_fSt->startup[SRV_CHEF].max, p_fSt->startup[SRV_WAITER].max, p_fSt->startup[SRV_RECEPTIONIST].max,
+            launchName (p_fSt->launch));
+    printf ("Time to first request (ms, p50/p99): %.1f/%.1f\n", histPercentile (&p_fSt->firstRequest, 50.0) / 1000.0,
+            histPercentile (&p_fSt->firstRequest, 99.0) / 1000.0);
+    if (p_fSt->eventLoop) {
+        printf ("Event loops: waiter %.2f, receptionist %.2f requests per wakeup\n",
+                histMean (&p_fSt->batch[SRV_WAITER]), histMean (&p_fSt->batch[SRV_RECEPTIONIST]));
+    }
+    if (strlen (p_fSt->placement) > 0) {
+        printf ("Placement: %s\n", p_fSt->placement);
+    }
+}
+
+/**
+ *  \brief Merging the statistics of the shards.
+ *
+ *  The histograms are merged, the occupation times of the tables, seats and kitchen stations summed
+ *  (table t of every shard adds to tableBusy[t]), and so are the counts of the admission of groups and
+ *  the number of groups waiting over time; the rest is that of shard 0.
+ *
+ *  \param shard pointers to the shared memory regions of the shards
+ *  \param p_fSt pointer to the location where the merged state is stored
+ */
+static void mergeShards (SHARED_DATA *shard[], FULL_STAT *p_fSt)
+{
+    FULL_STAT *f;
+    int s, t;
+
+    *p_fSt = shard[0]->fSt;
+    for (s = 1; s < nShards; s++) {
+        f = &shard[s]->fSt;
+        histMerge (&p_fSt->tableWait, &f->tableWait);
+        for (t = 0; t < NSERVERS; t++) {
+            histMerge (&p_fSt->wakeup[t], &f->wakeup[t]);
+            histMerge (&p_fSt->batch[t], &f->batch[t]);
+        }
+        for (t = 0; t <= ENT_GROUPS; t++) {
+            histMerge (&p_fSt->startup[t], &f->startup[t]);
+        }
+        histMerge (&p_fSt->firstRequest, &f->firstRequest);
+        for (t = 0; t < SEMKINDS; t++) {
+            histMerge (&p_fSt->semWakeup[t], &f->semWakeup[t]);
+        }
+        for (t = 0; t < p_fSt->nTables; t++) {
+            p_fSt->tableBusy[t] += f->tableBusy[t];
+        }
+        p_fSt->seatBusy += f->seatBusy;
+        for (t = 0; t < p_fSt->kitchen.nStations; t++) {
+            p_fSt->kitchen.stationBusy[t] += f->kitchen.stationBusy[t];
+            p_fSt->kitchen.stationDishes[t] += f->kitchen.stationDishes[t];
+            histMerge (&p_fSt->kitchen.stationWait[t], &f->kitchen.stationWait[t]);
+            if (f->kitchen.stationQueueMax[t] > p_fSt->kitchen.stationQueueMax[t]) {
+                p_fSt->kitchen.stationQueueMax[t] = f->kitchen.stationQueueMax[t];
+            }
+        }
+        histMerge (&p_fSt->kitchen.orderTime, &f->kitchen.orderTime);
+        p_fSt->admission.admitted += f->admission.admitted;
+        p_fSt->admission.rejectedFull += f->admission.rejectedFull;
+        p_fSt->admission.rejectedWait += f->admission.rejectedWait;
+        p_fSt->admission.depthArea += f->admission.depthArea;
+        timelineMerge (&p_fSt->admission.depth, &f->admission.depth);
+    }
+}
+
+/**
+ *  \brief Utilization of a station type of the kitchen.
+ *
+ *  \param p_fSt pointer to the location where the full internal state of the problem is stored
+ *  \param st station type
+ *
+ *  \return fraction of the time its units, in all shards, were cooking (%)
+ */
+static double stationUtil (FULL_STAT *p_fSt, int st)
+{
+    double duration = (double) (p_fSt->endRun - p_fSt->startRun);
+
+    if (duration <= 0.0) {
+        return 0.0;
+    }
+    return 100.0 * p_fSt->kitchen.stationBusy[st] / (p_fSt->kitchen.stationCapacity[st] * nShards * duration);
+}
+
+/**
+ *  \brief Bottleneck of the kitchen.
+ *
+ *  \param p_fSt pointer to the location where the full internal state of the problem is stored
+ *
+ *  \return station type with the highest utilization (-1 if there are no stations)
+ */
+static int bottleneck (FULL_STAT *p_fSt)
+{
+    int st, most = -1;
+
+    for (st = 0; st < p_fSt->kitchen.nStations; st++) {
+        if ((most == -1) || (stationUtil (p_fSt, st) > stationUtil (p_fSt, most))) {
+            most = st;
+        }
+    }
+    return most;
+}
+
+/**
+ *  \brief Printing the load of the kitchen stations.
+ *
+ *  Only with stations: for each station type, its capacity, the dishes cooked, its utilization and the
+ *  time dishes waited for it, the longest queue, and the time orders took from being taken until their
+ *  last dish was done.
+ *
+ *  \param p_fSt pointer to the location where the full internal state of the problem is stored
+ */
+static void printKitchen (FULL_STAT *p_fSt)
+{
+    KITCHEN *k = &p_fSt->kitchen;
+    int st;
+
+    if (k->nStations == 0) {
+        return;
+    }
+    printf ("Kitchen: %lu orders, p50/p99 %.1f/%.1f ms from taken until done, bottleneck %s\n", k->orderTime.count,
+            histPercentile (&k->orderTime, 50.0) / 1000.0, histPercentile (&k->orderTime, 99.0) / 1000.0,
+            k->stationName[bottleneck (p_fSt)]);
+    printf ("%-12s %9s %9s %9s %9s %9s %9s   (wait in ms)\n", "station", "capacity", "dishes", "util %", "p50 wait", "p99 wait",
+            "max queue");
+    for (st = 0; st < k->nStations; st++) {
+        printf ("%-12s %9d %9lu %9.1f %9.1f %9.1f %9d\n", k->stationName[st], k->stationCapacity[st], k->stationDishes[st],
+                stationUtil (p_fSt, st), histPercentile (&k->stationWait[st], 50.0) / 1000.0,
+                histPercentile (&k->stationWait[st], 99.0) / 1000.0, k->stationQueueMax[st]);
+    }
+}
+
+/**
+ *  \brief Imbalance of the shards.
+ *
+ *  \return how much more groups the busiest shard served than the mean (%)
+ */
+static double shardImbalance (void)
+{
+    int s, most = 0;
+
+    if (nServed == 0) {
+        return 0.0;
+    }
+    for (s = 0; s < nShards; s++) {
+        if (served[s] > most) {
+            most = served[s];
+        }
+    }
+    return 100.0 * ((double) most * nShards / nServed - 1.0);
+}
+
+/**
+ *  \brief Printing the load of each shard.
+ *
+ *  Only with several shards: the groups served and the mean and 99th percentile of the time groups
+ *  waited for a table in each shard, and the imbalance of the shards.
+ *
+ *  \param shard pointers to the shared memory regions of the shards
+ */
+static void printShards (SHARED_DATA *shard[])
+{
+    int s;
+
+    if (nShards == 1) {
+        return;
+    }
+    printf ("Shards: %d (dispatch %s), imbalance %.1f %% (busiest over mean)\n", nShards,
+            dispatchName (shard[0]->fSt.dispatch), shardImbalance ());
+    printf ("%-12s %9s %9s %9s   (ms)\n", "shard", "groups", "mean wait", "p99 wait");
+    for (s = 0; s < nShards; s++) {
+        printf ("%-12d %9d %9.1f %9.1f\n", s, served[s], histMean (&shard[s]->fSt.tableWait) / 1000.0,
+                histPercentile (&shard[s]->fSt.tableWait, 99.0) / 1000.0);
+    }
+}
+
+/**
+ *  \brief Largest number of groups waiting for a table.
+ *
+ *  \param p_fSt pointer to the location where the full internal state of the problem is stored
+ *
+ *  \return largest value of the timeline of the waiting room (of the sum of the shards)
+ */
+static int waitingMax (FULL_STAT *p_fSt)
+{
+    TIMELINE *tl = &p_fSt->admission.depth;
+    int k, most = tl->last;
+
+    for (k = 0; k < tl->n; k++) {
+        if (tl->max[k] > most) {
+            most = tl->max[k];
+        }
+    }
+    return most;
+}
+
+/**
+ *  \brief Printing the admission of the groups and the waiting room.
+ *
+ *  The groups admitted (seated at once or waiting) and turned away, by reason, the mean and largest
+ *  number of groups waiting for a table, and the largest number in each slot of time of the run.
+ *
+ *  \param p_fSt pointer to the location where the full internal state of the problem is stored
+ */
+static void printAdmission (FULL_STAT *p_fSt)
+{
+    ADMISSION *a = &p_fSt->admission;
+    double duration = (double) (p_fSt->endRun - p_fSt->startRun);
+    char adm[64];
+    int k;
+
+    admissionName (p_fSt, adm, sizeof (adm));
+    printf ("Waiting room (admission %s): %lu groups admitted, %lu turned away (%lu full, %lu wait too long),"
+            " %.2f waiting on average, %d at most\n", adm, a->admitted, a->rejectedFull + a->rejectedWait, a->rejectedFull,
+            a->rejectedWait, (duration > 0.0) ? a->depthArea / duration : 0.0, waitingMax (p_fSt));
+    printf ("Groups waiting over time (most per %lld ms):", a->depth.slot / 1000);
+    for (k = 0; k < a->depth.n; k++) {
+        printf (" %d", a->depth.max[k]);
+    }
+    printf ("\n");
+}
+
+/**
+ *  \brief Printing the wakeup latency of the semaphores.
+ *
+ *  Only with semaphore timing on. The semaphores of the groups and of the hosts are measured by kind;
+ *  kinds no process blocked on are left out. Times are in us.
+ *
+ *  \param p_fSt pointer to the location where the full internal state of the problem is stored
+ */
+static void printSemTiming (FULL_STAT *p_fSt)
+{
+    static const char *names[SEMKINDS] = { "", "mutex", "receptionistReq", "receptionistRequestPossible",
+                                           "waiterRequest", "waiterRequestPossible", "waitOrder", "orderReceived",
+                                           "waitForTable[]", "foodArrived[]", "requestReceived[]", "tableDone[]",
+                                           "groupHost[]" };
+    HISTOGRAM *h;
+    int k;
+
+    if (!p_fSt->semTiming) {
+        return;
+    }
+    printf ("%-28s %9s %9s %9s %9s   (semaphore wakeup latency, us)\n", "semaphore", "count", "p50", "p99", "max");
+    for (k = MUTEX; k < SEMKINDS; k++) {
+        h = &p_fSt->semWakeup[k];
+        if (h->count > 0) {
+            printf ("%-28s %9lu %9.1f %9.1f %9.1f\n", names[k], h->count, histPercentile (h, 50.0) / 1000.0,
+                    histPercentile (h, 99.0) / 1000.0, h->max / 1000.0);
+        }
+    }
+}
+
+/**
+ *  \brief Appending the results of the run to a CSV file.
+ *
+ *  A header line is written first if the file is empty. Times are in ms, except the duration (s).
+ *  The placement is quoted, CPU lists may hold commas. Tables and seats are those of one shard.
+ *
+ *  \param nCsv name of the CSV file
+ *  \param nFic name of the logging file
+ *  \param p_fSt pointer to the location where the full internal state of the problem is stored
+ */
+static void writeCsv (char nCsv[], char nFic[], FULL_STAT *p_fSt)
+{
+    FILE *fp;
+    double duration = (p_fSt->endRun - p_fSt->startRun) / 1e6, meal = 0.0;
+    int t, g, seats = 0;
+    HISTOGRAM *phase[3] = { &p_fSt->tableWait, &foodWait, &stateWait[CHECKOUT] };
+
+    for (t = 0; t < p_fSt->nTables; t++) {
+        seats += p_fSt->tableCapacity[t];
+    }
+    if (p_fSt->gen.arrivals == ARRIVALS_CONFIG) {                                          /* mean meal time */
+        for (g = 0; g < p_fSt->nGroups; g++) {
+            meal += p_fSt->eatTime[g] / (double) p_fSt->nGroups;
+        }
+    }
+    else meal = (p_fSt->gen.meal == MEAL_UNIFORM) ? (p_fSt->gen.mealA + p_fSt->gen.mealB) / 2.0 : p_fSt->gen.mealA;
+
+    if ((fp = fopen (nCsv, "a")) == NULL) {
+        perror ("error on opening the CSV file");
+        exit (EXIT_FAILURE);
+    }
+    fseek (fp, 0, SEEK_END);
+    if (ftell (fp) == 0) {
+        fprintf (fp, "backend,log,policy,arrivals,groups,slots,tables,seats,share,join,meal_ms,duration_s,groups_per_s,"
+                     "reception_p50_ms,reception_p90_ms,reception_p99_ms,food_p50_ms,food_p90_ms,food_p99_ms,"
+                     "checkout_p50_ms,checkout_p90_ms,checkout_p99_ms,cpu_chef_ms,cpu_waiter_ms,cpu_receptionist_ms,"
+                     "cpu_groups_ms,placement,realtime,wakeup_chef_p50_us,wakeup_chef_p99_us,wakeup_waiter_p50_us,"
+                     "wakeup_waiter_p99_us,wakeup_receptionist_p50_us,wakeup_receptionist_p99_us,shards,dispatch,"
+                     "imbalance_pct,group_hosts,events,batch_waiter,batch_receptionist,launch,startup_p50_us,startup_p99_us,"
+                     "first_request_p50_ms,first_request_p99_ms\n");
+    }
+    fprintf (fp, "%s,%s,%s,%s,%d,%d,%d,%d,%d,%d,%.1f,%.3f,%.2f", SEMBACKEND, (strlen (nFic) > 0) ? nFic : "stdout",
+             policyName (p_fSt->policy), arrivalName (p_fSt->gen.arrivals), nServed, p_fSt->nGroups, p_fSt->nTables,
+             seats, p_fSt->tableShare, p_fSt->tableJoin, meal / 1000.0, duration, nServed / duration);
+    for (t = 0; t < 3; t++) {
+        fprintf (fp, ",%.3f,%.3f,%.3f", histPercentile (phase[t], 50.0) / 1000.0, histPercentile (phase[t], 90.0) / 1000.0,
+                 histPercentile (phase[t], 99.0) / 1000.0);
+    }
+    fprintf (fp, ",%.1f,%.1f,%.1f,%.1f,\"%s\",%s", cpuCH / 1000.0, cpuWT / 1000.0, cpuRT / 1000.0, cpuGR / 1000.0,
+             (strlen (p_fSt->placement) > 0) ? p_fSt->placement : "NONE",
+             p_fSt->realtimeDenied ? realtimeName (REALTIME_OFF) : realtimeName (p_fSt->realtime));
+    for (t = 0; t < NSERVERS; t++) {
+        fprintf (fp, ",%lld,%lld", histPercentile (&p_fSt->wakeup[t], 50.0), histPercentile (&p_fSt->wakeup[t], 99.0));
+    }
+    fprintf (fp, ",%d,%s,%.1f,%d,%s,%.2f,%.2f", nShards, dispatchName (p_fSt->dispatch), shardImbalance (), nHosts,
+             p_fSt->eventLoop ? "ON" : "OFF", histMean (&p_fSt->batch[SRV_WAITER]), histMean (&p_fSt->batch[SRV_RECEPTIONIST]));
+    fprintf (fp, ",%s,%lld,%lld,%.3f,%.3f\n", launchName (p_fSt->launch), histPercentile (&p_fSt->startup[ENT_GROUPS], 50.0),
+             histPercentile (&p_fSt->startup[ENT_GROUPS], 99.0), histPercentile (&p_fSt->firstRequest, 50.0) / 1000.0,
+             histPercentile (&p_fSt->firstRequest, 99.0) / 1000.0);
+    if (fclose (fp) == EOF) {
+        perror ("error on closing the CSV file");
+        exit (EXIT_FAILURE);
+    }
+}
+
+/**
+ *  \brief Description of the exit status of the first failed process of a kind.
+ *
+ *  \param kind kind of entity (SRV_* or ENT_GROUPS)
+ *  \param buf location where the description is stored: "0" if none failed, "exit n" or "signal n"
+ *  \param len size of buf
+ */
+static void exitName (int kind, char buf[], size_t len)
+{
+    if (nFailed[kind] == 0) {
+        snprintf (buf, len, "0");
+    }
+    else if (WIFSIGNALED (failStatus[kind])) {
+        snprintf (buf, len, "signal %d", WTERMSIG (failStatus[kind]));
+    }
+    else snprintf (buf, len, "exit %d", WEXITSTATUS (failStatus[kind]));
+}
+
+/**
+ *  \brief Appending a summary of the run to a file, as a line of JSON.
+ *
+ *  The line is a flat object, so a batch of runs is a stream of lines that runStats aggregates: whether
+ *  the run completed (every process exited with status 0 and no stop was requested), was stopped by a
+ *  signal or stalled (see watchdogCheck), the injected delays, its wall time
+ *  from the start of the program and the duration of its operations (s), the groups served, the time
+ *  groups waited for a table and spent in each state (ms), the groups admitted and turned away, the
+ *  mean and largest number of groups waiting and the largest number inside, the load of each kitchen
+ *  station, if any, and how the processes of each kind of entity exited (the first failure of each
+ *  kind, and the number of group processes that failed).
+ *
+ *  \param nSum name of the summary file
+ *  \param p_fSt pointer to the location where the full internal state of the problem is stored
+ */
+static void writeSummary (char nSum[], FULL_STAT *p_fSt)
+{
+    static const char *kindKeys[NSERVERS + 1] = { "chef", "waiter", "receptionist", "groups" };
+    FILE *fp;
+    double duration = (p_fSt->endRun - p_fSt->startRun) / 1e6;
+    char status[32], jit[64], kit[MAXSTATIONS * (KITCHENNAMELEN + 8)], adm[64];
+    int st, k, failed = 0;
+
+    for (k = 0; k <= ENT_GROUPS; k++) {
+        failed += nFailed[k];
+    }
+    if ((fp = fopen (nSum, "a")) == NULL) {
+        perror ("error on opening the summary file");
+        exit (EXIT_FAILURE);
+    }
+    jitterName (p_fSt, jit, sizeof (jit));
+    kitchenName (p_fSt, kit, sizeof (kit));
+    admissionName (p_fSt, adm, sizeof (adm));
+    fprintf (fp, "{\"seed\":%u,\"backend\":\"%s\",\"policy\":\"%s\",\"arrivals\":\"%s\",\"shards\":%d,\"jitter\":\"%s\","
+                 "\"kitchen\":\"%s\",\"ok\":%s,\"stopped\":%s,\"stalled\":%s,\"wall_s\":%.3f,\"duration_s\":%.3f,"
+                 "\"served\":%d,\"groups_per_s\":%.2f",
+             p_fSt->seed, SEMBACKEND, policyName (p_fSt->policy), arrivalName (p_fSt->gen.arrivals), nShards, jit, kit,
+             ((failed == 0) && !stopRequested) ? "true" : "false", (stopRequested && !stalled) ? "true" : "false",
+             stalled ? "true" : "false",
+             (timeNow () - wallStart) / 1e6, duration, nServed, (duration > 0.0) ? nServed / duration : 0.0);
+    fprintf (fp, ",\"table_wait_mean_ms\":%.3f,\"table_wait_p99_ms\":%.3f,\"table_wait_max_ms\":%.3f",
+             histMean (&p_fSt->tableWait) / 1000.0, histPercentile (&p_fSt->tableWait, 99.0) / 1000.0,
+             p_fSt->tableWait.max / 1000.0);
+    for (st = GOTOREST; st < LEAVING; st++) {
+        fprintf (fp, ",\"%s_p50_ms\":%.3f,\"%s_p99_ms\":%.3f,\"%s_max_ms\":%.3f",
+                 stateKeys[st], histPercentile (&stateWait[st], 50.0) / 1000.0,
+                 stateKeys[st], histPercentile (&stateWait[st], 99.0) / 1000.0, stateKeys[st], stateWait[st].max / 1000.0);
+    }
+    fprintf (fp, ",\"admission\":\"%s\",\"admitted\":%lu,\"rejected\":%lu,\"rejected_full\":%lu,\"rejected_wait\":%lu,"
+                 "\"waiting_mean\":%.3f,\"waiting_max\":%d,\"inside_max\":%d", adm, p_fSt->admission.admitted,
+             p_fSt->admission.rejectedFull + p_fSt->admission.rejectedWait, p_fSt->admission.rejectedFull,
+             p_fSt->admission.rejectedWait, (duration > 0.0) ? p_fSt->admission.depthArea / (duration * 1e6) : 0.0,
+             waitingMax (p_fSt), insideMax);
+    fprintf (fp, ",\"food_p50_ms\":%.3f,\"food_p99_ms\":%.3f,\"food_max_ms\":%.3f",
+             histPercentile (&foodWait, 50.0) / 1000.0, histPercentile (&foodWait, 99.0) / 1000.0, foodWait.max / 1000.0);
+    if (p_fSt->kitchen.nStations > 0) {
+        KITCHEN *kt = &p_fSt->kitchen;
+
+        fprintf (fp, ",\"bottleneck\":\"%s\",\"kitchen_p50_ms\":%.3f,\"kitchen_p99_ms\":%.3f",
+                 kt->stationName[bottleneck (p_fSt)], histPercentile (&kt->orderTime, 50.0) / 1000.0,
+                 histPercentile (&kt->orderTime, 99.0) / 1000.0);
+        for (k = 0; k < kt->nStations; k++) {
+            fprintf (fp, ",\"%s_util_pct\":%.1f,\"%s_wait_p99_ms\":%.3f,\"%s_queue_max\":%d", kt->stationName[k],
+                     stationUtil (p_fSt, k), kt->stationName[k], histPercentile (&kt->stationWait[k], 99.0) / 1000.0,
+                     kt->stationName[k], kt->stationQueueMax[k]);
+        }
+    }
+    for (k = 0; k <= ENT_GROUPS; k++) {
+        exitName (k, status, sizeof (status));
+        fprintf (fp, ",\"exit_%s\":\"%s\"", kindKeys[k], status);
+    }
+    fprintf (fp, ",\"failed_groups\":%d}\n", nFailed[ENT_GROUPS]);
+    if (fclose (fp) == EOF) {
+        perror ("error on closing the summary file");
+        exit (EXIT_FAILURE);
+    }
+}
+
+/**
+ *  \brief Name of a file of a shard.
+ *
+ *  With several shards, the name is followed by <tt>.s</tt>, the shard id. Empty names (stdout) and
+ *  devices (<tt>/dev/null</tt>) are shared by all shards.
+ *
+ *  \param name location where the name is stored
+ *  \param size size of the location
+ *  \param base configured name
+ *  \param s shard id
+ */
+static void shardFile (char name[], size_t size, const char base[], int s)
+{
+    if ((nShards == 1) || (strlen (base) == 0) || (strncmp (base, "/dev/", 5) == 0)) {
+        snprintf (name, size, "%s", base);
+    }
+    else snprintf (name, size, "%s.%d", base, s);
+}
+
+/**
+ *  \brief Creation of the server processes of a shard.
+ *
+ *  \param s shard id
+ *  \param sh pointer to the shared memory region of the shard
+ *  \param nFic name of the logging file of the shard
+ *  \param key access key to shared memory and semaphore set of the shard (as a string)
+ */
+static void spawnServers (int s, SHARED_DATA *sh, char nFic[], char key[])
+{
+    char nFicErr[16];                                                                       /* name of error files */
+    char suffix[4] = "";                                                             /* shard id, if several */
+
+    if (nShards > 1) {
+        sprintf (suffix, "%d", s);
+    }
+
+    /* waiter process */
+    sprintf (nFicErr, "error_WT%s", suffix);
+    sh->fSt.serverSpawn[SRV_WAITER] = timeNow ();
+    if ((pidWT[s] = fork ()) < 0)  {
+        perror ("error on the fork operation for the waiter");
+        exit (EXIT_FAILURE);
+    }
+    if (pidWT[s] == 0) {
+        signal (SIGINT, SIG_IGN);
+        placementApply (&placement, PLACE_WAITER, 0);
+        realtimeApply (sh->fSt.realtimeDenied ? REALTIME_OFF : sh->fSt.realtime, sh->fSt.rtPriority[SRV_WAITER]);
+        if (execl (WAITER, WAITER, nFic, key, nFicErr, NULL) < 0) {
+            perror ("error on the generation of the waiter process");
+            exit (EXIT_FAILURE);
+        }
+    }
+    /* chef process */
+    sprintf (nFicErr, "error_CH%s", suffix);
+    sh->fSt.serverSpawn[SRV_CHEF] = timeNow ();
+    if ((pidCH[s] = fork ()) < 0) {
+        perror ("error on the fork operation for the chef");
+        exit (EXIT_FAILURE);
+    }
+    if (pidCH[s] == 0) {
+        signal (SIGINT, SIG_IGN);
+        placementApply (&placement, PLACE_CHEF, 0);
+        realtimeApply (sh->fSt.realtimeDenied ? REALTIME_OFF : sh->fSt.realtime, sh->fSt.rtPriority[SRV_CHEF]);
+        if (execl (CHEF, CHEF, nFic, key, nFicErr, NULL) < 0) {
+            perror ("error on the generation of the chef process");
+            exit (EXIT_FAILURE);
+        }
+    }
+
+    /* receptionist process */
+    sprintf (nFicErr, "error_RT%s", suffix);
+    sh->fSt.serverSpawn[SRV_RECEPTIONIST] = timeNow ();
+    if ((pidRT[s] = fork ()) < 0) {
+        perror ("error on the fork operation for the chef");
+        exit (EXIT_FAILURE);
+    }
+    if (pidRT[s] == 0) {
+        signal (SIGINT, SIG_IGN);
+        placementApply (&placement, PLACE_RECEPTIONIST, 0);
+        realtimeApply (sh->fSt.realtimeDenied ? REALTIME_OFF : sh->fSt.realtime, sh->fSt.rtPriority[SRV_RECEPTIONIST]);
+        if (execl (RECEPTIONIST, RECEPTIONIST, nFic, key, nFicErr, NULL) < 0) {
+            perror ("error on the generation of the receptionist process");
+            exit (EXIT_FAILURE);
+        }
+    }
+}
+
+/**
+ *  \brief Main program.
+ *
+ *  Its role is starting the simulation by generating the intervening entities processes (pilot, hostess and passengers)
+ *  and waiting for their termination.
+ */
+int main (int argc, char *argv[])
+{
+    char nFic[51];                                                                              /*name of logging file */
+    char logName[MAXSHARDS][WLNAMELEN];                                              /* name of logging file of each shard */
+    int shmid[MAXSHARDS],                                                 /* shared memory access identifier of each shard */
+        semid[MAXSHARDS];                                                 /* semaphore set access identifier of each shard */
+    int semgid;                                                         /* semaphore set access identifier of a shard */
+    int m;                                                                                      /* counting variables */
+    SHARED_DATA *shard[MAXSHARDS];                                       /* pointer to shared memory region of each shard */
+    SHARED_DATA *sh;                                                    /* pointer to shared memory region of a shard */
+    static FULL_STAT config;                                                /* parameters read from config file */
+    static FULL_STAT total;                                                           /* statistics of all shards */
+    static HISTOGRAM lateArrivals;                           /* delay of open-loop arrivals without a free slot */
+    WL_STREAM ws;                                                                            /* workload file */
+    WL_RECORD rec;                                                                   /* group of workload file */
+    unsigned long skipped = 0;                                           /* groups of workload file that never fit */
+    struct sigaction sa;                                                            /* SIGINT and SIGTERM handling */
+    static int pidGR[MAXSHARDS][MAXGROUPS];                     /* group processes identifier arrays of the shards */
+    int key;                                                           /*access key to shared memory and semaphore set */
+    char num[MAXSHARDS][12];                         /* numeric value conversion of the key of each shard (up to 10 digits) */
+    char leftNum[12];                                   /* numeric value conversion of the key of the hosts' semaphore set */
+    char *place = NULL;                                                /* placement given in the command line */
+    char *summary = NULL;                                          /* summary file given in the command line */
+    char jit[64];                                                       /* description of the injected delays */
+    int g, t, s, opt;
+    int arrived = 0;                                                    /* number of groups that arrived so far */
+    long long start;
+    struct itimerval at;                                                                  /* time of the checkpoint */
+    timer_t watchdog;                                                                       /* ticks of the watchdog */
+    struct sigevent ev;
+    struct itimerspec tick;
+
+    /* getting the placement, the summary file and the log file name */
+    wallStart = timeNow ();
+    while ((opt = getopt (argc, argv, "p:s:")) != -1) {
+        if (opt == 'p') {
+            place = optarg;
+        }
+        else if (opt == 's') {
+            summary = optarg;
+        }
+        else {
+            fprintf (stderr, "USAGE: %s [-p «placement»] [-s «summary file»] [«log file» [«csv file»]]\n", argv[0]);
+            exit (EXIT_FAILURE);
+        }
+    }
+    argc -= optind - 1;
+    argv += optind - 1;
+    if((argc==2) || (argc==3)) {
+        strcpy(nFic, argv[1]);
+    }
+    else strcpy(nFic, "");
+
+    /* parse config file (before creating anything that would have to be destroyed on error) */
+    readConfig ("config.txt", &config);
+    if (config.gen.arrivals == ARRIVALS_FILE) {
+        if (wlOpen (config.gen.file, &ws) == -1) {
+            perror ("error on opening the workload file");
+            exit (EXIT_FAILURE);
+        }
+        if ((config.totalGroups == 0) || ((size_t) config.totalGroups > ws.count)) {
+            config.totalGroups = (ws.count > INT_MAX) ? INT_MAX : (int) ws.count;
+        }
+    }
+    if (place != NULL) {
+        snprintf (config.placement, sizeof (config.placement), "%s", place);
+    }
+    if (placementParse (config.placement, &placement) == -1) {
+        fprintf (stderr, "invalid placement \"%s\": NONE, ISOLATED, ONECORE or CUSTOM chef waiter receptionist groups\n",
+                 config.placement);
+        exit (EXIT_FAILURE);
+    }
+    if ((config.realtime != REALTIME_OFF) && (realtimeCheck (config.realtime, config.rtPriority) == -1)) {
+        if (errno == EINVAL) {
+            fprintf (stderr, "invalid real-time priority: %s priorities range from %d to %d\n", realtimeName (config.realtime),
+                     sched_get_priority_min (config.realtime == REALTIME_RR ? SCHED_RR : SCHED_FIFO),
+                     sched_get_priority_max (config.realtime == REALTIME_RR ? SCHED_RR : SCHED_FIFO));
+            exit (EXIT_FAILURE);
+        }
+        perror ("real-time scheduling not permitted, the servers use the default policy");
+        config.realtimeDenied = true;
+    }
+    if (config.seed == 0) {
+        config.seed = (unsigned int) getpid ();
+    }
+    nShards = config.nShards;
+    if (config.checkpoint == CKPT_RESUME) {
+        checkpointLoad (config.checkpointFile, &resumed);
+        for (s = 0; s < resumed.nShards; s++) {
+            if ((resumed.nShards != nShards) || !checkpointMatch (&resumed.shard[s], &config)) {
+                fprintf (stderr, "%s: the shards, group slots or tables of the config file are not those of the checkpoint\n",
+                         config.checkpointFile);
+                exit (EXIT_FAILURE);
+            }
+        }
+        arrived = resumed.arrived;
+    }
+
+    /* SIGINT and SIGTERM close the restaurant; not restarted, so that sleeps and waits are cut short */
+    memset (&sa, 0, sizeof (sa));
+    sa.sa_handler = onStop;
+    sa.sa_flags = SA_RESETHAND;
+    sigemptyset (&sa.sa_mask);
+    if ((sigaction (SIGINT, &sa, NULL) == -1) || (sigaction (SIGTERM, &sa, NULL) == -1)) {
+        perror ("error on installing the signal handler");
+        exit (EXIT_FAILURE);
+    }
+
+    /* SIGUSR1 and SIGALRM save the state of the run, likewise not restarted */
+    if (config.checkpoint == CKPT_SAVE) {
+        sa.sa_handler = onCheckpoint;
+        sa.sa_flags = 0;
+        if ((sigaction (SIGUSR1, &sa, NULL) == -1) || (sigaction (SIGALRM, &sa, NULL) == -1)) {
+            perror ("error on installing the signal handler");
+            exit (EXIT_FAILURE);
+        }
+    }
+
+    /* the ticks of the watchdog interrupt the waits of the main program, likewise not restarted */
+    if (config.watchdog > 0) {
+        sa.sa_handler = onWatchdog;
+        sa.sa_flags = 0;
+        if (sigaction (SIGRTMIN, &sa, NULL) == -1) {
+            perror ("error on installing the signal handler");
+            exit (EXIT_FAILURE);
+        }
+    }
+
+    /* initialize random generator (replaying, the seed of the recorded run is used) and the grant log */
+    if (config.replay != REPLAY_OFF) {
+        replayCreate (config.replay, config.replayFile, &config.seed);
+    }
+    rngSeed (&rng, config.seed, REPLAY_MAIN);
+    if (config.checkpoint == CKPT_RESUME) {
+        rng = resumed.rng;
+        arrivalShift = resumed.clock;
+        lastArrival = resumed.arrival;
+    }
+    lastRng = rng;
+
+    for (s = 0; s < nShards; s++) {
+        /* composing command line (shard s uses the key of project id 'a' + s) */
+        if ((key = ftok (".", 'a' + s)) == -1) {
+            perror ("error on generating the key");
+            exit (EXIT_FAILURE);
+        }
+        sprintf (num[s], "%d", key);
+
+        /* creating and initializing the shared memory region and the log file */
+        if ((shmid[s] = shmemCreate (key, sizeof (SHARED_DATA))) == -1) {
+            perror ("error on creating the shared memory region");
+            exit (EXIT_FAILURE);
+        }
+        if (shmemAttach (shmid[s], (void **) &shard[s]) == -1) {
+            perror ("error on mapping the shared region on the process address space");
+            exit (EXIT_FAILURE);
+        }
+        sh = shard[s];
+
+        /* initialize problem internal status */
+        sh->fSt = config;
+        shardFile (sh->fSt.traceFile, sizeof (sh->fSt.traceFile), config.traceFile, s);
+        sh->fSt.st.chefStat         = WAIT_FOR_ORDER;                     /* the chef waits for an order */
+        sh->fSt.st.waiterStat       = WAIT_FOR_REQUEST;                /* the waiter waits for a request */
+        sh->fSt.st.receptionistStat = WAIT_FOR_REQUEST;          /* the receptionist waits for a request */
+        for (g = 0; g < MAXGROUPS; g++) {
+            sh->fSt.st.groupStat[g] = GOTOREST;                                /* groups are initialized */
+            sh->fSt.assignedTable[g] = -1;                                     /* groups are initialized */
+            sh->fSt.groupTables[g] = 0;
+            sh->fSt.groupArrival[g] = g;
+            sh->fSt.slotState[g] = SLOT_FREE;
+            sh->fSt.wakeTime[g] = 0;
+            sh->fSt.resumed[g] = false;
+            sh->fSt.rejected[g] = false;
+            sh->fSt.failed[g] = false;
+            memset (sh->fSt.notice[g], 0, sizeof (sh->fSt.notice[g]));
+            memset (sh->fSt.stateTime[g], 0, sizeof (sh->fSt.stateTime[g]));
+        }
+        memset (&sh->fSt.reception, 0, sizeof (sh->fSt.reception));                 /* every group TOARRIVE */
+        sh->fSt.closing=false;
+        sh->fSt.workersFailed=0;
+        sh->fSt.groupsWaiting=0;
+        sh->fSt.nFoodReady=0;
+        sh->fSt.foodReadyPending=false;
+        histInit (&sh->fSt.tableWait);
+        for (t = 0; t < NSERVERS; t++) {
+            sh->fSt.wakeupStamp[t] = 0;
+            histInit (&sh->fSt.wakeup[t]);
+            histInit (&sh->fSt.batch[t]);
+            sh->fSt.heartbeat[t] = 0;
+        }
+        for (t = 0; t <= ENT_GROUPS; t++) {
+            histInit (&sh->fSt.startup[t]);
+        }
+        histInit (&sh->fSt.firstRequest);
+        sh->fSt.waiterQueue.n = 0;
+        sh->fSt.receptionistQueue.n = 0;
+        if (sh->fSt.eventLoop && (eventCreate (sh->fSt.eventFd) == -1)) {         /* inherited by the entities */
+            perror ("error on creating the event channels");
+            exit (EXIT_FAILURE);
+        }
+        for (t = 0; t < MAXSEMS; t++) {
+            sh->fSt.semUpTime[t] = 0;
+            sh->fSt.semNotify[t] = 0;
+        }
+        for (t = 0; t < SEMKINDS; t++) {
+            histInit (&sh->fSt.semWakeup[t]);
+        }
+        for (t = 0; t < MAXTABLES; t++) {
+            sh->fSt.tableSeats[t] = 0;
+            sh->fSt.tableBusy[t] = 0;
+        }
+        sh->fSt.seatBusy = 0;
+        sh->fSt.kitchen.nextDone = 0;
+        for (t = 0; t < MAXSTATIONS; t++) {
+            sh->fSt.kitchen.stationBusy[t] = 0;
+            sh->fSt.kitchen.stationDishes[t] = 0;
+            histInit (&sh->fSt.kitchen.stationWait[t]);
+            sh->fSt.kitchen.stationQueueMax[t] = 0;
+        }
+        histInit (&sh->fSt.kitchen.orderTime);
+        sh->fSt.admission.admitted = 0;
+        sh->fSt.admission.rejectedFull = sh->fSt.admission.rejectedWait = 0;
+        sh->fSt.admission.stayTime = 0;
+        sh->fSt.admission.stays = 0;
+        sh->fSt.admission.depthArea = 0;
+        sh->fSt.admission.depthSince = 0;
+        timelineInit (&sh->fSt.admission.depth);
+
+        /* create log file */
+        shardFile (logName[s], sizeof (logName[s]), nFic, s);
+        createLog (logName[s], &sh->fSt);
+        saveState(logName[s],&sh->fSt);
+
+        /* initialize semaphore ids */
+        sh->mutex                       = MUTEX;                                /* mutual exclusion semaphore id */
+        sh->receptionistReq             = RECEPTIONISTREQ;
+        sh->receptionistRequestPossible = RECEPTIONISTREQUESTPOSSIBLE;
+        sh->waiterRequest               = WAITERREQUEST;
+        sh->waiterRequestPossible       = WAITERREQUESTPOSSIBLE;
+        sh->waitOrder                   = WAITORDER;
+        sh->orderReceived               = ORDERRECEIVED;
+        for(g=0;g<GROUPSEMS (&sh->fSt);g++) {                       /* none when the groups are coroutines */
+           sh->waitForTable[g]          = WAITFORTABLE+g;
+           sh->foodArrived[g]           = FOODARRIVED+g;
+           sh->tableDone[g]             = TABLEDONE+g;
+           sh->requestReceived[g]       = REQUESTRECEIVED+g;
+        }
+        for (g = 0; g < sh->fSt.groupHosts; g++) {
+           sh->groupHost[g]             = GROUPHOST+g;
+        }
+
+        /* creating and initializing the semaphore set */
+        if ((semgid = semid[s] = semCreate (key, SEM_NU)) == -1) {
+            perror ("error on creating the semaphore set");
+            exit (EXIT_FAILURE);
+        }
+        if (semUp (semgid, sh->mutex) == -1) {                   /* enabling access to critical region */
+            perror ("error on executing the up operation for semaphore access");
+            exit (EXIT_FAILURE);
+        }
+        if (semUp (semgid, sh->waiterRequestPossible) == -1) {                   /* enabling access to critical region */
+            perror ("error on executing the up operation for semaphore access");
+            exit (EXIT_FAILURE);
+        }
+        if (semUp (semgid, sh->receptionistRequestPossible) == -1) {                   /* enabling access to critical region */
+            perror ("error on executing the up operation for semaphore access");
+            exit (EXIT_FAILURE);
+        }
+        if (sh->fSt.replay != REPLAY_OFF) {
+            replayAttach (semgid, REPLAY_MAIN);
+        }
+    }
+
+    /* creating the semaphore set the hosts of the groups report groups leaving on */
+    if ((nHosts = config.groupHosts) > 0) {
+        if ((key = ftok (".", 'l')) == -1) {
+            perror ("error on generating the key");
+            exit (EXIT_FAILURE);
+        }
+        sprintf (leftNum, "%d", key);
+        if ((leftgid = semCreate (key, 1)) == -1) {
+            perror ("error on creating the semaphore set");
+            exit (EXIT_FAILURE);
+        }
+    }
+
+    /* generation of intervening entities processes */
+    m = 0;                                                                         /* processes not yet reaped */
+    for (s = 0; s < nShards; s++) {
+        sh = shard[s];
+        bindShard (semid[s], sh);
+        /* groups (open-loop groups are started later, at their arrival time; resuming, the groups inside are
+           started, their state is restored at the start of operations) */
+        for (g = 0; g < sh->fSt.nGroups; g++) {
+            pidGR[s][g] = 0;
+            if ((config.checkpoint == CKPT_RESUME) ? resumed.shard[s].inside[g] : (sh->fSt.gen.arrivals == ARRIVALS_CONFIG)) {
+                m += startGroup (semid[s], sh, pidGR[s], g, logName[s], num[s]);
+            }
+        }
+        for (g = 0; g < nHosts; g++) {
+            pidHS[s][g] = spawnHost (g, sh->fSt.launch, logName[s], num[s], leftNum);
+            m += 1;
+        }
+        spawnServers (s, sh, logName[s], num[s]);
+        m += 3;
+    }
+
+    /* signaling start of operations */
+    if ((nHosts > 0) && (semSignal (leftgid) == -1)) {
+        perror ("error on signaling start of operations");
+        exit (EXIT_FAILURE);
+    }
+    start = timeNow ();
+    for (s = 0; s < nShards; s++) {
+        shard[s]->fSt.startRun = start;
+        if (config.checkpoint == CKPT_RESUME) {
+            checkpointRestore (&resumed.shard[s], shard[s], semid[s], start, resumed.taken);
+        }
+        if (semSignal (semid[s]) == -1) {
+            perror ("error on signaling start of operations");
+            exit (EXIT_FAILURE);
+        }
+    }
+    if (config.watchdog > 0) {
+        memset (&ev, 0, sizeof (ev));
+        ev.sigev_notify = SIGEV_SIGNAL;
+        ev.sigev_signo = SIGRTMIN;
+        tick.it_value.tv_sec = tick.it_interval.tv_sec = 0;
+        tick.it_value.tv_nsec = tick.it_interval.tv_nsec = WATCHDOGTICK * 1000000L;
+        if ((timer_create (CLOCK_MONOTONIC, &ev, &watchdog) == -1) || (timer_settime (watchdog, 0, &tick, NULL) == -1)) {
+            perror ("error on starting the watchdog");
+            exit (EXIT_FAILURE);
+        }
+    }
+    if ((config.checkpoint == CKPT_SAVE) && (config.checkpointAt > 0)) {
+        memset (&at, 0, sizeof (at));
+        at.it_value.tv_sec = config.checkpointAt / 1000;
+        at.it_value.tv_usec = (config.checkpointAt % 1000) * 1000;
+        if (setitimer (ITIMER_REAL, &at, NULL) == -1) {
+            perror ("error on setting the time of the checkpoint");
+            exit (EXIT_FAILURE);
+        }
+    }
+
+    /* open-loop workload: each group is created at its arrival time in a free slot of the shard chosen
+       by the dispatcher, waiting for one if all are in use (the delay is reported); it runs until count
+       groups arrived (forever if count is 0) or a stop is requested; a resumed run goes on after the groups that
+       arrived before the checkpoint, with its arrival clock and random stream */
+    if (config.gen.arrivals != ARRIVALS_CONFIG) {
+        long long arrival = lastArrival, delay;
+        int n;
+
+        for (n = 0; (config.gen.arrivals == ARRIVALS_FILE) && (n < arrived) && wlNext (&ws, &rec); n++) {
+        }                                                             /* skip the records of the groups that arrived */
+        for (n = arrived; (config.totalGroups == 0) || (n < config.totalGroups); n++) {
+            if (config.gen.arrivals != ARRIVALS_FILE) {
+                arrival = nextArrival (&config.gen, &rng, arrival);
+            }
+            else if (!wlNext (&ws, &rec)) {
+                break;
+            }
+            else if ((rec.size < 1) || (rec.size > largestGroup (&config))) {
+                skipped += 1;
+                continue;
+            }
+            else arrival = rec.arrival;
+            while (!stopRequested && ((delay = arrival - (timeNow () - start + arrivalShift)) > 0)) {
+                pollCheckpoint (shard, semid, pidGR, n);
+                usleep ((unsigned int) delay);                                  /* cut short by a checkpoint */
+            }
+            while (reapChild (pidGR, shard, WNOHANG) > 0) {
+                m -= 1;
+            }
+            while (!stopRequested && ((s = dispatchGroup (shard, pidGR, config.dispatch)) == -1)) {
+                pollCheckpoint (shard, semid, pidGR, n);
+                m -= waitGroup (pidGR, shard);
+            }
+            if (stopRequested) {
+                break;
+            }
+            if ((delay = timeNow () - start + arrivalShift - arrival) > 1000) {
+                histAdd (&lateArrivals, delay);
+            }
+            sh = shard[s];
+            semgid = semid[s];
+            g = freeSlot (pidGR[s], sh->fSt.nGroups);
+            bindShard (semgid, sh);
+
+            if (semDown (semgid, sh->mutex) == -1) {                                     /* enter critical region */
+                perror ("error on the down operation for semaphore access");
+                exit (EXIT_FAILURE);
+            }
+            sh->fSt.st.groupStat[g] = GOTOREST;
+            sh->fSt.assignedTable[g] = -1;
+            sh->fSt.groupTables[g] = 0;
+            sh->fSt.groupArrival[g] = n;
+            sh->fSt.wakeTime[g] = 0;
+            sh->fSt.resumed[g] = false;
+            sh->fSt.rejected[g] = false;
+            sh->fSt.failed[g] = false;
+            memset (sh->fSt.notice[g], 0, sizeof (sh->fSt.notice[g]));
+            memset (sh->fSt.stateTime[g], 0, sizeof (sh->fSt.stateTime[g]));
+            if (sh->fSt.gen.arrivals == ARRIVALS_FILE) {
+                sh->fSt.eatTime[g] = rec.eatTime;
+                sh->fSt.groupSize[g] = rec.size;
+            }
+            else {
+                sh->fSt.eatTime[g] = sampleMealTime (&config.gen, &rng);
+                sh->fSt.groupSize[g] = sampleGroupSize (&config.gen, &rng);
+            }
+            if (semUp (semgid, sh->mutex) == -1) {                                        /* exit critical region */
+                perror ("error on the up operation for semaphore access");
+                exit (EXIT_FAILURE);
+            }
+            m += startGroup (semgid, sh, pidGR[s], g, logName[s], num[s]);
+            arrived = n + 1;
+            lastArrival = arrival;
+            lastRng = rng;
+        }
+    }
+
+    /* closing: the groups inside are served, then the servers are told to finish (unless the run stalled,
+       its processes were then killed) */
+    for (s = 0; (s < nShards) && !stalled; s++) {
+        while (!stalled && (busySlots (pidGR[s], shard[s]->fSt.nGroups) > 0)) {
+            pollCheckpoint (shard, semid, pidGR, arrived);
+            m -= waitGroup (pidGR, shard);
+        }
+        if (!stalled) {
+            bindShard (semid[s], shard[s]);
+            closeRestaurant (semid[s], shard[s]);
+        }
+    }
+
+    /* waiting for the termination of the intervening entities processes */
+    while (m > 0) {
+        m -= (reapChild (pidGR, shard, 0) > 0);
+    }
+    if (config.watchdog > 0) {
+        timer_delete (watchdog);
+    }
+    for (s = 0; s < nShards; s++) {
+        ADMISSION *a = &shard[s]->fSt.admission;
+
+        shard[s]->fSt.endRun = timeNow ();
+        if (a->depthSince > 0) {                         /* groups left waiting, if the run was cut short */
+            a->depthArea += shard[s]->fSt.groupsWaiting * (shard[s]->fSt.endRun - a->depthSince);
+        }
+        timelineSet (&a->depth, shard[s]->fSt.endRun - shard[s]->fSt.startRun, shard[s]->fSt.groupsWaiting);
+    }
+
+    if (config.gen.arrivals == ARRIVALS_FILE) {
+        wlClose (&ws);
+    }
+    if (skipped > 0) {
+        printf ("\n%lu groups of the workload file skipped: they do not fit at any table\n", skipped);
+    }
+    if (lateArrivals.count > 0) {
+        printf ("\n%lu arrivals delayed waiting for a free group slot, max delay %.1f ms\n",
+                lateArrivals.count, lateArrivals.max / 1000.0);
+    }
+    if (config.checkpoint == CKPT_RESUME) {
+        printf ("\nResumed from %s, saved %.1f ms into its run\n", config.checkpointFile, resumed.elapsed / 1000.0);
+    }
+    if (stalled) {
+        printf ("\nRun stalled: killed by the watchdog after %d ms without a change of state\n", config.watchdog);
+    }
+    if (config.jitter != 0) {
+        jitterName (&config, jit, sizeof (jit));
+        printf ("\nJitter injected: %s (us)\n", jit);
+    }
+    if (nCheckpoints > 0) {
+        printf ("\nState of the run saved to %s %d times, last %.1f ms into the run with %d groups inside\n",
+                config.checkpointFile, nCheckpoints, checkpointElapsed / 1000.0, checkpointInside);
+    }
+    mergeShards (shard, &total);
+    printStats (&total);
+    printShards (shard);
+    printKitchen (&total);
+    printAdmission (&total);
+    printSemTiming (&total);
+    if (total.replay != REPLAY_OFF) {
+        replayFinish (total.replayFile, total.seed);
+    }
+    if (argc == 3) {
+        writeCsv (argv[2], nFic, &total);
+    }
+    if (summary != NULL) {
+        writeSummary (summary, &total);
+    }
+
+    /* destruction of semaphore sets and shared regions */
+    if ((nHosts > 0) && (semDestroy (leftgid) == -1)) {
+        perror ("error on destructing the semaphore set");
+        exit (EXIT_FAILURE);
+    }
+    for (s = 0; s < nShards; s++) {
+        if (shard[s]->fSt.eventLoop) {
+            eventDestroy (shard[s]->fSt.eventFd);
+        }
+        if (semDestroy (semid[s]) == -1) {
+            perror ("error on destructing the semaphore set");
+            exit (EXIT_FAILURE);
+        }
+        if (shmemDettach (shard[s]) == -1) {
+            perror ("error on unmapping the shared region off the process address space");
+            exit (EXIT_FAILURE);
+        }
+        if (shmemDestroy (shmid[s]) == -1) {
+            perror ("error on destructing the shared region");
+            exit (EXIT_FAILURE);
+        }
+    }
+
+    for (t = 0; t <= ENT_GROUPS; t++) {
+        if (nFailed[t] > 0) {
+            return EXIT_FAILURE;
+        }
     }
 
     return EXIT_SUCCESS;
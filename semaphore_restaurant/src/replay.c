@@ -0,0 +1,299 @@
+/**
+ *  \file replay.c (implementation file)
+ *
+ *  \brief Problem name: Restaurant
+ *
+ *  \brief Record and replay of the order in which semaphores are granted.
+ *
+ *  The grant log lives in a shared memory region and the turns in a semaphore set (one semaphore per
+ *  entity), both created with a key of their own. The functions of this module are called around
+ *  every <em>down</em> (see semSetHooks):
+ *     \li recording, a grant is appended once the <em>down</em> succeeds
+ *     \li replaying, an entity waits for its turn before the <em>down</em> and, once it succeeds,
+ *         passes the turn to the owner of the next grant.
+ *
+ *  Only one entity at a time owns the turn, so the grants are made in the order of the log; an
+ *  <em>up</em> is never delayed, so the owner of the turn is always able to complete its
+ *  <em>down</em> if the run did not diverge.
+ *
+ *  Defined operations:
+ *     \li creation of the grant log (by the main program, loading it to replay)
+ *     \li attaching an entity to the grant log
+ *     \li saving or checking the grant log and destroying it.
+ */
+
+#define _GNU_SOURCE                                                                       /* semtimedop */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/ipc.h>
+#include <sys/sem.h>
+
+#include "probConst.h"
+#include "semaphore.h"
+#include "sharedMemory.h"
+#include "replay.h"
+
+/** \brief maximum number of grants in the log */
+#define  MAXGRANTS      65536
+
+/** \brief number of entities */
+#define  NENTITIES      (REPLAY_GROUP + MAXGROUPS)
+
+/** \brief time without any grant after which a replay is taken as diverged (s) */
+#define  REPLAYSTALL    10
+
+/**
+ *  \brief Definition of a grant: a <em>down</em> completed by an entity.
+ */
+typedef struct {
+    /** \brief entity id */
+    short entity;
+    /** \brief semaphore location in the set */
+    short sem;
+} GRANT;
+
+/**
+ *  \brief Definition of the grant log.
+ */
+typedef struct {
+    /** \brief REPLAY_RECORD or REPLAY_REPLAY */
+    int mode;
+    /** \brief number of grants in the log (recording, may exceed MAXGRANTS) */
+    unsigned int nGrants;
+    /** \brief next grant to be made (replaying) */
+    unsigned int next;
+    /** \brief grants made after the end of the log or after the replay diverged */
+    unsigned int extra;
+    /** \brief set when the replay diverged, the order is no longer enforced */
+    bool diverged;
+    /** \brief set when the last grant of the log was made, the order is no longer enforced */
+    bool done;
+    /** \brief grants, in the order they were made */
+    GRANT grant[MAXGRANTS];
+} REPLAY_LOG;
+
+/** \brief grant log */
+static REPLAY_LOG *rl;
+
+/** \brief shared memory and turn semaphore set identifiers */
+static int shmid = -1, turngid = -1;
+
+/** \brief identifier of the semaphore set of the problem */
+static int maingid = -1;
+
+/** \brief entity id of the process */
+static int me;
+
+/* internal functions */
+
+static int replayKey (void)
+{
+    int key;
+
+    if ((key = ftok (".", 'r')) == -1) {
+        perror ("error on generating the replay key");
+        exit (EXIT_FAILURE);
+    }
+    return key;
+}
+
+static void turnUp (int entity)
+{
+    if (semUp (turngid, entity + 1) == -1) {
+        perror ("error on the up operation for the replay turn");
+        exit (EXIT_FAILURE);
+    }
+}
+
+/** \brief order no longer enforced: every entity waiting for its turn is let go */
+static void release (void)
+{
+    int e;
+
+    for (e = 0; e < NENTITIES; e++) {
+        turnUp (e);
+    }
+}
+
+static void diverge (const char *why)
+{
+    rl->diverged = true;
+    fprintf (stderr, "replay diverged at grant %u (entity %d): %s\n", rl->next, me, why);
+    release ();
+}
+
+/** \brief waiting for the turn of the entity; false if no grant was made in REPLAYSTALL seconds */
+static bool turnDown (void)
+{
+    struct sembuf down = { me + 1, -1, 0 };
+    struct timespec limit = { REPLAYSTALL, 0 };
+    unsigned int next = rl->next;
+
+    while (semtimedop (turngid, &down, 1, &limit) == -1) {
+        if (errno == EAGAIN) {
+            if (rl->next == next) {
+                return false;
+            }
+            next = rl->next;
+        }
+        else if (errno != EINTR) {
+            perror ("error on the down operation for the replay turn");
+            exit (EXIT_FAILURE);
+        }
+    }
+    return true;
+}
+
+static void beforeDown (int semgid, unsigned int sindex)
+{
+    GRANT *gr;
+
+    if ((semgid != maingid) || (rl->mode != REPLAY_REPLAY) || rl->diverged || rl->done) {
+        return;
+    }
+    if (!turnDown ()) {
+        if (!rl->diverged && !rl->done) {
+            diverge ("no progress");
+        }
+        return;
+    }
+    if (rl->diverged || rl->done) {
+        return;
+    }
+    gr = &rl->grant[rl->next];
+    if ((gr->entity != me) || (gr->sem != (short) sindex)) {
+        diverge ("unexpected down");
+    }
+}
+
+static void afterDown (int semgid, unsigned int sindex)
+{
+    unsigned int n;
+
+    if (semgid != maingid) {
+        return;
+    }
+    if (rl->mode == REPLAY_RECORD) {
+        if ((n = __atomic_fetch_add (&rl->nGrants, 1, __ATOMIC_SEQ_CST)) < MAXGRANTS) {
+            rl->grant[n].entity = (short) me;
+            rl->grant[n].sem = (short) sindex;
+        }
+    }
+    else if (rl->diverged || rl->done) {
+        __atomic_fetch_add (&rl->extra, 1, __ATOMIC_SEQ_CST);
+    }
+    else if ((n = ++rl->next) == rl->nGrants) {
+        rl->done = true;
+        release ();
+    }
+    else turnUp (rl->grant[n].entity);
+}
+
+/* external functions */
+
+void replayCreate (int mode, char nFic[], unsigned int *seed)
+{
+    FILE *fp;
+    char line[256];
+    int e, s, key = replayKey ();
+
+    if (((shmid = shmemCreate (key, sizeof (REPLAY_LOG))) == -1) || (shmemAttach (shmid, (void **) &rl) == -1)) {
+        perror ("error on creating the replay log");
+        exit (EXIT_FAILURE);
+    }
+    if ((turngid = semCreate (key, NENTITIES)) == -1) {
+        perror ("error on creating the replay turn semaphore set");
+        exit (EXIT_FAILURE);
+    }
+    rl->mode = mode;
+    rl->nGrants = rl->next = rl->extra = 0;
+    rl->diverged = rl->done = false;
+
+    if (mode == REPLAY_REPLAY) {
+        if ((fp = fopen (nFic, "r")) == NULL) {
+            perror ("error on opening the replay file");
+            exit (EXIT_FAILURE);
+        }
+        while ((fgets (line, sizeof (line), fp) != NULL) && (line[0] == '#'));
+        if (sscanf (line, "seed %u grants %u", seed, &rl->nGrants) != 2) {
+            fprintf (stderr, "%s: expected seed <seed> grants <count>\n", nFic);
+            exit (EXIT_FAILURE);
+        }
+        if (rl->nGrants > MAXGRANTS) {
+            fprintf (stderr, "%s: the log was truncated when recorded, it is replayed up to grant %d\n",
+                     nFic, MAXGRANTS);
+            rl->nGrants = MAXGRANTS;
+        }
+        for (s = 0; s < (int) rl->nGrants; s++) {
+            if ((fscanf (fp, "%d %hd", &e, &rl->grant[s].sem) != 2) || (e < 0) || (e >= NENTITIES)) {
+                fprintf (stderr, "%s: malformed grant %d\n", nFic, s);
+                exit (EXIT_FAILURE);
+            }
+            rl->grant[s].entity = (short) e;
+        }
+        fclose (fp);
+        if (rl->nGrants == 0) {
+            rl->done = true;
+        }
+        else turnUp (rl->grant[0].entity);
+    }
+
+    if (semSignal (turngid) == -1) {
+        perror ("error on signaling the replay turn semaphore set");
+        exit (EXIT_FAILURE);
+    }
+}
+
+void replayAttach (int semgid, int entity)
+{
+    int key = replayKey ();
+
+    if ((rl == NULL) &&
+        (((shmid = shmemConnect (key)) == -1) || (shmemAttach (shmid, (void **) &rl) == -1) ||
+         ((turngid = semConnect (key)) == -1))) {
+        perror ("error on connecting to the replay log");
+        exit (EXIT_FAILURE);
+    }
+    maingid = semgid;
+    me = entity;
+    semSetHooks (beforeDown, afterDown);
+}
+
+void replayFinish (char nFic[], unsigned int seed)
+{
+    FILE *fp;
+    unsigned int n;
+
+    semSetHooks (NULL, NULL);
+    if (rl->mode == REPLAY_RECORD) {
+        if ((fp = fopen (nFic, "w")) == NULL) {
+            perror ("error on creating the replay file");
+            exit (EXIT_FAILURE);
+        }
+        fprintf (fp, "# restaurant replay: entity (0 chef, 1 waiter, 2 receptionist, 3 main, 4+ groups) semaphore\n");
+        fprintf (fp, "seed %u grants %u\n", seed, rl->nGrants);
+        for (n = 0; (n < rl->nGrants) && (n < MAXGRANTS); n++) {
+            fprintf (fp, "%d %d\n", rl->grant[n].entity, rl->grant[n].sem);
+        }
+        if (fclose (fp) == EOF) {
+            perror ("error on writing the replay file");
+            exit (EXIT_FAILURE);
+        }
+        printf ("\nReplay: %u grants recorded to %s (seed %u)%s\n", rl->nGrants, nFic, seed,
+                (rl->nGrants > MAXGRANTS) ? ", log truncated" : "");
+    }
+    else if (rl->diverged || (rl->extra > 0) || !rl->done) {
+        printf ("\nReplay: diverged from %s after %u of %u grants\n", nFic, rl->next, rl->nGrants);
+    }
+    else printf ("\nReplay: %u grants of %s reproduced (seed %u)\n", rl->nGrants, nFic, seed);
+
+    if ((semDestroy (turngid) == -1) || (shmemDettach (rl) == -1) || (shmemDestroy (shmid) == -1)) {
+        perror ("error on destroying the replay log");
+        exit (EXIT_FAILURE);
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ *  \file replay.h (interface file)
+ *
+ *  \brief Problem name: Restaurant
+ *
+ *  \brief Record and replay of the order in which semaphores are granted.
+ *
+ *  While recording, every entity appends each <em>down</em> it completes on the semaphore set of the
+ *  problem to a shared grant log, which is saved with the random seed of the run. While replaying,
+ *  the saved log is loaded and an entity may only start a <em>down</em> when it owns the next grant
+ *  of the log (a turn semaphore per entity is used to pass the turn along), so the same interleaving
+ *  and, with the same seed, the same sequence of states is reproduced.
+ *
+ *  A replay diverges if an entity tries a <em>down</em> other than the one in the log, or if no grant
+ *  is made in REPLAYSTALL seconds. Enforcement is then dropped and the run goes on freely. Decisions
+ *  taken from the clock (arrival times used by the EARLIEST policy) are only reproduced if they follow
+ *  from the order of the grants.
+ *
+ *  Defined operations:
+ *     \li creation of the grant log (by the main program, loading it to replay)
+ *     \li attaching an entity to the grant log
+ *     \li saving or checking the grant log and destroying it.
+ */
+
+#ifndef REPLAY_H_
+#define REPLAY_H_
+
+/** \brief entity ids, used in the grant log and as the random number stream of each entity */
+#define  REPLAY_CHEF          0
+#define  REPLAY_WAITER        1
+#define  REPLAY_RECEPTIONIST  2
+#define  REPLAY_MAIN          3
+/** \brief entity id of the group of slot g is REPLAY_GROUP + g */
+#define  REPLAY_GROUP         4
+
+/**
+ *  \brief Creation of the grant log.
+ *
+ *  To be called by the main program before any entity is created. When replaying, the grant log is
+ *  loaded from the file and the random seed of the recorded run is returned.
+ *  The program is terminated if the log can not be created or the file can not be read.
+ *
+ *  \param mode REPLAY_RECORD or REPLAY_REPLAY
+ *  \param nFic name of the file of the grant log
+ *  \param seed pointer to the random seed of the run (set when replaying)
+ */
+extern void replayCreate (int mode, char nFic[], unsigned int *seed);
+
+/**
+ *  \brief Attaching an entity to the grant log.
+ *
+ *  From then on, the <em>downs</em> of the entity on the semaphore set are recorded or replayed.
+ *  The program is terminated if the grant log does not exist.
+ *
+ *  \param semgid identifier of the semaphore set of the problem
+ *  \param entity entity id (REPLAY_*)
+ */
+extern void replayAttach (int semgid, int entity);
+
+/**
+ *  \brief Saving or checking the grant log and destroying it.
+ *
+ *  To be called by the main program after all other entities terminated. A recorded log is saved to
+ *  the file; the outcome of a replay is reported.
+ *  The program is terminated if the file can not be written or the log can not be destroyed.
+ *
+ *  \param nFic name of the file of the grant log
+ *  \param seed random seed of the run
+ */
+extern void replayFinish (char nFic[], unsigned int seed);
+
+#endif /* REPLAY_H_ */
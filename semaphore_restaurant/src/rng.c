@@ -0,0 +1,109 @@
+/**
+ *  \file rng.c (implementation file)
+ *
+ *  \brief Problem name: Restaurant
+ *
+ *  \brief Random number generation.
+ *
+ *  The generator is xoshiro256** (Blackman and Vigna): 256 bits of state, a handful of shifts and
+ *  rotations per number. The state of a stream is filled by splitmix64, as its authors recommend,
+ *  started from the seed of the run and the stream number, so seeding takes constant time whatever
+ *  the number of streams (one per group that visits the restaurant).
+ *
+ *  Defined operations:
+ *     \li seeding the stream of an entity
+ *     \li sampling uniform integers and reals
+ *     \li sampling the normal and exponential distributions.
+ */
+
+#include <math.h>
+
+#include "rng.h"
+
+/* internal functions */
+
+static inline uint64_t rotl (uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+static uint64_t splitmix64 (uint64_t *x)
+{
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/* external functions */
+
+void rngSeed (RNG *r, unsigned int seed, unsigned int stream)
+{
+    uint64_t x = ((uint64_t) stream << 32) | seed;
+    int k;
+
+    for (k = 0; k < 4; k++) {
+        r->s[k] = splitmix64 (&x);
+    }
+    r->hasSpare = false;
+}
+
+uint64_t rngNext (RNG *r)
+{
+    uint64_t *s = r->s;
+    uint64_t result = rotl (s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl (s[3], 45);
+    return result;
+}
+
+double rngUniform (RNG *r)
+{
+    return (rngNext (r) >> 11) * 0x1.0p-53;
+}
+
+uint32_t rngBelow (RNG *r, uint32_t n)
+{
+    uint64_t m = (rngNext (r) >> 32) * n;                                   /* Lemire's multiply-shift */
+    uint32_t low = (uint32_t) m, limit;
+
+    if (low < n) {                                                   /* reject the biased part, rarely */
+        limit = -n % n;
+        while (low < limit) {
+            m = (rngNext (r) >> 32) * n;
+            low = (uint32_t) m;
+        }
+    }
+    return (uint32_t) (m >> 32);
+}
+
+double rngNormal (RNG *r)
+{
+    double u, v, q;
+
+    if (r->hasSpare) {
+        r->hasSpare = false;
+        return r->spare;
+    }
+    do {
+        u = 2.0 * rngUniform (r) - 1.0;
+        v = 2.0 * rngUniform (r) - 1.0;
+        q = u * u + v * v;
+    } while ((q >= 1.0) || (q == 0.0));
+    q = sqrt (-2.0 * log (q) / q);
+    r->spare = v * q;
+    r->hasSpare = true;
+    return u * q;
+}
+
+double rngExp (RNG *r, double mean)
+{
+    return -mean * log (1.0 - rngUniform (r));
+}
@@ -0,0 +1,85 @@
+/**
+ *  \file rng.h (interface file)
+ *
+ *  \brief Problem name: Restaurant
+ *
+ *  \brief Random number generation.
+ *
+ *  Each entity draws from a stream of its own, derived from the seed of the run and the entity id,
+ *  so runs are reproducible and no state (or lock) is shared between entities.
+ *
+ *  Defined operations:
+ *     \li seeding the stream of an entity
+ *     \li sampling uniform integers and reals
+ *     \li sampling the normal and exponential distributions.
+ */
+
+#ifndef RNG_H_
+#define RNG_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ *  \brief Definition of a random number stream (xoshiro256**).
+ */
+typedef struct {
+    /** \brief generator state */
+    uint64_t s[4];
+    /** \brief set if a normal sample is kept for the next call */
+    bool hasSpare;
+    /** \brief normal sample kept for the next call */
+    double spare;
+} RNG;
+
+/**
+ *  \brief Seeding a stream.
+ *
+ *  The state is derived from both numbers, streams of the same seed are unrelated.
+ *
+ *  \param r pointer to the stream
+ *  \param seed seed of the run
+ *  \param stream stream number (the entity id, or REPLAY_GROUP plus the arrival number for groups)
+ */
+extern void rngSeed (RNG *r, unsigned int seed, unsigned int stream);
+
+/**
+ *  \brief Next 64 random bits.
+ *
+ *  \param r pointer to the stream
+ */
+extern uint64_t rngNext (RNG *r);
+
+/**
+ *  \brief Uniform distribution in [0, 1).
+ *
+ *  \param r pointer to the stream
+ */
+extern double rngUniform (RNG *r);
+
+/**
+ *  \brief Uniform distribution of integers in [0, n).
+ *
+ *  \param r pointer to the stream
+ *  \param n number of values (positive)
+ */
+extern uint32_t rngBelow (RNG *r, uint32_t n);
+
+/**
+ *  \brief Normal distribution with zero mean and unit standard deviation.
+ *
+ *  Polar Box-Muller: samples come in pairs, the second one is returned by the next call.
+ *
+ *  \param r pointer to the stream
+ */
+extern double rngNormal (RNG *r);
+
+/**
+ *  \brief Exponential distribution.
+ *
+ *  \param r pointer to the stream
+ *  \param mean mean of the distribution
+ */
+extern double rngExp (RNG *r, double mean);
+
+#endif /* RNG_H_ */
@@ -0,0 +1,394 @@
+/**
+ *  \file runStats.c (implementation file)
+ *
+ *  \brief Problem name: Restaurant
+ *
+ *  Aggregation of the summaries of a batch of runs: the one-line JSON objects appended by
+ *  <tt>probSemSharedMemRestaurant -s file</tt> (see writeSummary) are read as a stream and the
+ *  distribution of every field across the runs is printed.
+ *
+ *  Upon execution, the following parameters are accepted:
+ *    \li <tt>-g field</tt> the runs are split by the value of that field (e.g. policy), one table each
+ *    \li <tt>-c</tt> the tables are written as CSV
+ *    \li names of the summary files (stdin if missing).
+ *
+ *  Numeric fields get their minimum, percentiles (nearest rank), maximum and mean; text fields (and
+ *  true/false) get the number of runs with each value. Lines that are not a flat JSON object are
+ *  skipped and counted.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include <math.h>
+#include <unistd.h>
+
+/** \brief maximum length of a summary line */
+#define  LINELEN        8192
+
+/** \brief maximum number of fields of a summary */
+#define  MAXFIELDS      64
+
+/** \brief maximum length of a key and of a text value */
+#define  KEYLEN         32
+
+/** \brief maximum number of distinct values of a text field (the rest are counted as other) */
+#define  MAXVALUES      16
+
+/** \brief maximum number of batches the runs are split in with -g */
+#define  MAXBATCHES     16
+
+/**
+ *  \brief Definition of the distribution of a field across the runs.
+ */
+typedef struct {
+    /** \brief name of the field */
+    char key[KEYLEN];
+    /** \brief set for a text field */
+    bool text;
+    /** \brief values of a numeric field, their number and the size of the array */
+    double *v;
+    size_t n, cap;
+    /** \brief distinct values of a text field, the number of runs with each and with any other */
+    char val[MAXVALUES][KEYLEN];
+    unsigned long count[MAXVALUES];
+    int nVal;
+    unsigned long other;
+} FIELD;
+
+/**
+ *  \brief Definition of a batch of runs (all runs, or those with a value of the -g field).
+ */
+typedef struct {
+    /** \brief value of the -g field */
+    char name[KEYLEN];
+    /** \brief number of runs */
+    unsigned long runs;
+    /** \brief fields, in the order they were first seen */
+    FIELD field[MAXFIELDS];
+    int nFields;
+} BATCH;
+
+/**
+ *  \brief Definition of a field of a summary line, as parsed.
+ */
+typedef struct {
+    char key[KEYLEN];
+    bool text;
+    double num;
+    char str[KEYLEN];
+} ITEM;
+
+/** \brief batches */
+static BATCH batch[MAXBATCHES];
+static int nBatches;
+
+/** \brief field the runs are split by (NULL for a single batch) */
+static const char *groupBy;
+
+/** \brief number of lines skipped (malformed, or of a batch beyond MAXBATCHES) */
+static unsigned long skipped;
+
+/* internal functions */
+
+/** \brief skipping blanks */
+static const char *blanks (const char *p)
+{
+    while (isspace ((unsigned char) *p)) {
+        p++;
+    }
+    return p;
+}
+
+/** \brief parsing a JSON string (no escapes other than \" and \\), truncated to KEYLEN; NULL if malformed */
+static const char *parseString (const char *p, char out[])
+{
+    int n = 0;
+
+    if (*p++ != '"') {
+        return NULL;
+    }
+    while ((*p != '"') && (*p != '\0')) {
+        if ((*p == '\\') && (p[1] != '\0')) {
+            p++;
+        }
+        if (n < KEYLEN - 1) {
+            out[n++] = *p;
+        }
+        p++;
+    }
+    out[n] = '\0';
+    return (*p == '"') ? p + 1 : NULL;
+}
+
+/** \brief parsing a summary line into its fields; returns the number of fields or -1 if malformed */
+static int parseLine (const char *p, ITEM item[])
+{
+    int n = 0;
+    char *end;
+
+    p = blanks (p);
+    if (*p++ != '{') {
+        return -1;
+    }
+    p = blanks (p);
+    if (*p == '}') {
+        return 0;
+    }
+    while (true) {
+        ITEM it;
+
+        if (((p = parseString (blanks (p), it.key)) == NULL) || (*(p = blanks (p)) != ':')) {
+            return -1;
+        }
+        p = blanks (p + 1);
+        if (*p == '"') {
+            it.text = true;
+            if ((p = parseString (p, it.str)) == NULL) {
+                return -1;
+            }
+        }
+        else if ((strncmp (p, "true", 4) == 0) || (strncmp (p, "false", 5) == 0)) {
+            it.text = true;
+            strcpy (it.str, (*p == 't') ? "true" : "false");
+            p += (*p == 't') ? 4 : 5;
+        }
+        else if (strncmp (p, "null", 4) == 0) {
+            p += 4;
+            it.key[0] = '\0';                                                                  /* not recorded */
+        }
+        else {
+            it.text = false;
+            it.num = strtod (p, &end);
+            if (end == p) {
+                return -1;
+            }
+            p = end;
+        }
+        if ((it.key[0] != '\0') && (n < MAXFIELDS)) {
+            item[n++] = it;
+        }
+        p = blanks (p);
+        if (*p == '}') {
+            return n;
+        }
+        if (*p++ != ',') {
+            return -1;
+        }
+    }
+}
+
+/** \brief batch of the runs with a value of the -g field (NULL if there are too many batches) */
+static BATCH *findBatch (const char *name)
+{
+    int b;
+
+    for (b = 0; b < nBatches; b++) {
+        if (strcmp (batch[b].name, name) == 0) {
+            return &batch[b];
+        }
+    }
+    if (nBatches == MAXBATCHES) {
+        return NULL;
+    }
+    strcpy (batch[nBatches].name, name);
+    return &batch[nBatches++];
+}
+
+/** \brief field of a batch (NULL if there are too many fields) */
+static FIELD *findField (BATCH *bt, ITEM *it)
+{
+    FIELD *f;
+    int i;
+
+    for (i = 0; i < bt->nFields; i++) {
+        if (strcmp (bt->field[i].key, it->key) == 0) {
+            return &bt->field[i];
+        }
+    }
+    if (bt->nFields == MAXFIELDS) {
+        return NULL;
+    }
+    f = &bt->field[bt->nFields++];
+    strcpy (f->key, it->key);
+    f->text = it->text;
+    return f;
+}
+
+/** \brief adding the value of a field of a run */
+static void addValue (FIELD *f, ITEM *it)
+{
+    int i;
+
+    if (f->text) {
+        for (i = 0; i < f->nVal; i++) {
+            if (strcmp (f->val[i], it->str) == 0) {
+                break;
+            }
+        }
+        if (i < f->nVal) {
+            f->count[i] += 1;
+        }
+        else if (f->nVal < MAXVALUES) {
+            strcpy (f->val[f->nVal], it->str);
+            f->count[f->nVal++] = 1;
+        }
+        else f->other += 1;
+        return;
+    }
+    if (f->n == f->cap) {
+        f->cap = (f->cap == 0) ? 1024 : 2 * f->cap;
+        if ((f->v = realloc (f->v, f->cap * sizeof (double))) == NULL) {
+            perror ("error on allocating the values of a field");
+            exit (EXIT_FAILURE);
+        }
+    }
+    f->v[f->n++] = it->num;
+}
+
+/** \brief adding a summary line */
+static void addLine (const char *line)
+{
+    static ITEM item[MAXFIELDS];
+    const char *name = "all";
+    BATCH *bt;
+    FIELD *f;
+    int n, i;
+
+    if ((n = parseLine (line, item)) <= 0) {
+        skipped += (*blanks (line) != '\0');                                           /* blank lines are fine */
+        return;
+    }
+    if (groupBy != NULL) {
+        name = "-";
+        for (i = 0; i < n; i++) {
+            if (item[i].text && (strcmp (item[i].key, groupBy) == 0)) {
+                name = item[i].str;
+            }
+        }
+    }
+    if ((bt = findBatch (name)) == NULL) {
+        skipped += 1;
+        return;
+    }
+    bt->runs += 1;
+    for (i = 0; i < n; i++) {
+        if (((f = findField (bt, &item[i])) != NULL) && (f->text == item[i].text)) {
+            addValue (f, &item[i]);
+        }
+    }
+}
+
+/** \brief comparison of two values, for sorting */
+static int cmpValue (const void *a, const void *b)
+{
+    double x = *(const double *) a, y = *(const double *) b;
+
+    return (x > y) - (x < y);
+}
+
+/** \brief percentile (nearest rank) of sorted values */
+static double percentile (double v[], size_t n, double p)
+{
+    size_t r = (size_t) ceil (p / 100.0 * n);
+
+    return v[(r > 0) ? r - 1 : 0];
+}
+
+/** \brief printing the distributions of a batch */
+static void printBatch (BATCH *bt, bool csv)
+{
+    FIELD *f;
+    double sum;
+    size_t k;
+    int i, j;
+
+    if (!csv) {
+        printf ("\n%s%s%s: %lu runs\n", (groupBy != NULL) ? groupBy : "", (groupBy != NULL) ? "=" : "", bt->name, bt->runs);
+        printf ("%-22s %8s %10s %10s %10s %10s %10s %10s\n", "field", "runs", "min", "p50", "p90", "p99", "max", "mean");
+    }
+    for (i = 0; i < bt->nFields; i++) {
+        f = &bt->field[i];
+        if (f->text) {
+            if (csv) {
+                for (j = 0; j < f->nVal; j++) {
+                    printf ("%s,%s=%s,%lu,,,,,,\n", bt->name, f->key, f->val[j], f->count[j]);
+                }
+                if (f->other > 0) {
+                    printf ("%s,%s=other,%lu,,,,,,\n", bt->name, f->key, f->other);
+                }
+                continue;
+            }
+            printf ("%-22s", f->key);
+            for (j = 0; j < f->nVal; j++) {
+                printf ("%s %s %lu", (j > 0) ? "," : "", f->val[j], f->count[j]);
+            }
+            if (f->other > 0) {
+                printf (", other %lu", f->other);
+            }
+            printf ("\n");
+            continue;
+        }
+        qsort (f->v, f->n, sizeof (double), cmpValue);
+        for (sum = 0.0, k = 0; k < f->n; k++) {
+            sum += f->v[k];
+        }
+        printf (csv ? "%s,%s,%zu,%g,%g,%g,%g,%g,%g\n" : "%.0s%-22s %8zu %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+                bt->name, f->key, f->n, f->v[0], percentile (f->v, f->n, 50.0), percentile (f->v, f->n, 90.0),
+                percentile (f->v, f->n, 99.0), f->v[f->n - 1], sum / f->n);
+    }
+}
+
+/**
+ *  \brief Main program.
+ */
+int main (int argc, char *argv[])
+{
+    static char line[LINELEN];
+    bool csv = false;
+    FILE *fp;
+    int opt, b, a;
+
+    while ((opt = getopt (argc, argv, "cg:")) != -1) {
+        if (opt == 'c') {
+            csv = true;
+        }
+        else if (opt == 'g') {
+            groupBy = optarg;
+        }
+        else {
+            fprintf (stderr, "USAGE: %s [-c] [-g «field»] [«summary file» ...]\n", argv[0]);
+            exit (EXIT_FAILURE);
+        }
+    }
+
+    for (a = optind; (a < argc) || (a == optind); a++) {
+        if (a == argc) {
+            fp = stdin;
+        }
+        else if ((fp = fopen (argv[a], "r")) == NULL) {
+            perror ("error on opening the summary file");
+            exit (EXIT_FAILURE);
+        }
+        while (fgets (line, LINELEN, fp) != NULL) {
+            addLine (line);
+        }
+        if (fp != stdin) {
+            fclose (fp);
+        }
+    }
+
+    if (csv) {
+        printf ("batch,field,runs,min,p50,p90,p99,max,mean\n");
+    }
+    for (b = 0; b < nBatches; b++) {
+        printBatch (&batch[b], csv);
+    }
+    if (skipped > 0) {
+        fprintf (stderr, "%lu lines skipped: not a run summary\n", skipped);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,292 @@
+/**
+ *  \file semBench.c (implementation file)
+ *
+ *  \brief Problem name: Restaurant
+ *
+ *  Microbenchmark of the semaphore operations of semaphore.c, with whatever implementation it is built.
+ *
+ *  Upon execution, two optional parameters are accepted:
+ *    \li number of iterations of each test (100000 by default)
+ *    \li number of processes of the contended test (4 by default).
+ *
+ *  Tests:
+ *    \li uncontended: cost of a down and an up of a free semaphore by a single process
+ *    \li ping-pong: latency of handing a semaphore over to another process and back (reported per handoff)
+ *    \li contended: throughput of down/up pairs of N processes sharing a mutex.
+ *
+ *  Ping-pong and contended tests are run with the processes pinned to pairs of logical CPUs read from
+ *  <tt>/sys/devices/system/cpu</tt>: the same CPU, hyperthread siblings, two cores of a socket and two
+ *  sockets. Placements that the machine (or the allowed CPU set) does not have are skipped.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/ipc.h>
+#include <sys/wait.h>
+
+#include "semaphore.h"
+
+/** \brief semaphore implementation the program was built with */
+#ifndef   SEMBACKEND
+#define   SEMBACKEND         "semaphore"
+#endif
+
+/** \brief semaphore ids */
+#define   PING               1
+#define   PONG               2
+#define   START              3
+
+/**
+ *  \brief Definition of a placement of the two processes of a test.
+ */
+typedef struct {
+    /** \brief placement name */
+    char *name;
+    /** \brief CPU of the first process (-1 if the machine does not have this placement) */
+    int cpuA;
+    /** \brief CPU of the second process */
+    int cpuB;
+} PLACEMENT;
+
+/** \brief semaphore set access identifier */
+static int semgid;
+
+/** \brief CPUs the benchmark may use */
+static cpu_set_t allowed;
+
+/* internal functions */
+
+/** \brief monotonic time (ns) */
+static long long nowNs (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/** \brief topology attribute of a CPU (-1 if unknown) */
+static int topology (int cpu, char *attr)
+{
+    char path[128];
+    FILE *fp;
+    int v = -1;
+
+    sprintf (path, "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, attr);
+    if ((fp = fopen (path, "r")) != NULL) {
+        if (fscanf (fp, "%d", &v) != 1) {
+            v = -1;
+        }
+        fclose (fp);
+    }
+    return v;
+}
+
+/** \brief pinning the calling process to a CPU */
+static void pin (int cpu)
+{
+    cpu_set_t set;
+
+    CPU_ZERO (&set);
+    CPU_SET (cpu, &set);
+    if (sched_setaffinity (0, sizeof (set), &set) == -1) {
+        perror ("error on setting the CPU affinity");
+        exit (EXIT_FAILURE);
+    }
+}
+
+/** \brief finding the placements of the machine */
+static void findPlacements (PLACEMENT pl[], int n)
+{
+    int a = -1, cpu, i;
+
+    if (sched_getaffinity (0, sizeof (allowed), &allowed) == -1) {
+        perror ("error on getting the CPU affinity");
+        exit (EXIT_FAILURE);
+    }
+    for (cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET (cpu, &allowed)) {
+            continue;
+        }
+        if (a == -1) {
+            a = cpu;
+            pl[0].cpuA = pl[0].cpuB = cpu;                                                         /* same CPU */
+            continue;
+        }
+        if (topology (cpu, "physical_package_id") != topology (a, "physical_package_id")) {
+            i = 3;                                                                               /* cross-socket */
+        }
+        else if (topology (cpu, "core_id") == topology (a, "core_id")) {
+            i = 1;                                                                        /* hyperthread sibling */
+        }
+        else i = 2;                                                                                /* cross-core */
+        if ((i < n) && (pl[i].cpuA == -1)) {
+            pl[i].cpuA = a;
+            pl[i].cpuB = cpu;
+        }
+    }
+}
+
+/** \brief creation of a process pinned to a CPU, that runs a test body and exits */
+static int spawn (int cpu, void (*body) (int), int iter)
+{
+    int pid;
+
+    if ((pid = fork ()) < 0) {
+        perror ("error on the fork operation");
+        exit (EXIT_FAILURE);
+    }
+    if (pid == 0) {
+        pin (cpu);
+        body (iter);
+        _exit (EXIT_SUCCESS);                                          /* the buffered output belongs to the parent */
+    }
+    return pid;
+}
+
+/** \brief down and up of a semaphore, exiting on error */
+static void down (int sem)
+{
+    if (semDown (semgid, sem) == -1) {
+        perror ("error on the down operation for semaphore access");
+        exit (EXIT_FAILURE);
+    }
+}
+
+static void up (int sem)
+{
+    if (semUp (semgid, sem) == -1) {
+        perror ("error on the up operation for semaphore access");
+        exit (EXIT_FAILURE);
+    }
+}
+
+/** \brief second process of ping-pong: returns every ping */
+static void pong (int iter)
+{
+    int i;
+
+    for (i = 0; i < iter; i++) {
+        down (PING);
+        up (PONG);
+    }
+}
+
+/** \brief process of the contended test: down/up pairs on the mutex once started */
+static void contender (int iter)
+{
+    int i;
+
+    down (START);
+    for (i = 0; i < iter; i++) {
+        down (PING);
+        up (PING);
+    }
+}
+
+/** \brief ping-pong: latency of a handoff (ns) */
+static double pingPong (PLACEMENT *p, int iter)
+{
+    long long t;
+    int i, pid;
+
+    pin (p->cpuA);
+    pid = spawn (p->cpuB, pong, iter);
+    t = nowNs ();
+    for (i = 0; i < iter; i++) {
+        up (PING);
+        down (PONG);
+    }
+    t = nowNs () - t;
+    waitpid (pid, NULL, 0);
+    return (double) t / (2.0 * iter);
+}
+
+/** \brief contended: down/up pairs per second of nProc processes spread over the placement */
+static double contended (PLACEMENT *p, int iter, int nProc)
+{
+    long long t;
+    int i;
+
+    up (PING);                                                                                      /* free mutex */
+    for (i = 0; i < nProc; i++) {
+        spawn ((i % 2) ? p->cpuB : p->cpuA, contender, iter);
+    }
+    t = nowNs ();
+    for (i = 0; i < nProc; i++) {
+        up (START);
+    }
+    for (i = 0; i < nProc; i++) {
+        wait (NULL);
+    }
+    t = nowNs () - t;
+    down (PING);
+    return 1e9 * nProc * iter / t;
+}
+
+/**
+ *  \brief Main program.
+ */
+int main (int argc, char *argv[])
+{
+    PLACEMENT pl[] = { { "same-cpu", -1, -1 }, { "sibling-HT", -1, -1 }, { "cross-core", -1, -1 },
+                       { "cross-socket", -1, -1 } };
+    int n = sizeof (pl) / sizeof (pl[0]);
+    int iter = 100000, nProc = 4, i;
+    long long t;
+
+    if (argc > 1) {
+        iter = atoi (argv[1]);
+    }
+    if (argc > 2) {
+        nProc = atoi (argv[2]);
+    }
+    if ((argc > 3) || (iter < 1) || (nProc < 1)) {
+        fprintf (stderr, "USAGE: %s [«iterations» [«contending processes»]]\n", argv[0]);
+        exit (EXIT_FAILURE);
+    }
+
+    findPlacements (pl, n);
+    if ((semgid = semCreate (IPC_PRIVATE, START)) == -1) {
+        perror ("error on creating the semaphore set");
+        exit (EXIT_FAILURE);
+    }
+
+    printf ("backend %s, %d iterations\n", SEMBACKEND, iter);
+
+    pin (pl[0].cpuA);
+    up (PING);
+    t = nowNs ();
+    for (i = 0; i < iter; i++) {
+        down (PING);
+        up (PING);
+    }
+    t = nowNs () - t;
+    down (PING);
+    printf ("uncontended down+up: %.1f ns\n\n", (double) t / iter);
+
+    printf ("%-14s %9s %18s %14s%d\n", "placement", "cpus", "ping-pong (ns)", "contended x", nProc);
+    for (i = 0; i < n; i++) {
+        if (pl[i].cpuA == -1) {
+            printf ("%-14s %9s %18s\n", pl[i].name, "-", "skipped (not available)");
+            continue;
+        }
+        printf ("%-14s %4d,%-4d %18.1f", pl[i].name, pl[i].cpuA, pl[i].cpuB, pingPong (&pl[i], iter));
+        printf (" %14.0f down+up/s\n", contended (&pl[i], iter, nProc));
+    }
+
+    if (semDestroy (semgid) == -1) {
+        perror ("error on destructing the semaphore set");
+        exit (EXIT_FAILURE);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -9,6 +9,14 @@
  *  Definition of the operations carried out by the chef:
  *     \li waitForOrder
  *     \li processOrder
+ *     \li runKitchen.
+ *
+ *  With no kitchen stations, the chef cooks one order at a time, for a random time. With stations
+ *  (<tt>#stations</tt> and <tt>#menu</tt>), each order is made of a dish per person and the chef runs a
+ *  scheduler: it keeps taking orders while their dishes are cooked, each station type cooks its queue
+ *  of dishes in order of arrival, as many at once as its capacity, and an order is handed to the waiter
+ *  when its last dish is done. The time each station type cooked and the time dishes waited for it
+ *  tell which station is the bottleneck.
  *
  *  \author Nuno Lau - December 2023
  */
@@ -30,6 +38,11 @@
 #include "sharedDataSync.h"
 #include "semaphore.h"
 #include "sharedMemory.h"
+#include "replay.h"
+#include "statistics.h"
+#include "events.h"
+#include "rng.h"
+#include "jitter.h"
 
 
 /** \brief logging file name */
@@ -47,8 +60,48 @@ static int lastGroup;
 /** \brief pointer to shared memory region */
 static SHARED_DATA *sh;
 
-static void waitForOrder ();
+/** \brief random number stream of the entity */
+static RNG rng;
+
+/**
+ *  \brief Definition of a dish in the kitchen.
+ */
+typedef struct {
+    /** \brief group that ordered it (-1 if the entry is free) */
+    int group;
+    /** \brief station type it is cooked on */
+    int station;
+    /** \brief cooking time (us) */
+    long long time;
+    /** \brief time at which it was queued, and at which it is done once cooking (us) */
+    long long since;
+    /** \brief set while it is cooking */
+    bool cooking;
+    /** \brief next dish in the queue of its station type (-1 if last) */
+    int next;
+} DISH;
+
+/** \brief dishes in the kitchen */
+static DISH dish[KITCHENDISHES];
+
+/** \brief first and last dish of the queue of each station type (-1 if empty), and its length */
+static int queueHead[MAXSTATIONS], queueTail[MAXSTATIONS], queueLen[MAXSTATIONS];
+
+/** \brief number of dishes each station type is cooking */
+static int cooking[MAXSTATIONS];
+
+/** \brief number of dishes of the order of each group not yet done, and the time it was taken (us) */
+static int dishesLeft[MAXGROUPS];
+static long long orderTaken[MAXGROUPS];
+
+/** \brief number of dishes in the kitchen */
+static int nDishes;
+
+static bool waitForOrder ();
+static bool receiveOrder ();
 static void processOrder ();
+static void deliverOrder (int group);
+static void runKitchen ();
 
 /**
  *  \brief Main program.
@@ -59,6 +112,7 @@ int main (int argc, char *argv[])
 {
     int key;                                          /*access key to shared memory and semaphore set */
     char *tinp;                                                     /* numerical parameters test flag */
+    long long gate;                                    /* time blocked waiting for the start of operations */
 
     /* validation of command line parameters */
 
@@ -80,10 +134,12 @@ int main (int argc, char *argv[])
 
     /* connection to the semaphore set and the shared memory region and mapping the shared region onto the
        process address space */
+    gate = timeNow ();
     if ((semgid = semConnect (key)) == -1) { 
         perror ("error on connecting to the semaphore set");
         return EXIT_FAILURE;
     }
+    gate = timeNow () - gate;
     if ((shmid = shmemConnect (key)) == -1) { 
         perror ("error on connecting to the shared memory region");
         return EXIT_FAILURE;
@@ -93,17 +149,28 @@ int main (int argc, char *argv[])
         return EXIT_FAILURE;
     }
 
-    /* initialize random generator */
-    srandom ((unsigned int) getpid ());                                      
+    /* initialize random generator (stream of the entity, from the seed of the run) and the record or
+       replay of grants */
+    rngSeed (&rng, sh->fSt.seed, REPLAY_CHEF);
+    if (sh->fSt.replay != REPLAY_OFF) {
+        replayAttach (semgid, REPLAY_CHEF);
+    }
+    jitterStart (&sh->fSt, REPLAY_CHEF);
+    if (sh->fSt.semTiming) {
+        semTimingStart (&sh->fSt, semgid);
+    }
+    if (sh->fSt.groupHosts > 0) {
+        semSetNotify (semgid, sh->fSt.semNotify, SEM_NU + 1, GROUPHOST);
+    }
+    startupRecord (&sh->fSt, SRV_CHEF, sh->fSt.serverSpawn[SRV_CHEF], gate);
 
     /* simulation of the life cycle of the chef */
 
-    int nOrders=0;
-    while(nOrders < sh->fSt.nGroups) {
-       waitForOrder();
+    if (sh->fSt.kitchen.nStations > 0) {
+       runKitchen();
+    }
+    else while(waitForOrder()) {
        processOrder();
-
-       nOrders++;
     }
 
     /* unmapping the shared region off the process address space */
@@ -122,15 +189,35 @@ int main (int argc, char *argv[])
  *  The chef waits for the food request that will be provided by the waiter.
  *  Updates its state and saves internal state.
  *  Received order should be acknowledged.
+ *  An order for no group (-1) means the restaurant is closing: it is not acknowledged.
+ *
+ *  \return true if an order was received, false if the restaurant is closing
  */
-static void waitForOrder ()
+static bool waitForOrder ()
 {
+    long long waitStart = timeNow ();                                  /* time at which waiting for an order */
+
     // Wait for the waiter to signal that an order is ready to be processed
     if (semDown(semgid, sh->waitOrder) == -1) {
         perror("error on the down operation for waiter order semaphore (CH)");
         exit(EXIT_FAILURE);
     }
+    wakeupRecord (&sh->fSt, SRV_CHEF, waitStart);
+
+    return receiveOrder();
+}
 
+/**
+ *  \brief chef takes the food order it was signalled.
+ *
+ *  Updates its state and saves internal state.
+ *  Received order should be acknowledged.
+ *  An order for no group (-1) means the restaurant is closing: it is not acknowledged.
+ *
+ *  \return true if an order was received, false if the restaurant is closing
+ */
+static bool receiveOrder ()
+{
     // Enter critical region
     if (semDown(semgid, sh->mutex) == -1) {
         perror("error on the down operation for semaphore access (CH)");
@@ -139,6 +226,13 @@ static void waitForOrder ()
 
     // Update the last group and reset the order received flag
     lastGroup = sh->fSt.foodGroup;
+    if (lastGroup == -1) {
+        if (semUp(semgid, sh->mutex) == -1) {
+            perror("error on the up operation for semaphore access (CH)");
+            exit(EXIT_FAILURE);
+        }
+        return false;
+    }
 
     // Update the chef's state to COOK
     sh->fSt.st.chefStat = COOK;
@@ -155,46 +249,71 @@ static void waitForOrder ()
         perror("error on the up operation for semaphore access (CH)");
         exit(EXIT_FAILURE);
     }
+
+    return true;
 }
 
 /**
  *  \brief chef cooks, then delivers the food to the waiter 
  *
- *  The chef takes some time to cook and signals the waiter that food is 
- *  ready (this may only happen when waiter is available)
- *  then updates its state.
+ *  The chef takes some time to cook and adds the group to the list of ready orders.
+ *  If no FOODREADY notification is pending, the waiter is signaled that food is 
+ *  ready; otherwise the pending notification already covers this order and the waiter
+ *  takes it in the same trip. The notification does not use the request slot shared
+ *  with the groups, so the chef never waits for the waiter (who may be waiting for the
+ *  chef to acknowledge a new order).
+ *  The chef then updates its state.
  *  The internal state should be saved.
  */
 static void processOrder ()
 {   
     // Simulate cooking time
-    int cookTime = (random() % MAXCOOK) + 100;  // Assuming MAXCOOK is defined
+    int cookTime = rngBelow(&rng, MAXCOOK) + 100;  // Assuming MAXCOOK is defined
     usleep(cookTime * 1000);  // usleep takes microseconds
 
-    // Wait for the waiter to be available to receive the food
-    if (semDown(semgid, sh->waiterRequestPossible) == -1) {
-        perror("error on the down operation for waiter request semaphore (CH)");
-        exit(EXIT_FAILURE);
-    }
+    deliverOrder(lastGroup);
+}
 
+/**
+ *  \brief chef delivers the food of a group to the waiter
+ *
+ *  The group is added to the list of ready orders and the waiter is notified, unless a
+ *  notification is pending (see processOrder). The chef waits for orders again if the
+ *  kitchen is empty, otherwise it keeps cooking.
+ *  The internal state should be saved.
+ *
+ *  \param group group whose food is ready
+ */
+static void deliverOrder (int group)
+{
     // Enter critical region
     if (semDown(semgid, sh->mutex) == -1) {
         perror("error on the down operation for semaphore access (CH)");
         exit(EXIT_FAILURE);
     }
 
-    // Update the order to indicate it's ready
-    sh->fSt.waiterRequest.reqType = FOODREADY;
-    sh->fSt.waiterRequest.reqGroup = lastGroup;
-
-    // Notify the waiter that the food is ready
-    if (semUp(semgid, sh->waiterRequest) == -1) {
-        perror("error on the up operation for waiter request semaphore (CH)");
-        exit(EXIT_FAILURE);
+    // Add the group to the ready orders, only the first one needs a new notification
+    sh->fSt.foodReady[sh->fSt.nFoodReady++] = group;
+    if (!sh->fSt.foodReadyPending) {
+        sh->fSt.foodReadyPending = true;
+
+        // Notify the waiter that the food is ready
+        jitterAt(JIT_REQUEST);
+        sh->fSt.wakeupStamp[SRV_WAITER] = timeNow ();
+        if (sh->fSt.eventLoop) {
+            if (eventPost(sh->fSt.eventFd[EV_FOODREADY]) == -1) {
+                perror("error on posting the food ready event (CH)");
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (semUp(semgid, sh->waiterRequest) == -1) {
+            perror("error on the up operation for waiter request semaphore (CH)");
+            exit(EXIT_FAILURE);
+        }
     }
 
-    // Update the chef's state to WAIT_FOR_ORDER
-    sh->fSt.st.chefStat = WAIT_FOR_ORDER;
+    // Update the chef's state to WAIT_FOR_ORDER, unless other dishes are in the kitchen
+    sh->fSt.st.chefStat = (nDishes > 0) ? COOK : WAIT_FOR_ORDER;
     saveState(nFic, &sh->fSt);
 
     // Exit critical region
@@ -203,3 +322,169 @@ static void processOrder ()
         exit(EXIT_FAILURE);
     }
 }
+
+/**
+ *  \brief chef starts cooking the dishes at the head of the queues, on the free units of their stations
+ *
+ *  \param now current time (us)
+ */
+static void startDishes (long long now)
+{
+    KITCHEN *k = &sh->fSt.kitchen;
+    int st, d;
+
+    for (st = 0; st < k->nStations; st++) {
+        while ((cooking[st] < k->stationCapacity[st]) && ((d = queueHead[st]) != -1)) {
+            queueHead[st] = dish[d].next;
+            queueLen[st] -= 1;
+            histAdd (&k->stationWait[st], now - dish[d].since);
+            dish[d].cooking = true;
+            dish[d].since = now + dish[d].time;
+            cooking[st] += 1;
+        }
+    }
+}
+
+/**
+ *  \brief chef splits the order of a group into dishes and queues them on their stations
+ *
+ *  Each person of the group orders a dish of the menu, drawn at random, and its cooking time is
+ *  drawn uniformly between the shortest and the longest of the dish.
+ *
+ *  \param group group that ordered
+ *  \param now current time (us)
+ */
+static void queueOrder (int group, long long now)
+{
+    KITCHEN *k = &sh->fSt.kitchen;
+    int n, m, d = 0, st;
+
+    dishesLeft[group] = sh->fSt.groupSize[group];
+    orderTaken[group] = now;
+    for (n = 0; n < sh->fSt.groupSize[group]; n++) {
+        while ((d < KITCHENDISHES) && (dish[d].group != -1)) {
+            d++;
+        }
+        if (d == KITCHENDISHES) {
+            fprintf (stderr, "More than KITCHENDISHES dishes in the kitchen!\n");
+            exit (EXIT_FAILURE);
+        }
+        m = rngBelow (&rng, k->nDishes);
+        st = k->dishStation[m];
+        dish[d].group = group;
+        dish[d].station = st;
+        dish[d].time = 1000LL * (k->dishMin[m] + rngBelow (&rng, k->dishMax[m] - k->dishMin[m] + 1));
+        dish[d].since = now;
+        dish[d].cooking = false;
+        dish[d].next = -1;
+        if (queueHead[st] == -1) {
+            queueHead[st] = d;
+        }
+        else dish[queueTail[st]].next = d;
+        queueTail[st] = d;
+        queueLen[st] += 1;
+        if (queueLen[st] > k->stationQueueMax[st]) {
+            k->stationQueueMax[st] = queueLen[st];
+        }
+        nDishes += 1;
+    }
+}
+
+/**
+ *  \brief chef takes the dishes that are done off their stations, and delivers the orders completed
+ *
+ *  \param now current time (us)
+ */
+static void finishDishes (long long now)
+{
+    KITCHEN *k = &sh->fSt.kitchen;
+    int d, g;
+
+    for (d = 0; d < KITCHENDISHES; d++) {
+        if ((dish[d].group == -1) || !dish[d].cooking || (dish[d].since > now)) {
+            continue;
+        }
+        g = dish[d].group;
+        k->stationBusy[dish[d].station] += dish[d].time;
+        k->stationDishes[dish[d].station] += 1;
+        cooking[dish[d].station] -= 1;
+        dish[d].group = -1;
+        nDishes -= 1;
+        if (--dishesLeft[g] == 0) {
+            histAdd (&k->orderTime, now - orderTaken[g]);
+            deliverOrder (g);
+        }
+    }
+}
+
+/**
+ *  \brief time at which the next dish being cooked is done
+ *
+ *  \return time (us), 0 if no dish is cooking
+ */
+static long long nextDone ()
+{
+    long long next = 0;
+    int d;
+
+    for (d = 0; d < KITCHENDISHES; d++) {
+        if ((dish[d].group != -1) && dish[d].cooking && ((next == 0) || (dish[d].since < next))) {
+            next = dish[d].since;
+        }
+    }
+    return next;
+}
+
+/**
+ *  \brief chef runs the kitchen until the restaurant closes
+ *
+ *  The chef waits for an order, no longer than until the next dish is done: orders are taken
+ *  (see receiveOrder) and split into dishes, the dishes that are done are taken off their
+ *  stations, orders whose last dish is done are delivered (see deliverOrder) and the free units
+ *  start cooking the dishes queued for them. The time at which the next dish is done is kept in
+ *  the shared region, the watchdog of the main program takes the chef as busy until then.
+ */
+static void runKitchen ()
+{
+    bool open = true;
+    long long waitStart, next;
+    int st, d, r;
+
+    for (d = 0; d < KITCHENDISHES; d++) {
+        dish[d].group = -1;
+    }
+    for (st = 0; st < MAXSTATIONS; st++) {
+        queueHead[st] = queueTail[st] = -1;
+    }
+
+    while (open || (nDishes > 0)) {
+        waitStart = timeNow ();
+        next = nextDone ();
+        __atomic_store_n (&sh->fSt.kitchen.nextDone, next, __ATOMIC_RELAXED);
+        if (next == 0) {
+            // Nothing is cooking, wait for the waiter to signal an order
+            r = semDown(semgid, sh->waitOrder);
+        }
+        else if (next > waitStart) {
+            // Dishes are cooking, wait for an order no longer than until the next one is done
+            r = semTimedDown(semgid, sh->waitOrder, next - waitStart);
+        }
+        else {
+            r = -1;
+            errno = EAGAIN;
+        }
+        if (r == 0) {
+            wakeupRecord (&sh->fSt, SRV_CHEF, waitStart);
+            if ((open = receiveOrder())) {
+                queueOrder (lastGroup, timeNow ());
+            }
+        }
+        else if ((errno != EAGAIN) && (errno != EINTR)) {
+            perror("error on the down operation for waiter order semaphore (CH)");
+            exit(EXIT_FAILURE);
+        }
+        finishDishes (timeNow ());
+        startDishes (timeNow ());
+    }
+    __atomic_store_n (&sh->fSt.kitchen.nextDone, 0, __ATOMIC_RELAXED);
+}
@@ -9,11 +9,31 @@
  *  Definition of the operations carried out by the groups:
  *     \li goToRestaurant
  *     \li checkInAtReception
+ *     \li waitForTable
  *     \li orderFood
  *     \li waitFood
  *     \li eat
  *     \li checkOutAtReception
  *
+ *  The program either runs one group or, with <tt>-h</tt>, hosts the groups of every slot s with
+ *  s % groupHosts == host as coroutines with stacks of their own (ucontext). A down that would block,
+ *  the wait for a notice and the sleeps of a group are then yield points: the host resumes the other
+ *  groups, and blocks on its own semaphore only when none of them can run (see semSetYield,
+ *  semSetNotify and notice.h). Hosted groups have no semaphores of their own, so a host may run
+ *  thousands of them.
+ *
+ *  With <tt>#launch FORKSERVER</tt>, the program started with <tt>-h</tt> is instead a template: it forks a
+ *  process for each group placed in a slot, which runs the group at once, already attached to the shared
+ *  region and connected to the semaphore sets. The template hands back the slots of the processes that
+ *  failed, and exits with a non-zero status if any did.
+ *
+ *  When the waiter and the receptionist run event loops, requests are queued and the channel of the
+ *  server is posted (see events.h); the request slots and their semaphores are not used.
+ *
+ *  A group restored from a checkpoint resumes its life cycle in the state it was in when the state of
+ *  the run was saved: going to the restaurant or eating, until its saved wake time, or waiting for a
+ *  table (see checkpoint.h).
+ *
  *  \author Nuno Lau - December 2023
  */
 
@@ -24,6 +44,9 @@
 #include <sys/types.h>
 #include <string.h>
 #include <math.h>
+#include <errno.h>
+#include <ucontext.h>
+#include <sys/wait.h>
 
 #include "probConst.h"
 #include "probDataStruct.h"
@@ -31,6 +54,40 @@
 #include "sharedDataSync.h"
 #include "semaphore.h"
 #include "sharedMemory.h"
+#include "replay.h"
+#include "rng.h"
+#include "statistics.h"
+#include "events.h"
+#include "jitter.h"
+#include "notice.h"
+
+/** \brief coroutine states */
+#define  CO_FREE            0                                                                      /* no group */
+#define  CO_READY           1                                                                /* to be resumed */
+#define  CO_SLEEPING        2                                                    /* sleeps until its wake time */
+#define  CO_BLOCKED         3                                                  /* waits on a down of a semaphore */
+#define  CO_NOTICE          4                                                               /* waits for a notice */
+
+/** \brief longest time a host blocks on its semaphore (us), so it never depends on a single up */
+#define  HOSTWAIT      1000000
+
+/**
+ *  \brief Definition of a group coroutine.
+ */
+typedef struct {
+    /** \brief saved context */
+    ucontext_t ctx;
+    /** \brief coroutine state (CO_*) */
+    int state;
+    /** \brief time at which a sleeping coroutine is resumed (us) */
+    long long wake;
+    /** \brief semaphore a blocked coroutine waits on */
+    unsigned int sem;
+    /** \brief notice a coroutine waits for (NOTE_*) */
+    int note;
+    /** \brief stack, kept for the next group of the slot */
+    void *stack;
+} COROUTINE;
 
 /** \brief logging file name */
 static char nFic[51];
@@ -44,12 +101,39 @@ static int semgid;
 /** \brief pointer to shared memory region */
 static SHARED_DATA *sh;
 
-static void goToRestaurant (int id);
+/** \brief random number stream of the group of each slot */
+static RNG rng[MAXGROUPS];
+
+/** \brief host id (-1 if the process runs a single group) */
+static int host = -1;
+
+/** \brief semaphore set of the main program, whose semaphore 1 is upped each time a hosted group leaves */
+static int leftgid;
+
+/** \brief context of the host, resumed when a coroutine yields or ends */
+static ucontext_t hostCtx;
+
+/** \brief coroutine of each slot */
+static COROUTINE co[MAXGROUPS];
+
+/** \brief slot of the running coroutine */
+static int current;
+
+/** \brief process of the group of each slot, forked by the fork server (0 if none) */
+static pid_t worker[MAXGROUPS];
+
+static void goToRestaurant (int id, long long wake);
 static void checkInAtReception (int id);
+static bool waitForTable (int id);
 static void orderFood (int id);
 static void waitFood (int id);
-static void eat (int id);
+static void eat (int id, long long wake);
 static void checkOutAtReception (int id);
+static void postRequest (int server, int type, int id);
+static void lifeCycle (int id);
+static long long launched (int id);
+static void hostGroups (void);
+static bool forkGroups (void);
 
 
 /**
@@ -61,10 +145,11 @@ int main (int argc, char *argv[])
 {
     int key;                                         /*access key to shared memory and semaphore set */
     char *tinp;                                                    /* numerical parameters test flag */
-    int n;
+    long long gate;                                    /* time blocked waiting for the start of operations */
+    int n, status = EXIT_SUCCESS;                                                      /* exit status */
 
     /* validation of command line parameters */
-    if (argc != 5) { 
+    if ((argc != 5) && ((argc != 6) || (strcmp (argv[1], "-h") != 0))) {
         freopen ("error_GR", "a", stderr);
         fprintf (stderr, "Number of parameters is incorrect!\n");
         return EXIT_FAILURE;
@@ -73,6 +158,9 @@ int main (int argc, char *argv[])
      //  freopen (argv[4], "w", stderr);
        setbuf(stderr,NULL);
     }
+    if (argc == 6) {                                                   /* -h host log key key of the main program */
+        argv += 1;
+    }
 
     n = (unsigned int) strtol (argv[1], &tinp, 0);
     if ((*tinp != '\0') || (n >= MAXGROUPS )) { 
@@ -88,10 +176,12 @@ int main (int argc, char *argv[])
 
     /* connection to the semaphore set and the shared memory region and mapping the shared region onto the
        process address space */
+    gate = timeNow ();
     if ((semgid = semConnect (key)) == -1) { 
         perror ("error on connecting to the semaphore set");
         return EXIT_FAILURE;
     }
+    gate = timeNow () - gate;
     if ((shmid = shmemConnect (key)) == -1) { 
         perror ("error on connecting to the shared memory region");
         return EXIT_FAILURE;
@@ -100,18 +190,44 @@ int main (int argc, char *argv[])
         perror ("error on mapping the shared region on the process address space");
         return EXIT_FAILURE;
     }
+    if (sh->fSt.semTiming) {
+        semTimingStart (&sh->fSt, semgid);
+    }
+    if (sh->fSt.groupHosts > 0) {
+        semSetNotify (semgid, sh->fSt.semNotify, SEM_NU + 1, GROUPHOST);
+    }
+
+    if (argc == 6) {
+        /* hosting groups as coroutines, or forking them, until the restaurant closes */
+        host = n;
+        key = (unsigned int) strtol (argv[4], &tinp, 0);
+        if ((*tinp != '\0') || (host >= sh->fSt.groupHosts)) {
+            fprintf (stderr, "Host identification or access key of the main program is wrong!\n");
+            return EXIT_FAILURE;
+        }
+        if ((leftgid = semConnect (key)) == -1) {
+            perror ("error on connecting to the semaphore set of the main program");
+            return EXIT_FAILURE;
+        }
+        jitterStart (&sh->fSt, JITTERHOST (host));
+        if (sh->fSt.launch == LAUNCH_FORKSERVER) {
+            status = forkGroups () ? EXIT_SUCCESS : EXIT_FAILURE;           /* failure if a group process failed */
+        }
+        else hostGroups ();
+    }
+    else {
+        /* initialize random generator (stream of the entity, from the seed of the run) and the record or
+           replay of grants */
+        rngSeed (&rng[n], sh->fSt.seed, REPLAY_GROUP + sh->fSt.groupArrival[n]);
+        if (sh->fSt.replay != REPLAY_OFF) {
+            replayAttach (semgid, REPLAY_GROUP + n);
+        }
+        jitterStart (&sh->fSt, REPLAY_GROUP + sh->fSt.groupArrival[n]);
 
-    /* initialize random generator */
-    srandom ((unsigned int) getpid ());                                                 
-
-
-    /* simulation of the life cycle of the group */
-    goToRestaurant(n);
-    checkInAtReception(n);
-    orderFood(n);
-    waitFood(n);
-    eat(n);
-    checkOutAtReception(n);
+        /* simulation of the life cycle of the group */
+        startupRecord (&sh->fSt, ENT_GROUPS, sh->fSt.groupSpawn[n], gate);
+        lifeCycle (n);
+    }
 
     /* unmapping the shared region off the process address space */
     if (shmemDettach (sh) == -1) {
@@ -119,7 +235,361 @@ int main (int argc, char *argv[])
         return EXIT_FAILURE;;
     }
 
-    return EXIT_SUCCESS;
+    return status;
+}
+
+/**
+ *  \brief Life cycle of a group.
+ *
+ *  A group restored from a checkpoint starts in the state it was in, with the wake time it had.
+ *
+ *  \param id group id
+ */
+static void lifeCycle (int id)
+{
+    int from = GOTOREST;
+    long long wake = 0;
+
+    if (sh->fSt.resumed[id]) {
+        from = sh->fSt.st.groupStat[id];
+        wake = sh->fSt.wakeTime[id];
+        sh->fSt.resumed[id] = false;
+    }
+    if (from != EAT) {
+        if (from == GOTOREST) {
+            goToRestaurant(id, wake);
+            checkInAtReception(id);
+        }
+        if (!waitForTable(id)) {
+            return;                                                                   /* turned away, left */
+        }
+        orderFood(id);
+        waitFood(id);
+        wake = sh->fSt.wakeTime[id];
+    }
+    eat(id, wake);
+    checkOutAtReception(id);
+}
+
+/**
+ *  \brief Time at which a group was launched.
+ *
+ *  Groups placed before the start of operations can only start then.
+ *
+ *  \param id group id
+ *
+ *  \return the later of the launch of the group and the start of operations (us)
+ */
+static long long launched (int id)
+{
+    return (sh->fSt.groupSpawn[id] > sh->fSt.startRun) ? sh->fSt.groupSpawn[id] : sh->fSt.startRun;
+}
+
+/**
+ *  \brief Switching from the running coroutine to the host.
+ *
+ *  \param state new state of the coroutine (CO_*)
+ */
+static void yieldHost (int state)
+{
+    co[current].state = state;
+    if (swapcontext (&co[current].ctx, &hostCtx) == -1) {
+        perror ("error on switching to the host");
+        exit (EXIT_FAILURE);
+    }
+}
+
+/**
+ *  \brief Yielding on a down that would block (see semSetYield).
+ *
+ *  The first time, the host is registered to be notified of the ups of the semaphore and the down is
+ *  tried again at once; afterwards the coroutine waits for the host to resume it.
+ *
+ *  \param sindex semaphore location in the set
+ */
+static void yieldDown (unsigned int sindex)
+{
+    unsigned int bit = 1u << host;
+
+    if ((__atomic_load_n (&sh->fSt.semNotify[sindex], __ATOMIC_SEQ_CST) & bit) == 0) {
+        __atomic_fetch_or (&sh->fSt.semNotify[sindex], bit, __ATOMIC_SEQ_CST);
+        return;
+    }
+    co[current].sem = sindex;
+    yieldHost (CO_BLOCKED);
+}
+
+/**
+ *  \brief Sleeping, or yielding until a time, if the group is hosted.
+ *
+ *  \param id group id
+ *  \param t time to sleep (us)
+ */
+static void groupSleep (int id, double t)
+{
+    if (host < 0) {
+        usleep ((unsigned int) t);
+        return;
+    }
+    co[id].wake = timeNow () + (long long) t;
+    yieldHost (CO_SLEEPING);
+}
+
+/**
+ *  \brief Waiting for a notice, or yielding until one is posted, if the group is hosted.
+ *
+ *  \param id group id
+ *  \param note notice (NOTE_*)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+static int groupWait (int id, int note)
+{
+    if (host < 0) {
+        return semDown (semgid, noticeSem (sh, id, note));
+    }
+    while (!noticeTake (sh, id, note)) {
+        co[id].note = note;
+        yieldHost (CO_NOTICE);
+    }
+    return 0;
+}
+
+/**
+ *  \brief Life cycle of a hosted group.
+ *
+ *  \param id group id
+ */
+static void groupCoroutine (int id)
+{
+    startupRecord (&sh->fSt, ENT_GROUPS, launched (id), 0);
+    lifeCycle (id);
+    co[id].state = CO_FREE;                                                       /* back to the host (uc_link) */
+}
+
+/**
+ *  \brief Hosting groups as coroutines.
+ *
+ *  Each pass starts the groups placed in the slots of the host by the main program, then resumes
+ *  every coroutine that is not sleeping past the present time nor waiting for a notice not yet posted;
+ *  blocked ones try their down again, as many as the value of their semaphore at the start of the pass,
+ *  so thousands of groups queued on a semaphore do not each cost a try at every pass.
+ *  When a group leaves, its slot is handed back to the main program. Between passes the host blocks
+ *  on its semaphore until an up of a semaphore one of its groups waits on, or the next wake time.
+ *  Notifications no group waits for are then withdrawn. The host ends once the restaurant closes and
+ *  none of its groups is left.
+ */
+static void hostGroups (void)
+{
+    int g, ready, live;
+    unsigned int s, bit = 1u << host;
+    long long now, next;
+    static bool waited[MAXSEMS];
+    static unsigned short val[MAXSEMS];
+
+    semSetYield (yieldDown);
+    for (;;) {
+        /* groups placed by the main program */
+        for (g = host; g < sh->fSt.nGroups; g += sh->fSt.groupHosts) {
+            ready = SLOT_READY;
+            if (!__atomic_compare_exchange_n (&sh->fSt.slotState[g], &ready, SLOT_RUNNING, false, __ATOMIC_SEQ_CST,
+                                              __ATOMIC_SEQ_CST)) {
+                continue;
+            }
+            if ((co[g].stack == NULL) && ((co[g].stack = malloc (sh->fSt.coStack * 1024)) == NULL)) {
+                perror ("error on allocating the stack of a group");
+                exit (EXIT_FAILURE);
+            }
+            if (getcontext (&co[g].ctx) == -1) {
+                perror ("error on creating the context of a group");
+                exit (EXIT_FAILURE);
+            }
+            co[g].ctx.uc_stack.ss_sp = co[g].stack;
+            co[g].ctx.uc_stack.ss_size = sh->fSt.coStack * 1024;
+            co[g].ctx.uc_link = &hostCtx;
+            makecontext (&co[g].ctx, (void (*) (void)) groupCoroutine, 1, g);
+            rngSeed (&rng[g], sh->fSt.seed, REPLAY_GROUP + sh->fSt.groupArrival[g]);
+            co[g].state = CO_READY;
+        }
+
+        /* a pass over the groups */
+        now = timeNow ();
+        next = now + HOSTWAIT;
+        live = 0;
+        memset (waited, 0, (SEM_NU + 1) * sizeof (bool));
+        if (semGetAll (semgid, val) == -1) {
+            perror ("error on reading the semaphore set (GR)");
+            exit (EXIT_FAILURE);
+        }
+        for (g = host; g < sh->fSt.nGroups; g += sh->fSt.groupHosts) {
+            if ((co[g].state == CO_SLEEPING) && (co[g].wake > now)) {
+                next = (co[g].wake < next) ? co[g].wake : next;
+                live += 1;
+                continue;
+            }
+            if ((co[g].state == CO_NOTICE) && (__atomic_load_n (&sh->fSt.notice[g][co[g].note], __ATOMIC_SEQ_CST) == 0)) {
+                live += 1;
+                continue;
+            }
+            if (co[g].state == CO_BLOCKED) {
+                if (val[co[g].sem] == 0) {
+                    waited[co[g].sem] = true;
+                    live += 1;
+                    continue;
+                }
+                val[co[g].sem] -= 1;                                  /* taken by this group, if no one else is first */
+            }
+            if (co[g].state != CO_FREE) {
+                current = g;
+                if (swapcontext (&hostCtx, &co[g].ctx) == -1) {
+                    perror ("error on switching to a group");
+                    exit (EXIT_FAILURE);
+                }
+            }
+            if (co[g].state == CO_FREE) {
+                if (__atomic_load_n (&sh->fSt.slotState[g], __ATOMIC_SEQ_CST) == SLOT_RUNNING) {
+                    __atomic_store_n (&sh->fSt.slotState[g], SLOT_DONE, __ATOMIC_SEQ_CST);
+                    if (semUp (leftgid, 1) == -1) {
+                        perror ("error on the up operation for semaphore access (GR)");
+                        exit (EXIT_FAILURE);
+                    }
+                }
+                continue;
+            }
+            live += 1;
+            if (co[g].state == CO_SLEEPING) {
+                next = (co[g].wake < next) ? co[g].wake : next;
+            }
+            else if (co[g].state == CO_BLOCKED) {
+                waited[co[g].sem] = true;
+            }
+        }
+        if ((live == 0) && __atomic_load_n (&sh->fSt.closing, __ATOMIC_SEQ_CST)) {
+            break;
+        }
+
+        /* withdrawing the notifications no group waits for, then waiting */
+        for (s = 1; s < SEM_NU + 1; s++) {
+            if (!waited[s] && (sh->fSt.semNotify[s] & bit)) {
+                __atomic_fetch_and (&sh->fSt.semNotify[s], ~bit, __ATOMIC_SEQ_CST);
+            }
+        }
+        if (((next - timeNow ()) > 0) &&
+            (semTimedDown (semgid, sh->groupHost[host], next - timeNow ()) == -1) && (errno != EAGAIN) && (errno != EINTR)) {
+            perror ("error on the down operation for semaphore access (GR)");
+            exit (EXIT_FAILURE);
+        }
+        while (semTimedDown (semgid, sh->groupHost[host], 0) == 0);                      /* drain the notifications */
+    }
+    for (g = host; g < sh->fSt.nGroups; g += sh->fSt.groupHosts) {
+        free (co[g].stack);
+    }
+}
+
+/**
+ *  \brief Reaping a group process forked by the fork server.
+ *
+ *  A process that failed is counted, with its wait status if it is the first. If its group did not
+ *  hand its slot back, the slot is handed back for it, marked as failed, so the main program frees it
+ *  and does not count the group as served.
+ *
+ *  \param pid process identifier
+ *  \param status wait status of the process
+ */
+static void workerEnded (pid_t pid, int status)
+{
+    int g;
+
+    for (g = 0; (g < sh->fSt.nGroups) && (worker[g] != pid); g++);
+    if (g < sh->fSt.nGroups) {
+        worker[g] = 0;
+    }
+    if (WIFEXITED (status) && (WEXITSTATUS (status) == EXIT_SUCCESS)) {
+        return;
+    }
+    if (sh->fSt.workersFailed++ == 0) {
+        sh->fSt.workerStatus = status;
+    }
+    if ((g < sh->fSt.nGroups) && (__atomic_load_n (&sh->fSt.slotState[g], __ATOMIC_SEQ_CST) == SLOT_RUNNING)) {
+        sh->fSt.failed[g] = true;
+        __atomic_store_n (&sh->fSt.slotState[g], SLOT_DONE, __ATOMIC_SEQ_CST);
+        if (semUp (leftgid, 1) == -1) {
+            perror ("error on the up operation for semaphore access (GR)");
+            exit (EXIT_FAILURE);
+        }
+    }
+}
+
+/**
+ *  \brief Forking a process for each group (fork server).
+ *
+ *  Each pass forks a process for every group placed in a slot by the main program, which runs the
+ *  group and hands its slot back to the main program when the group leaves, and reaps the processes
+ *  that ended (see workerEnded). Between passes the template blocks on its semaphore. It ends once the
+ *  restaurant closes and all its processes are reaped; their CPU time is then reported with its own.
+ *
+ *  \return true if every process of a group exited with status 0
+ */
+static bool forkGroups (void)
+{
+    int g, ready, status, live = 0;
+    pid_t pid;
+
+    for (;;) {
+        /* groups placed by the main program */
+        for (g = 0; g < sh->fSt.nGroups; g++) {
+            ready = SLOT_READY;
+            if (!__atomic_compare_exchange_n (&sh->fSt.slotState[g], &ready, SLOT_RUNNING, false, __ATOMIC_SEQ_CST,
+                                              __ATOMIC_SEQ_CST)) {
+                continue;
+            }
+            fflush (NULL);                                    /* nothing buffered is written twice */
+            if ((pid = fork ()) < 0) {
+                perror ("error on the fork operation for the group");
+                exit (EXIT_FAILURE);
+            }
+            if (pid == 0) {
+                host = -1;                                                  /* the group runs on its own */
+                startupRecord (&sh->fSt, ENT_GROUPS, launched (g), 0);
+                rngSeed (&rng[g], sh->fSt.seed, REPLAY_GROUP + sh->fSt.groupArrival[g]);
+                jitterStart (&sh->fSt, REPLAY_GROUP + sh->fSt.groupArrival[g]);
+                lifeCycle (g);
+                __atomic_store_n (&sh->fSt.slotState[g], SLOT_DONE, __ATOMIC_SEQ_CST);
+                if (semUp (leftgid, 1) == -1) {
+                    perror ("error on the up operation for semaphore access (GR)");
+                    _exit (EXIT_FAILURE);
+                }
+                _exit (EXIT_SUCCESS);
+            }
+            worker[g] = pid;
+            live += 1;
+        }
+
+        /* processes that ended */
+        while ((pid = waitpid (-1, &status, WNOHANG)) > 0) {
+            workerEnded (pid, status);
+            live -= 1;
+        }
+        if (__atomic_load_n (&sh->fSt.closing, __ATOMIC_SEQ_CST)) {
+            break;
+        }
+        if ((semTimedDown (semgid, sh->groupHost[host], HOSTWAIT) == -1) && (errno != EAGAIN) && (errno != EINTR)) {
+            perror ("error on the down operation for semaphore access (GR)");
+            exit (EXIT_FAILURE);
+        }
+    }
+    while (live > 0) {
+        if ((pid = waitpid (-1, &status, 0)) > 0) {
+            workerEnded (pid, status);
+            live -= 1;
+        }
+        else if (errno != EINTR) {
+            perror ("error on waiting for a group process");
+            exit (EXIT_FAILURE);
+        }
+    }
+    return sh->fSt.workersFailed == 0;
 }
 
 /**
@@ -127,50 +597,51 @@ int main (int argc, char *argv[])
  *
  *  Generates random number according to normal distribution.
  * 
+ *  \param id group id
  *  \param stddev controls standard deviation of distribution
  */
-static double normalRand(double stddev)
+static double normalRand(int id, double stddev)
 {
-   int i;
-
-   double r=0.0;
-   for (i=0;i<12;i++) {
-       r += random()/(RAND_MAX+1.0);
-   }
-   r -= 6.0;
-
-   return r*stddev;
+   return rngNormal(&rng[id])*stddev;
 }
 
 /**
  *  \brief group goes to restaurant 
  *
  *  The group takes its time to get to restaurant.
+ *  The arrival time is recorded, it is used by some scheduling policies and statistics.
  *
  *  \param id group id
+ *  \param wake time of arrival of a group restored from a checkpoint (us, 0 to draw it)
  */
-static void goToRestaurant (int id)
+static void goToRestaurant (int id, long long wake)
 {
-    double startTime = sh->fSt.startTime[id] + normalRand(STARTDEV);
-    
-    if (startTime > 0.0) {
-        usleep((unsigned int) startTime );
+    double startTime;
+
+    if (wake == 0) {
+        startTime = sh->fSt.startTime[id] + normalRand(id, STARTDEV);
+        sh->fSt.stateTime[id][GOTOREST] = timeNow ();
+        wake = sh->fSt.wakeTime[id] = sh->fSt.stateTime[id][GOTOREST] + (long long) startTime;
     }
+    if (wake > timeNow ()) {
+        groupSleep(id, wake - timeNow ());
+    }
+    sh->fSt.arrivalTime[id] = timeNow ();
 }
 
 /**
  *  \brief group eats
  *
- *  The group takes his time to eat a pleasant dinner.
+ *  The group takes his time to eat a pleasant dinner, until the end of its meal (drawn when the food
+ *  arrived, see waitFood).
  *
  *  \param id group id
+ *  \param wake time at which the meal ends (us)
  */
-static void eat (int id)
+static void eat (int id, long long wake)
 {
-    double eatTime = sh->fSt.eatTime[id] + normalRand(EATDEV);
-    
-    if (eatTime > 0.0) {
-        usleep((unsigned int) eatTime );
+    if (wake > timeNow ()) {
+        groupSleep(id, wake - timeNow ());
     }
 }
 
@@ -179,7 +650,6 @@ static void eat (int id)
  *
  *  Group should, as soon as receptionist is available, ask for a table,
  *  signaling receptionist of the request.  
- *  Group may have to wait for a table in this method.
  *  The internal state should be saved.
  *
  *  \param id group id
@@ -189,7 +659,7 @@ static void eat (int id)
 static void checkInAtReception(int id) {
 
     // Enter critical region for receptionist
-    if (semDown(semgid, sh->receptionistRequestPossible) == -1) {
+    if (!sh->fSt.eventLoop && (semDown(semgid, sh->receptionistRequestPossible) == -1)) {
         perror("error on the down operation for semaphore access (RT)");
         exit(EXIT_FAILURE);
     }
@@ -202,29 +672,60 @@ static void checkInAtReception(int id) {
 
     // Update group state to ATRECEPTION
     sh->fSt.st.groupStat[id] = ATRECEPTION;
+    sh->fSt.stateTime[id][ATRECEPTION] = timeNow ();
     saveState(nFic, &sh->fSt);
 
-    // Indicate new check-in request
-    sh->fSt.receptionistRequest.reqType = TABLEREQ;
-    sh->fSt.receptionistRequest.reqGroup = id;
-
-    // Signal the receptionist about the new check-in
-    if (semUp(semgid, sh->receptionistReq) == -1) {
-        perror("error on the up operation for semaphore access (RT)");
-        exit(EXIT_FAILURE);
-    }
+    // Indicate new check-in request and signal the receptionist
+    histAdd(&sh->fSt.firstRequest, timeNow () - launched(id));
+    postRequest(SRV_RECEPTIONIST, TABLEREQ, id);
 
     // Exit critical region
     if (semUp(semgid, sh->mutex) == -1) {
         perror("error on the up operation for semaphore access (RT)");
         exit(EXIT_FAILURE);
     }
+}
+
+/**
+ *  \brief group waits for a table
+ *
+ *  Group waits for the receptionist to assign it a table.
+ *  If the receptionist turned it away instead (see <tt>#admission</tt>), the group updates
+ *  its state to LEAVING and leaves at once.
+ *  The internal state should then be saved.
+ *
+ *  \param id group id
+ *
+ *  \return true if the group got a table, false if it was turned away
+ */
+static bool waitForTable(int id) {
 
     // Wait for the receptionist to assign a table
-    if (semDown(semgid, sh->waitForTable[id]) == -1) {
+    if (groupWait(id, NOTE_TABLE) == -1) {
+        perror("error on the down operation for semaphore access (RT)");
+        exit(EXIT_FAILURE);
+    }
+    if (!sh->fSt.rejected[id]) {
+        return true;
+    }
+
+    // Enter critical region
+    if (semDown(semgid, sh->mutex) == -1) {
         perror("error on the down operation for semaphore access (RT)");
         exit(EXIT_FAILURE);
     }
+
+    // Update group state to LEAVING
+    sh->fSt.st.groupStat[id] = LEAVING;
+    sh->fSt.stateTime[id][LEAVING] = timeNow ();
+    saveState(nFic, &sh->fSt);
+
+    // Exit critical region
+    if (semUp(semgid, sh->mutex) == -1) {
+        perror("error on the up operation for semaphore access (RT)");
+        exit(EXIT_FAILURE);
+    }
+    return false;
 }
 
 /**
@@ -239,10 +740,8 @@ static void checkInAtReception(int id) {
  */
 static void orderFood(int id) {
 
-    int tableID;
-
     // Enter critical region for waiter
-    if (semDown(semgid, sh->waiterRequestPossible) == -1) {
+    if (!sh->fSt.eventLoop && (semDown(semgid, sh->waiterRequestPossible) == -1)) {
         perror("error on the down operation for semaphore access (WT)");
         exit(EXIT_FAILURE);
     }
@@ -255,19 +754,11 @@ static void orderFood(int id) {
 
     // Update group state to FOOD_REQUEST
     sh->fSt.st.groupStat[id] = FOOD_REQUEST;
+    sh->fSt.stateTime[id][FOOD_REQUEST] = timeNow ();
     saveState(nFic, &sh->fSt);
 
     // Prepare and send food request to waiter
-    sh->fSt.waiterRequest.reqType = FOODREQ;
-    sh->fSt.waiterRequest.reqGroup = id;
-
-    if (semUp(semgid, sh->waiterRequest) == -1) {
-        perror("error on the up operation for semaphore access (WT)");
-        exit(EXIT_FAILURE);
-    }
-
-    // Use the group id to know which table was assigned to the group  
-    tableID = sh->fSt.assignedTable[id];
+    postRequest(SRV_WAITER, FOODREQ, id);
 
     // Exit critical region
     if (semUp(semgid, sh->mutex) == -1) {
@@ -275,7 +766,7 @@ static void orderFood(int id) {
         exit(EXIT_FAILURE);
     }
 
-    if (semDown(semgid, sh->requestReceived[tableID]) == -1) {
+    if (groupWait(id, NOTE_REQUEST) == -1) {
         perror("error on the down operation for semaphore access (WT)");
         exit(EXIT_FAILURE);
     }
@@ -285,15 +776,13 @@ static void orderFood(int id) {
  *  \brief group waits for food.
  *
  *  The group updates its state, and waits until food arrives. 
- *  It should also update state after food arrives.
+ *  It should also update state after food arrives, and the end of its meal is set.
  *  The internal state should be saved twice.
  *
  *  \param id group id
  */
 static void waitFood(int id) {
 
-    int tableID;
-
     // Enter critical region
     if (semDown(semgid, sh->mutex) == -1) {
         perror("error on the down operation for semaphore access (WT)");
@@ -302,11 +791,9 @@ static void waitFood(int id) {
 
     // Update group state to WAIT_FOR_FOOD
     sh->fSt.st.groupStat[id] = WAIT_FOR_FOOD;
+    sh->fSt.stateTime[id][WAIT_FOR_FOOD] = timeNow ();
     saveState(nFic, &sh->fSt);
 
-    // Use the group id to know which table was assigned to the group
-    tableID = sh->fSt.assignedTable[id];
-
     // Exit critical region
     if (semUp(semgid, sh->mutex) == -1) {
         perror("error on the up operation for semaphore access (WT)");
@@ -314,7 +801,7 @@ static void waitFood(int id) {
     }
 
     // Wait for the food to arrive at the table
-    if (semDown(semgid, sh->foodArrived[tableID]) == -1) {
+    if (groupWait(id, NOTE_FOOD) == -1) {
         perror("error on the down operation for semaphore access (WT)");
         exit(EXIT_FAILURE);
     }
@@ -327,6 +814,8 @@ static void waitFood(int id) {
 
     // Update group state to EAT
     sh->fSt.st.groupStat[id] = EAT;
+    sh->fSt.stateTime[id][EAT] = timeNow ();
+    sh->fSt.wakeTime[id] = sh->fSt.stateTime[id][EAT] + (long long) (sh->fSt.eatTime[id] + normalRand(id, EATDEV));
     saveState(nFic, &sh->fSt);
 
     // Exit critical region
@@ -349,10 +838,8 @@ static void waitFood(int id) {
  */
 static void checkOutAtReception(int id) {
 
-    int tableID;
-
     // Request access to the receptionist
-    if (semDown(semgid, sh->receptionistRequestPossible) == -1) {
+    if (!sh->fSt.eventLoop && (semDown(semgid, sh->receptionistRequestPossible) == -1)) {
         perror("error on the down operation for receptionist access (RT)");
         exit(EXIT_FAILURE);
     }
@@ -365,20 +852,11 @@ static void checkOutAtReception(int id) {
 
     // Update group state to CHECKOUT
     sh->fSt.st.groupStat[id] = CHECKOUT;
+    sh->fSt.stateTime[id][CHECKOUT] = timeNow ();
     saveState(nFic, &sh->fSt);
 
-    // Indicate that the group wants to pay
-    sh->fSt.receptionistRequest.reqType = BILLREQ;
-    sh->fSt.receptionistRequest.reqGroup = id;
-
-    // Inform receptionist that the group is ready to pay
-    if (semUp(semgid, sh->receptionistReq) == -1) {
-        perror("error on the up operation for receptionist access (RT)");
-        exit(EXIT_FAILURE);
-    }
-
-    // Use the group id to know which table was assigned to the group
-    tableID = sh->fSt.assignedTable[id];
+    // Indicate that the group wants to pay and inform the receptionist
+    postRequest(SRV_RECEPTIONIST, BILLREQ, id);
 
     // Exit critical region
     if (semUp(semgid, sh->mutex) == -1) {
@@ -387,7 +865,7 @@ static void checkOutAtReception(int id) {
     }
 
     // Wait for the receptionist to process the payment
-    if (semDown(semgid, sh->tableDone[tableID]) == -1) {
+    if (groupWait(id, NOTE_PAID) == -1) {
         perror("error on the down operation for table done access (RT)");
         exit(EXIT_FAILURE);
     }
@@ -400,6 +878,7 @@ static void checkOutAtReception(int id) {
 
     // Update group state to LEAVING
     sh->fSt.st.groupStat[id] = LEAVING;
+    sh->fSt.stateTime[id][LEAVING] = timeNow ();
     saveState(nFic, &sh->fSt);
 
     // Exit critical region
@@ -409,3 +888,39 @@ static void checkOutAtReception(int id) {
     }
 }
 
+/**
+ *  \brief group makes a request to the waiter or to the receptionist.
+ *
+ *  To be called within the critical region. The request is stored in the request slot of the
+ *  server, which the group holds, and the request semaphore of the server is upped; when the server
+ *  runs an event loop, the request is queued and the channel of the server is posted instead.
+ *
+ *  \param server SRV_WAITER or SRV_RECEPTIONIST
+ *  \param type request type
+ *  \param id group id
+ */
+static void postRequest(int server, int type, int id) {
+    bool waiter = (server == SRV_WAITER);
+    REQUEST_QUEUE *q = waiter ? &sh->fSt.waiterQueue : &sh->fSt.receptionistQueue;
+    request *slot = waiter ? &sh->fSt.waiterRequest : &sh->fSt.receptionistRequest;
+
+    sh->fSt.wakeupStamp[server] = timeNow ();
+    if (sh->fSt.eventLoop) {
+        q->req[q->n].reqType = type;
+        q->req[q->n].reqGroup = id;
+        q->n += 1;
+        jitterAt(JIT_REQUEST);
+        if (eventPost(sh->fSt.eventFd[waiter ? EV_WAITER : EV_RECEPTIONIST]) == -1) {
+            perror("error on posting a request event");
+            exit(EXIT_FAILURE);
+        }
+        return;
+    }
+    slot->reqType = type;
+    slot->reqGroup = id;
+    jitterAt(JIT_REQUEST);
+    if (semUp(semgid, waiter ? sh->waiterRequest : sh->receptionistReq) == -1) {
+        perror("error on the up operation for semaphore access");
+        exit(EXIT_FAILURE);
+    }
+}
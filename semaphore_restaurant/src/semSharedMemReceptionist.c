@@ -8,9 +8,25 @@
  *
  *  Definition of the operations carried out by the receptionist:
  *     \li waitForGroup
+ *     \li waitForEvents
  *     \li provideTableOrWaitingRoom
  *     \li receivePayment
  *
+ *  The order in which waiting groups get a vacant table is given by the scheduling policy
+ *  selected in the configuration file (see POLICY). Tables are assigned best-fit: a group
+ *  gets the table with the fewest free seats that still seats it, possibly sharing it with
+ *  other groups or joining several vacant tables when the configuration allows it.
+ *
+ *  A group that can not be seated when it checks in waits for a table, unless the admission policy
+ *  (<tt>#admission</tt>) turns it away: when the waiting room is full, or when its estimated wait is too
+ *  long. The wait is estimated as the time groups held their tables so far, on average, times the
+ *  number of groups that would be ahead of it, over the number of tables (no group is turned away on
+ *  that ground before a table was left). A group turned away is told so through the notice of its table
+ *  (see notice.h) and leaves at once. The number of groups waiting is tracked over time (see TIMELINE).
+ *
+ *  With <tt>#events ON</tt> the receptionist runs an event loop (waitForEvents) on the channels of the
+ *  group requests and of the closing, instead of waiting on receptionistReq.
+ *
  *  \author Nuno Lau - December 2023
  */
 
@@ -29,6 +45,11 @@
 #include "sharedDataSync.h"
 #include "semaphore.h"
 #include "sharedMemory.h"
+#include "replay.h"
+#include "statistics.h"
+#include "events.h"
+#include "jitter.h"
+#include "notice.h"
 
 /** \brief logging file name */
 static char nFic[51];
@@ -42,18 +63,58 @@ static int semgid;
 /** \brief pointer to shared memory region */
 static SHARED_DATA *sh;
 
-/* constants for groupRecord */
-#define TOARRIVE 0
-#define WAIT     1
-#define ATTABLE  2
-#define DONE     3
+/* the internal memory of the receptionist lives in the shared region (see RECEPTION), so that it is
+   part of a checkpoint; it is initialized by the main program */
 
 /** \brief receptioninst view on each group evolution (useful to decide table binding) */
-static int groupRecord[MAXGROUPS];
+static int *groupRecord;
+
+/** \brief order in which groups checked in at reception */
+static long long *checkInOrder;
+
+/** \brief time at which each table got occupied */
+static long long *tableSince;
+
+/** \brief time at which each group was seated */
+static long long *seatSince;
+
+/** \brief tables joined for a single group (not to be shared) */
+static bool *tableJoined;
+
+/**
+ *  \brief Definition of a scheduling policy.
+ *
+ *  A policy ranks the waiting groups: the waiting group with the lowest key gets the next vacant table.
+ */
+typedef struct {
+    /** \brief policy id (see probConst.h) */
+    int id;
+    /** \brief key of group g, lower keys are served first */
+    long long (*key) (int g);
+} POLICY;
+
+static long long keyLowestId (int g)  { return g; }
+static long long keyFifo (int g)      { return checkInOrder[g]; }
+static long long keySmf (int g)       { return sh->fSt.eatTime[g]; }
+static long long keyEarliest (int g)  { return sh->fSt.arrivalTime[g]; }
+
+/** \brief available scheduling policies */
+static const POLICY policies[NUMPOLICIES] = {
+    { POLICY_LOWESTID, keyLowestId },
+    { POLICY_FIFO,     keyFifo },
+    { POLICY_SMF,      keySmf },
+    { POLICY_EARLIEST, keyEarliest }
+};
+
+/** \brief scheduling policy in use */
+static const POLICY *policy;
 
 /** \brief receptionist waits for next request */
 static request waitForGroup ();
 
+/** \brief receptionist waits for events and collects every request ready */
+static int waitForEvents (request req[]);
+
 /** \brief receptionist waits for next request */
 static void provideTableOrWaitingRoom (int n);
 
@@ -71,6 +132,7 @@ int main (int argc, char *argv[])
 {
     int key;                                            /*access key to shared memory and semaphore set */
     char *tinp;                                                       /* numerical parameters test flag */
+    long long gate;                                    /* time blocked waiting for the start of operations */
 
     /* validation of command line parameters */
     if (argc != 4) { 
@@ -92,10 +154,12 @@ int main (int argc, char *argv[])
 
     /* connection to the semaphore set and the shared memory region and mapping the shared region onto the
        process address space */
+    gate = timeNow ();
     if ((semgid = semConnect (key)) == -1) { 
         perror ("error on connecting to the semaphore set");
         return EXIT_FAILURE;
     }
+    gate = timeNow () - gate;
     if ((shmid = shmemConnect (key)) == -1) { 
         perror ("error on connecting to the shared memory region");
         return EXIT_FAILURE;
@@ -105,29 +169,57 @@ int main (int argc, char *argv[])
         return EXIT_FAILURE;
     }
 
-    /* initialize random generator */
-    srandom ((unsigned int) getpid ());              
-
-    /* initialize internal receptionist memory */
-    int g;
-    for (g=0; g < sh->fSt.nGroups; g++) {
-       groupRecord[g] = TOARRIVE;
+    /* initialize the record or replay of grants */
+    if (sh->fSt.replay != REPLAY_OFF) {
+        replayAttach (semgid, REPLAY_RECEPTIONIST);
     }
-
-    /* simulation of the life cycle of the receptionist */
-    int nReq=0;
-    request req;
-    while( nReq < sh->fSt.nGroups*2 ) {
-        req = waitForGroup();
-        switch(req.reqType) {
-            case TABLEREQ:
-                   provideTableOrWaitingRoom(req.reqGroup); //TODO param should be groupid
-                   break;
-            case BILLREQ:
-                   receivePayment(req.reqGroup);
-                   break;
+    jitterStart (&sh->fSt, REPLAY_RECEPTIONIST);
+    if (sh->fSt.semTiming) {
+        semTimingStart (&sh->fSt, semgid);
+    }
+    if (sh->fSt.groupHosts > 0) {
+        semSetNotify (semgid, sh->fSt.semNotify, SEM_NU + 1, GROUPHOST);
+    }
+    if (sh->fSt.eventLoop &&
+        (eventLoopCreate (sh->fSt.eventFd, EV_RECEPTIONIST, EV_CLOSERECEPT - EV_RECEPTIONIST + 1, sh->fSt.eventTick) == -1)) {
+        perror ("error on creating the event loop");
+        return EXIT_FAILURE;
+    }
+    startupRecord (&sh->fSt, SRV_RECEPTIONIST, sh->fSt.serverSpawn[SRV_RECEPTIONIST], gate);
+
+    /* internal receptionist memory */
+    groupRecord = sh->fSt.reception.groupRecord;
+    checkInOrder = sh->fSt.reception.checkInOrder;
+    tableSince = sh->fSt.reception.tableSince;
+    seatSince = sh->fSt.reception.seatSince;
+    tableJoined = sh->fSt.reception.tableJoined;
+    policy = &policies[sh->fSt.policy];
+
+    /* simulation of the life cycle of the receptionist, until the restaurant closes */
+    bool open = true;
+    request req[MAXGROUPS + 1];
+    int n, i;
+    while( open ) {
+        if (sh->fSt.eventLoop) {
+            n = waitForEvents(req);
+        }
+        else {
+            req[0] = waitForGroup();
+            n = 1;
+        }
+        for (i = 0; i < n; i++) {
+            switch(req[i].reqType) {
+                case TABLEREQ:
+                       provideTableOrWaitingRoom(req[i].reqGroup); //TODO param should be groupid
+                       break;
+                case BILLREQ:
+                       receivePayment(req[i].reqGroup);
+                       break;
+                case CLOSEREQ:
+                       open = false;
+                       break;
+            }
         }
-        nReq++;
     }
 
     /* unmapping the shared region off the process address space */
@@ -140,27 +232,59 @@ int main (int argc, char *argv[])
 }
 
 /**
- *  \brief decides table to occupy for group n or if it must wait.
+ *  \brief decides tables to occupy for group n or if it must wait.
  *
  *  Checks current state of tables and groups in order to decide table or wait.
+ *  The table with the fewest free seats that can seat the whole group is chosen (best fit);
+ *  a table in use is only considered if sharing is allowed. If no single table fits and
+ *  joining is allowed, vacant tables are joined, largest first, and the last one taken is
+ *  replaced by the smallest vacant table that still completes the group.
  *
- *  \return table id or -1 (in case of wait decision)
+ *  \return set of tables (bit mask) or 0 (in case of wait decision)
  */
-static int decideTableOrWait(int n)
+static unsigned int decideTableOrWait(int n)
 {
-    // Se o grupo ainda não chegou, não pode ser atribuído uma mesa
-    if(sh->fSt.st.groupStat[n] == ATRECEPTION && sh->fSt.assignedTable[n] == -1){
-        int occupied = 0;
-        // Verificar se há mesas ocupadas
-        for(int num = 0; num < sh->fSt.nGroups; num++)
-            if(sh->fSt.assignedTable[num] != -1)
-                occupied += 1 + sh->fSt.assignedTable[num];
-        if(occupied <= 1)
-            return 1;
-        if(occupied == 2)
-            return 0;
-    }
-    return -1;
+    int size = sh->fSt.groupSize[n];
+    int order[MAXTABLES], nVacant = 0;
+    int t, i, j, best = -1, free, seats;
+    unsigned int tables = 0;
+
+    // Só grupos que estão na receção e sem mesa podem receber uma mesa
+    if (sh->fSt.st.groupStat[n] != ATRECEPTION || sh->fSt.assignedTable[n] != -1)
+        return 0;
+
+    for (t = 0; t < sh->fSt.nTables; t++) {
+        if (sh->fSt.tableSeats[t] == 0)
+            order[nVacant++] = t;
+        else if (!sh->fSt.tableShare || tableJoined[t])
+            continue;
+        free = sh->fSt.tableCapacity[t] - sh->fSt.tableSeats[t];
+        if (free >= size && (best == -1 || free < sh->fSt.tableCapacity[best] - sh->fSt.tableSeats[best]))
+            best = t;
+    }
+    if (best != -1)
+        return 1u << best;
+    if (!sh->fSt.tableJoin)
+        return 0;
+
+    // Juntar mesas vagas, da maior para a menor, até caber o grupo
+    for (i = 1; i < nVacant; i++)
+        for (j = i; j > 0 && sh->fSt.tableCapacity[order[j]] > sh->fSt.tableCapacity[order[j-1]]; j--) {
+            t = order[j]; order[j] = order[j-1]; order[j-1] = t;
+        }
+    for (i = 0, seats = 0; i < nVacant && seats < size; i++) {
+        tables |= 1u << order[i];
+        seats += sh->fSt.tableCapacity[order[i]];
+    }
+    if (seats < size)
+        return 0;
+    for (j = nVacant - 1; j >= i; j--)
+        if (seats - sh->fSt.tableCapacity[order[i-1]] + sh->fSt.tableCapacity[order[j]] >= size) {
+            tables = (tables & ~(1u << order[i-1])) | (1u << order[j]);
+            break;
+        }
+
+    return tables;
 }
 
 /**
@@ -168,17 +292,135 @@ static int decideTableOrWait(int n)
  *         to decide which group (if any) should occupy it.
  *
  *  Checks current state of tables and groups in order to decide group.
+ *  Among the waiting groups that fit at the vacant seats, the one ranked first by the
+ *  scheduling policy is chosen.
+ *
+ *  \param tables where the tables for the chosen group are stored
  *
  *  \return group id or -1 (in case of wait decision)
  */
-static int decideNextGroup()
+static int decideNextGroup(unsigned int *tables)
+{
+    int g, next = -1;
+    unsigned int fit;
+
+    for (g = 0; g < sh->fSt.nGroups; g++)
+        if (groupRecord[g] == WAIT && (next == -1 || policy->key(g) < policy->key(next)) &&
+                (fit = decideTableOrWait(g)) != 0) {
+            next = g;
+            *tables = fit;
+        }
+
+    return next;
+}
+
+/**
+ *  \brief seats group n at a set of tables.
+ *
+ *  Updates shared (and internal) memory and statistics, then informs group that it may proceed.
+ *  Joined tables are fully taken by the group.
+ *  Must be called inside the critical region.
+ */
+static void seatGroup (int n, unsigned int tables)
+{
+    long long now = timeNow ();
+    bool joined = (tables & (tables - 1)) != 0;
+    int t;
+
+    for (t = sh->fSt.nTables - 1; t >= 0; t--) {
+        if (tables & (1u << t)) {
+            if (sh->fSt.tableSeats[t] == 0)
+                tableSince[t] = now;
+            sh->fSt.tableSeats[t] += joined ? sh->fSt.tableCapacity[t] : sh->fSt.groupSize[n];
+            tableJoined[t] = joined;
+            sh->fSt.assignedTable[n] = t;
+        }
+    }
+    sh->fSt.groupTables[n] = tables;
+    groupRecord[n] = ATTABLE;
+    seatSince[n] = now;
+    histAdd (&sh->fSt.tableWait, now - sh->fSt.arrivalTime[n]);
+
+    if (noticePost(semgid, sh, n, NOTE_TABLE) == -1) {
+        perror("error on the up operation for semaphore access");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ *  \brief group n leaves its tables.
+ *
+ *  Updates shared (and internal) memory and statistics.
+ *  Must be called inside the critical region.
+ */
+static void releaseTables (int n)
+{
+    long long now = timeNow ();
+    unsigned int tables = sh->fSt.groupTables[n];
+    bool joined = (tables & (tables - 1)) != 0;
+    int t;
+
+    for (t = 0; t < sh->fSt.nTables; t++) {
+        if (tables & (1u << t)) {
+            sh->fSt.tableSeats[t] -= joined ? sh->fSt.tableCapacity[t] : sh->fSt.groupSize[n];
+            if (sh->fSt.tableSeats[t] == 0) {
+                sh->fSt.tableBusy[t] += now - tableSince[t];
+                tableJoined[t] = false;
+            }
+        }
+    }
+    sh->fSt.seatBusy += sh->fSt.groupSize[n] * (now - seatSince[n]);
+    sh->fSt.admission.stayTime += now - seatSince[n];
+    sh->fSt.admission.stays += 1;
+    sh->fSt.assignedTable[n] = -1;
+    sh->fSt.groupTables[n] = 0;
+}
+
+/**
+ *  \brief changes the number of groups waiting for a table.
+ *
+ *  The number is integrated over time and its timeline updated.
+ *  Must be called inside the critical region.
+ *
+ *  \param delta change of the number of groups waiting
+ */
+static void changeWaiting (int delta)
+{
+    ADMISSION *a = &sh->fSt.admission;
+    long long now = timeNow ();
+
+    if (a->depthSince > 0) {
+        a->depthArea += sh->fSt.groupsWaiting * (now - a->depthSince);
+    }
+    a->depthSince = now;
+    sh->fSt.groupsWaiting += delta;
+    timelineSet (&a->depth, now - sh->fSt.startRun, sh->fSt.groupsWaiting);
+}
+
+/**
+ *  \brief decides if the group that checked in, that can not be seated, may wait for a table.
+ *
+ *  Must be called inside the critical region.
+ *
+ *  \return true if the group is admitted to the waiting room, false if it is turned away
+ */
+static bool admitGroup ()
 {
-    // Verificar se há grupos esperando
-    for(int num = 0; num < sh->fSt.nGroups; num++)
-        if(decideTableOrWait(num) != -1 && groupRecord[num] == WAIT)
-            return num;
+    ADMISSION *a = &sh->fSt.admission;
+    double estimate;
 
-    return -1;
+    if ((a->capacity >= 0) && (sh->fSt.groupsWaiting >= a->capacity)) {
+        a->rejectedFull += 1;
+        return false;
+    }
+    if ((a->policy == ADMIT_WAIT) && (a->stays > 0)) {
+        estimate = (double) a->stayTime / a->stays * (sh->fSt.groupsWaiting + 1) / sh->fSt.nTables;
+        if (estimate > 1000.0 * a->maxWait) {
+            a->rejectedWait += 1;
+            return false;
+        }
+    }
+    return true;
 }
 
 /**
@@ -193,6 +435,7 @@ static int decideNextGroup()
 static request waitForGroup()
 {
     request req;
+    long long waitStart;                                                  /* time at which waiting for a request */
     
     // Entrar na região crítica
     if (semDown(semgid, sh->mutex) == -1) {
@@ -211,10 +454,12 @@ static request waitForGroup()
     }
 
     // Aguardar uma solicitação
+    waitStart = timeNow ();
     if (semDown(semgid, sh->receptionistReq) == -1) {
         perror("error on the down operation for semaphore access");
         exit(EXIT_FAILURE);
     }
+    wakeupRecord (&sh->fSt, SRV_RECEPTIONIST, waitStart);
 
     // Reentrar na região crítica
     if (semDown(semgid, sh->mutex) == -1) {
@@ -242,12 +487,87 @@ static request waitForGroup()
 
 }
 
+/**
+ *  \brief receptionist waits for events and collects every request ready
+ *
+ *  Event-driven variant of waitForGroup. Receptionist updates state and waits on its event loop
+ *  until a request or the closing arrives; housekeeping ticks meanwhile record its heartbeat. Then it
+ *  takes every queued request in one pass, in the order they were made, and the closing last.
+ *  The internal state should be saved.
+ *
+ *  \param req requests collected
+ *
+ *  \return number of requests collected
+ */
+static int waitForEvents(request req[])
+{
+    unsigned long long count[NEVENTS + 1];
+    long long waitStart;                                                  /* time at which waiting for a request */
+    int n = 0, i;
+
+    // Entrar na região crítica
+    if (semDown(semgid, sh->mutex) == -1) {
+        perror("error on the down operation for semaphore access");
+        exit(EXIT_FAILURE);
+    }
+
+    // Inicializar o status do recepcionista
+    sh->fSt.st.receptionistStat = WAIT_FOR_REQUEST;
+    saveState(nFic, &sh->fSt);
+
+    // Sair da região crítica
+    if (semUp(semgid, sh->mutex) == -1) {
+        perror("error on the up operation for semaphore access");
+        exit(EXIT_FAILURE);
+    }
+
+    // Aguardar eventos
+    waitStart = timeNow ();
+    do {
+        if (eventWait(count) == -1) {
+            perror("error on waiting for events");
+            exit(EXIT_FAILURE);
+        }
+        if (count[EV_TICK] > 0) {
+            sh->fSt.heartbeat[SRV_RECEPTIONIST] = timeNow ();
+        }
+    } while ((count[EV_RECEPTIONIST] == 0) && (count[EV_CLOSERECEPT] == 0));
+    wakeupRecord (&sh->fSt, SRV_RECEPTIONIST, waitStart);
+
+    // Reentrar na região crítica e esvaziar a fila de pedidos
+    if (semDown(semgid, sh->mutex) == -1) {
+        perror("error on the down operation for semaphore access");
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < sh->fSt.receptionistQueue.n; i++) {
+        req[n++] = sh->fSt.receptionistQueue.req[i];
+    }
+    sh->fSt.receptionistQueue.n = 0;
+
+    // Sair da região crítica
+    if (semUp(semgid, sh->mutex) == -1) {
+        perror("error on the up operation for semaphore access");
+        exit(EXIT_FAILURE);
+    }
+
+    if (count[EV_CLOSERECEPT] > 0) {
+        req[n].reqGroup = -1;
+        req[n++].reqType = CLOSEREQ;
+    }
+    if (n > 0) {
+        histAdd (&sh->fSt.batch[SRV_RECEPTIONIST], n);
+    }
+
+    return n;
+}
+
 /**
  *  \brief receptionist decides if group should occupy table or wait
  *
- *  Receptionist updates state and then decides if group occupies table
- *  or waits. Shared (and internal) memory may need to be updated.
- *  If group occupies table, it must be informed that it may proceed. 
+ *  Receptionist updates state and then decides if group occupies table,
+ *  waits or, if the admission policy does not let it wait, is turned away.
+ *  Shared (and internal) memory may need to be updated.
+ *  If group occupies table or is turned away, it must be informed that it may proceed. 
  *  The internal state should be saved.
  *
  */
@@ -262,17 +582,26 @@ static void provideTableOrWaitingRoom (int n)
     sh->fSt.st.receptionistStat = ASSIGNTABLE;
     saveState(nFic, &sh->fSt);
 
-    // Verificar se o grupo pode ser atribuído a uma mesa
-    if(groupRecord[n] == TOARRIVE){
-        if((sh->fSt.assignedTable[n] = decideTableOrWait(n)) != -1){
-            if (semUp(semgid, sh->waitForTable[n]) == -1) {
+    // Verificar se o grupo pode ser atribuído a uma mesa (um grupo novo pode reutilizar o id de um que já saiu)
+    if(groupRecord[n] == TOARRIVE || groupRecord[n] == DONE){
+        unsigned int tables;
+
+        checkInOrder[n] = sh->fSt.reception.nCheckIns++;
+        if((tables = decideTableOrWait(n)) != 0){
+            seatGroup(n, tables);
+            sh->fSt.admission.admitted++;
+        }else if(admitGroup()){
+            groupRecord[n] = WAIT;
+            changeWaiting(1);
+            sh->fSt.admission.admitted++;
+        }else{
+            // O grupo é recusado e sai de imediato
+            groupRecord[n] = DONE;
+            sh->fSt.rejected[n] = true;
+            if (noticePost(semgid, sh, n, NOTE_TABLE) == -1) {
                 perror("error on the up operation for semaphore access");
                 exit(EXIT_FAILURE);
             }
-            groupRecord[n] = ATTABLE;
-        }else{
-            groupRecord[n] = WAIT;
-            sh->fSt.groupsWaiting++;
         }
     }
 
@@ -300,39 +629,32 @@ static void receivePayment (int n)
         exit (EXIT_FAILURE);
     }
 
-    // Obter a mesa que ficou vaga
-    int table_vacant;
+    // Mesas que ficam vagas
     int new_table_group;
+    unsigned int tables;
 
     // Atualizar o status do recepcionista para RECVPAY
     sh->fSt.st.receptionistStat = RECVPAY;
     saveState(nFic, &sh->fSt);
 
     // Marcar que o grupo abandonou a mesa
-    if (semUp(semgid, sh->tableDone[table_vacant = sh->fSt.assignedTable[n]]) == -1) {
+    if (noticePost(semgid, sh, n, NOTE_PAID) == -1) {
         perror("error on the up operation for semaphore access");
         exit(EXIT_FAILURE);
     }
 
     // Marcar que o grupo completou sua refeição
     groupRecord[n] = DONE;
-    sh->fSt.assignedTable[n] = -1;
+    releaseTables(n);
 
-    // Verificar se há grupos esperando
+    // Verificar se há grupos esperando que cabem nos lugares livres
     if(sh->fSt.groupsWaiting > 0){
         sh->fSt.st.receptionistStat = ASSIGNTABLE;
         saveState(nFic, &sh->fSt);
-        // Verificar se há mesas disponíveis
-        if((new_table_group = decideNextGroup()) != -1){
-            sh->fSt.assignedTable[new_table_group] = table_vacant;
-            groupRecord[n] = ATTABLE;
+        while((new_table_group = decideNextGroup(&tables)) != -1){
             // Sinalizar que o grupo pode ser alocado a uma mesa
-            if (semUp(semgid, sh->waitForTable[new_table_group]) == -1) {
-                perror("error on the up operation for semaphore access");
-                exit(EXIT_FAILURE);
-            }
-            
-            sh->fSt.groupsWaiting--;
+            seatGroup(new_table_group, tables);
+            changeWaiting(-1);
         }
     }
 
@@ -8,8 +8,16 @@
  *
  *  Definition of the operations carried out by the waiter:
  *     \li waitForClientOrChef
+ *     \li waitForEvents
  *     \li informChef
  *     \li takeFoodToTable
+ *     \li closeKitchen
+ *
+ *  With <tt>#events ON</tt> the waiter runs an event loop (waitForEvents) on the channels of the group
+ *  requests, of the ready food notices and of the closing, instead of waiting on waiterRequest.
+ *
+ *  The groups are told that their request was received and that their food arrived by notices (see
+ *  notice.h).
  *
  *  \author Nuno Lau - December 2023
  */
@@ -29,6 +37,11 @@
 #include "sharedDataSync.h"
 #include "semaphore.h"
 #include "sharedMemory.h"
+#include "replay.h"
+#include "statistics.h"
+#include "events.h"
+#include "jitter.h"
+#include "notice.h"
 
 /** \brief logging file name */
 static char nFic[51];
@@ -45,11 +58,17 @@ static SHARED_DATA *sh;
 /** \brief waiter waits for next request */
 static request waitForClientOrChef ();
 
+/** \brief waiter waits for events and collects every request ready */
+static int waitForEvents (request req[]);
+
 /** \brief waiter takes food order to chef */
 static void informChef(int group);
 
-/** \brief waiter takes food to table */
-static void takeFoodToTable (int group);
+/** \brief waiter takes all ready food to tables */
+static void takeFoodToTable ();
+
+/** \brief waiter tells chef that the restaurant is closing */
+static void closeKitchen ();
 
 /**
  *  \brief Main program.
@@ -60,6 +79,7 @@ int main (int argc, char *argv[])
 {
     int key;                                            /*access key to shared memory and semaphore set */
     char *tinp;                                                       /* numerical parameters test flag */
+    long long gate;                                    /* time blocked waiting for the start of operations */
 
     /* validation of command line parameters */
     if (argc != 4) { 
@@ -81,10 +101,12 @@ int main (int argc, char *argv[])
 
     /* connection to the semaphore set and the shared memory region and mapping the shared region onto the
        process address space */
+    gate = timeNow ();
     if ((semgid = semConnect (key)) == -1) { 
         perror ("error on connecting to the semaphore set");
         return EXIT_FAILURE;
     }
+    gate = timeNow () - gate;
     if ((shmid = shmemConnect (key)) == -1) { 
         perror ("error on connecting to the shared memory region");
         return EXIT_FAILURE;
@@ -94,23 +116,49 @@ int main (int argc, char *argv[])
         return EXIT_FAILURE;
     }
 
-    /* initialize random generator */
-    srandom ((unsigned int) getpid ());              
-
-    /* simulation of the life cycle of the waiter */
-    int nReq = 0;
-    request req;
-    while (nReq < sh->fSt.nGroups * 2) {
-        req = waitForClientOrChef();
-        switch (req.reqType) {
-            case FOODREQ:
-                informChef(req.reqGroup);
-                break;
-            case FOODREADY:
-                takeFoodToTable(req.reqGroup);
-                break;
+    /* initialize the record or replay of grants */
+    if (sh->fSt.replay != REPLAY_OFF) {
+        replayAttach (semgid, REPLAY_WAITER);
+    }
+    jitterStart (&sh->fSt, REPLAY_WAITER);
+    if (sh->fSt.semTiming) {
+        semTimingStart (&sh->fSt, semgid);
+    }
+    if (sh->fSt.groupHosts > 0) {
+        semSetNotify (semgid, sh->fSt.semNotify, SEM_NU + 1, GROUPHOST);
+    }
+    if (sh->fSt.eventLoop && (eventLoopCreate (sh->fSt.eventFd, EV_WAITER, EV_CLOSEWAITER - EV_WAITER + 1, sh->fSt.eventTick) == -1)) {
+        perror ("error on creating the event loop");
+        return EXIT_FAILURE;
+    }
+    startupRecord (&sh->fSt, SRV_WAITER, sh->fSt.serverSpawn[SRV_WAITER], gate);
+
+    /* simulation of the life cycle of the waiter, until the restaurant closes */
+    bool open = true;
+    request req[MAXGROUPS + 2];
+    int n, i;
+    while (open) {
+        if (sh->fSt.eventLoop) {
+            n = waitForEvents(req);
+        }
+        else {
+            req[0] = waitForClientOrChef();
+            n = 1;
+        }
+        for (i = 0; i < n; i++) {
+            switch (req[i].reqType) {
+                case FOODREQ:
+                    informChef(req[i].reqGroup);
+                    break;
+                case FOODREADY:
+                    takeFoodToTable();
+                    break;
+                case CLOSEREQ:
+                    closeKitchen();
+                    open = false;
+                    break;
+            }
         }
-        nReq++;
     }
 
     /* unmapping the shared region off the process address space */
@@ -126,7 +174,8 @@ int main (int argc, char *argv[])
  *  \brief waiter waits for next request 
  *
  *  Waiter updates state and waits for request from group or from chef, then reads request.
- *  The waiter should signal that new requests are possible.
+ *  Chef notifications (ready food) are served first; they do not use the request slot.
+ *  The waiter should signal that new requests are possible after reading a group request.
  *  The internal state should be saved.
  *
  *  \return request submitted by group or chef
@@ -134,6 +183,8 @@ int main (int argc, char *argv[])
 static request waitForClientOrChef()
 {
     request req;
+    bool fromGroup;
+    long long waitStart;                                                  /* time at which waiting for a request */
     
     if (semDown (semgid, sh->mutex) == -1) {                                                    /* entra na região crítica */
         perror ("error on the up operation for semaphore access (WT)");
@@ -148,27 +199,35 @@ static request waitForClientOrChef()
         exit(EXIT_FAILURE);
     }
 
+    waitStart = timeNow ();
     if (semDown (semgid, sh->waiterRequest) == -1) {                                            /* aguarda pedido */
         perror ("error on the down operation for semaphore waitingRequest (WT)");
         exit (EXIT_FAILURE);
     }
+    wakeupRecord (&sh->fSt, SRV_WAITER, waitStart);
 
     if (semDown (semgid, sh->mutex) == -1) {                                                    /* entra na região crítica */
         perror ("error on the up operation for semaphore access (WT)");
         exit (EXIT_FAILURE);
     }
 
-    // Ler o pedido do cliente ou chef
-    req.reqGroup = sh->fSt.waiterRequest.reqGroup;
-    req.reqType = sh->fSt.waiterRequest.reqType;
-
+    // Comida pronta tem prioridade; caso contrário ler o pedido do cliente
+    fromGroup = !sh->fSt.foodReadyPending;
+    if (fromGroup) {
+        req.reqGroup = sh->fSt.waiterRequest.reqGroup;
+        req.reqType = sh->fSt.waiterRequest.reqType;
+    }
+    else {
+        req.reqGroup = -1;
+        req.reqType = FOODREADY;
+    }
     
     if (semUp(semgid, sh->mutex) == -1) {                                                       /* sai da região crítica */
         perror("error on the up operation for semaphore access (WT)");
         exit(EXIT_FAILURE);
     }
 
-    if (semUp(semgid, sh->waiterRequestPossible) == -1) {                                       /* sinaliza que o pedido foi recebido */
+    if (fromGroup && semUp(semgid, sh->waiterRequestPossible) == -1) {                          /* sinaliza que o pedido foi recebido */
         perror ("error on the up operation for semaphore access (WT)");
         exit (EXIT_FAILURE);
     }
@@ -176,6 +235,81 @@ static request waitForClientOrChef()
     return req;
 }
 
+/**
+ *  \brief waiter waits for events and collects every request ready
+ *
+ *  Event-driven variant of waitForClientOrChef. Waiter updates state and waits on its event loop
+ *  until a request, a ready food notice or the closing arrives; housekeeping ticks meanwhile record
+ *  its heartbeat. Then it takes every request ready in one pass: ready food first, the queued group
+ *  requests in the order they were made and the closing last.
+ *  The internal state should be saved.
+ *
+ *  \param req requests collected
+ *
+ *  \return number of requests collected
+ */
+static int waitForEvents(request req[])
+{
+    unsigned long long count[NEVENTS + 1];
+    long long waitStart;                                                  /* time at which waiting for a request */
+    int n = 0, i;
+
+    if (semDown (semgid, sh->mutex) == -1) {                                                    /* entra na região crítica */
+        perror ("error on the up operation for semaphore access (WT)");
+        exit (EXIT_FAILURE);
+    }
+
+    sh->fSt.st.waiterStat = WAIT_FOR_REQUEST;                                                   /* atualiza estado do empregado de mesa */
+    saveState(nFic, &sh->fSt);
+
+    if (semUp(semgid, sh->mutex) == -1) {                                                       /* sai da região crítica */
+        perror("error on the up operation for semaphore access (WT)");
+        exit(EXIT_FAILURE);
+    }
+
+    waitStart = timeNow ();
+    do {                                                                                        /* aguarda eventos */
+        if (eventWait (count) == -1) {
+            perror ("error on waiting for events (WT)");
+            exit (EXIT_FAILURE);
+        }
+        if (count[EV_TICK] > 0) {
+            sh->fSt.heartbeat[SRV_WAITER] = timeNow ();
+        }
+    } while ((count[EV_WAITER] == 0) && (count[EV_FOODREADY] == 0) && (count[EV_CLOSEWAITER] == 0));
+    wakeupRecord (&sh->fSt, SRV_WAITER, waitStart);
+
+    if (semDown (semgid, sh->mutex) == -1) {                                                    /* entra na região crítica */
+        perror ("error on the up operation for semaphore access (WT)");
+        exit (EXIT_FAILURE);
+    }
+
+    // Comida pronta tem prioridade; depois os pedidos dos clientes, pela ordem em que foram feitos
+    if (sh->fSt.foodReadyPending) {
+        req[n].reqGroup = -1;
+        req[n++].reqType = FOODREADY;
+    }
+    for (i = 0; i < sh->fSt.waiterQueue.n; i++) {
+        req[n++] = sh->fSt.waiterQueue.req[i];
+    }
+    sh->fSt.waiterQueue.n = 0;
+
+    if (semUp(semgid, sh->mutex) == -1) {                                                       /* sai da região crítica */
+        perror("error on the up operation for semaphore access (WT)");
+        exit(EXIT_FAILURE);
+    }
+
+    if (count[EV_CLOSEWAITER] > 0) {
+        req[n].reqGroup = -1;
+        req[n++].reqType = CLOSEREQ;
+    }
+    if (n > 0) {
+        histAdd (&sh->fSt.batch[SRV_WAITER], n);
+    }
+
+    return n;
+}
+
 /**
  *  \brief waiter takes food order to chef 
  *
@@ -187,9 +321,6 @@ static request waitForClientOrChef()
  */
 static void informChef(int group)
 {
-    // Criar variável para guardar o id da mesa
-    int tableId;
-
     if (semDown (semgid, sh->mutex) == -1) {                                                  /* entra na região crítica */
         perror ("error on the up operation for semaphore access (WT)");
         exit (EXIT_FAILURE);
@@ -203,14 +334,12 @@ static void informChef(int group)
     sh->fSt.foodGroup = group;
     sh->fSt.foodOrder = 1;
 
+    sh->fSt.wakeupStamp[SRV_CHEF] = timeNow ();
     if (semUp(semgid, sh->waitOrder) == -1) {                                                  /* sinaliza que o pedido foi feito */
         perror ("error on the up operation for semaphore access (WT)");
         exit (EXIT_FAILURE);
     }
 
-    // Usar o grupo para obter o id da mesa
-    tableId = sh->fSt.assignedTable[group];
-
     if (semUp(semgid, sh->mutex) == -1) {                                                       /* sai da região crítica */
         perror("error on the up operation for semaphore access (mutex)");
         exit(EXIT_FAILURE);
@@ -222,7 +351,7 @@ static void informChef(int group)
         exit(EXIT_FAILURE);
     }
 
-    if (semUp(semgid, sh->requestReceived[tableId]) == -1) {                                     /* sinaliza que o pedido foi recebido pelo cozinheiro */
+    if (noticePost(semgid, sh, group, NOTE_REQUEST) == -1) {                                     /* sinaliza que o pedido foi recebido pelo cozinheiro */
         perror ("error on the up operation for semaphore access (WT)");
         exit (EXIT_FAILURE);
     }
@@ -231,13 +360,16 @@ static void informChef(int group)
 /**
  *  \brief waiter takes food to table 
  *
- *  Waiter updates its state and takes food to table, allowing the meal to start.
- *  Group must be informed that food is available.
+ *  Waiter updates its state and takes every ready order to its table in a single trip,
+ *  allowing the meals to start. The request that triggered the trip may be followed by
+ *  other orders that became ready meanwhile; all of them are delivered.
+ *  Each group must be informed that food is available.
  *  The internal state should be saved.
- *
  */
-static void takeFoodToTable(int group)
+static void takeFoodToTable()
 {
+    int i;
+
     if (semDown (semgid, sh->mutex) == -1) {                                                  /* entra na região crítica */
         perror ("error on the up operation for semaphore access (WT)");
         exit (EXIT_FAILURE);
@@ -247,14 +379,45 @@ static void takeFoodToTable(int group)
     sh->fSt.st.waiterStat = TAKE_TO_TABLE;
     saveState(nFic, &sh->fSt);
 
-    // Sinalizar que a comida está pronta para ser servida na mesa
-    if (semUp(semgid, sh->foodArrived[sh->fSt.assignedTable[group]]) == -1) {
-        perror("error on the up operation for semaphore access (foodArrived)");
-        exit(EXIT_FAILURE);
+    // Sinalizar a cada grupo que a comida está pronta
+    for (i = 0; i < sh->fSt.nFoodReady; i++) {
+        if (noticePost(semgid, sh, sh->fSt.foodReady[i], NOTE_FOOD) == -1) {
+            perror("error on the up operation for semaphore access (foodArrived)");
+            exit(EXIT_FAILURE);
+        }
     }
+    sh->fSt.nFoodReady = 0;
+    sh->fSt.foodReadyPending = false;
 
     if (semUp(semgid, sh->mutex) == -1) {                                                   /* sai da região crítica */
         perror("error on the up operation for semaphore access (mutex)");
         exit(EXIT_FAILURE);
     }
 }
+
+/**
+ *  \brief waiter tells chef that the restaurant is closing 
+ *
+ *  Waiter passes the closing request on to the chef as an order for no group (-1).
+ *  The chef does not acknowledge it.
+ */
+static void closeKitchen()
+{
+    if (semDown (semgid, sh->mutex) == -1) {                                                  /* entra na região crítica */
+        perror ("error on the up operation for semaphore access (WT)");
+        exit (EXIT_FAILURE);
+    }
+
+    sh->fSt.foodGroup = -1;
+    sh->fSt.foodOrder = 1;
+
+    if (semUp(semgid, sh->waitOrder) == -1) {                                                  /* sinaliza o fecho ao cozinheiro */
+        perror ("error on the up operation for semaphore access (WT)");
+        exit (EXIT_FAILURE);
+    }
+
+    if (semUp(semgid, sh->mutex) == -1) {                                                       /* sai da região crítica */
+        perror("error on the up operation for semaphore access (mutex)");
+        exit(EXIT_FAILURE);
+    }
+}
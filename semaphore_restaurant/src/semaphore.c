@@ -9,20 +9,67 @@
  *     \li destruction of a previously created set of semaphores
  *     \li signalling start of operations
  *     \li <em>down</em> of a semaphore within the set
- *     \li <em>up</em> of a semaphore within the set.
+ *     \li <em>up</em> of a semaphore within the set
+ *     \li <em>down</em> of a semaphore within the set, with a time limit
+ *     \li reading and setting the values of all the semaphores of the set
+ *     \li setting functions to be called around every <em>down</em>
+ *     \li measuring the time from an <em>up</em> until the <em>down</em> it unblocks returns
+ *     \li yielding, instead of blocking, on a <em>down</em> (coroutines)
+ *     \li notifying the <em>ups</em> of a semaphore to the processes that host coroutines waiting on it.
  *
  *  \author António Rui Borges - October 1995
  */
 
+#define _GNU_SOURCE                                                                       /* semtimedop */
+
 #include <stdio.h>
 #include <sys/types.h>
 #include <sys/ipc.h>
 #include <sys/sem.h>
 #include <assert.h>
+#include <errno.h>
+#include <time.h>
 
 /** \brief access permission: user r-w */
 #define  MASK           0600
 
+/** \brief argument of semctl (to be defined by the caller) */
+union semun {
+  int val;
+  struct semid_ds *buf;
+  unsigned short *array;
+};
+
+/** \brief functions called before and after every down (NULL if none) */
+static void (*beforeDown) (int semgid, unsigned int sindex);
+static void (*afterDown) (int semgid, unsigned int sindex);
+
+/** \brief timed set (-1 if none), time of the last up of each of its semaphores (ns) and function given the
+           time from an up until a blocked down returns */
+static int timedgid = -1;
+static long long *upStamp;
+static unsigned int timedNum;
+static void (*wakeup) (unsigned int sindex, long long ns);
+
+/** \brief function called instead of blocking on a down (NULL if none) */
+static void (*yieldDown) (unsigned int sindex);
+
+/** \brief notified set (-1 if none), hosts to notify of the ups of each of its semaphores (bit mask) and
+           location of the semaphore of host 0 */
+static int notifygid = -1;
+static unsigned int *notifyMask;
+static unsigned int notifyNum;
+static unsigned int notifyBase;
+
+/** \brief reading the monotonic clock (ns) */
+static long long clockNs (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
 /**
  *  \brief Creation of a set of semaphores.
  *
@@ -102,6 +149,12 @@ int semSignal (int semgid)
  *  \brief <em>Down</em> of a semaphore within the set.
  *
  *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *  The operation is resumed if it is interrupted by a signal handler.
+ *  The functions set by semSetHooks are called before the operation and after it succeeds.
+ *  If the set is timed (see semSetTiming), the operation is first tried without blocking; if it has to
+ *  block, the time since the last <em>up</em> is reported once it returns.
+ *  If a yield function is set (see semSetYield), the operation never blocks: it is tried again each time
+ *  the function returns.
  *
  *  \param semgid set identifier
  *  \param sindex semaphore location in the set (1 .. snum)
@@ -114,15 +167,45 @@ int semDown (int semgid, unsigned int sindex)
 {
   struct sembuf down = { 0, -1, 0 };                                                      /* specific down operation */
 
+  int stat, yielded = 0;
+
   assert(sindex>0);
   down.sem_num = (unsigned short) sindex;
-  return semop (semgid, &down, 1);
+  if (beforeDown != NULL)
+     beforeDown (semgid, sindex);
+  if (yieldDown != NULL) {
+     down.sem_flg = IPC_NOWAIT;
+     while (((stat = semop (semgid, &down, 1)) == -1) && ((errno == EAGAIN) || (errno == EINTR)))
+       if (errno == EAGAIN) {
+          yieldDown (sindex);
+          yielded = 1;
+       }
+     if ((stat == 0) && yielded && (semgid == timedgid) && (sindex < timedNum))
+        wakeup (sindex, clockNs () - upStamp[sindex]);
+  }
+  else if ((semgid == timedgid) && (sindex < timedNum)) {
+     down.sem_flg = IPC_NOWAIT;
+     if (((stat = semop (semgid, &down, 1)) == -1) && (errno == EAGAIN)) {
+        down.sem_flg = 0;
+        while (((stat = semop (semgid, &down, 1)) == -1) && (errno == EINTR))
+          ;
+        if (stat == 0)
+           wakeup (sindex, clockNs () - upStamp[sindex]);
+     }
+  }
+  else while (((stat = semop (semgid, &down, 1)) == -1) && (errno == EINTR))
+         ;
+  if ((stat == 0) && (afterDown != NULL))
+     afterDown (semgid, sindex);
+  return stat;
 }
 
 /**
  *  \brief <em>Up</em> of a semaphore within the set.
  *
  *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *  If the set is timed (see semSetTiming), the time of the operation is saved.
+ *  If the set is notified (see semSetNotify), the hosts registered for the semaphore are then notified.
  *
  *  \param semgid set identifier
  *  \param sindex semaphore location in the set (1 .. snum)
@@ -134,8 +217,173 @@ int semDown (int semgid, unsigned int sindex)
 int semUp (int semgid, unsigned int sindex)
 {
   struct sembuf up = { 0, 1, 0 };                                                           /* specific up operation */
+  struct sembuf notify[32];                                                             /* up of the hosts to notify */
+  unsigned int mask, n = 0;
 
   assert(sindex>0);
   up.sem_num = (unsigned short) sindex;
-  return semop (semgid, &up, 1);
+  if ((semgid == timedgid) && (sindex < timedNum))
+     upStamp[sindex] = clockNs ();
+  if (semop (semgid, &up, 1) == -1)
+     return -1;
+  if ((semgid != notifygid) || (sindex >= notifyNum))
+     return 0;
+  mask = __atomic_load_n (&notifyMask[sindex], __ATOMIC_SEQ_CST);     /* read after the up, see semSetNotify */
+  for (; mask != 0; mask &= mask - 1) {
+    notify[n].sem_num = (unsigned short) (notifyBase + __builtin_ctz (mask));
+    notify[n].sem_op = 1;
+    notify[n++].sem_flg = 0;
+  }
+  return (n == 0) ? 0 : semop (semgid, notify, n);
+}
+
+/**
+ *  \brief <em>Down</em> of a semaphore within the set, with a time limit.
+ *
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *  It is not resumed if it is interrupted by a signal handler, and no function set by semSetHooks,
+ *  semSetTiming or semSetYield is called.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param timeout time limit (us, 0 to return at once if the operation would block)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>, EAGAIN if the
+ *  time limit expired, EINTR if interrupted)
+ */
+
+int semTimedDown (int semgid, unsigned int sindex, long long timeout)
+{
+  struct sembuf down = { 0, -1, 0 };                                                      /* specific down operation */
+  struct timespec limit;
+
+  assert(sindex>0);
+  down.sem_num = (unsigned short) sindex;
+  if (timeout <= 0) {
+     down.sem_flg = IPC_NOWAIT;
+     return semop (semgid, &down, 1);
+  }
+  limit.tv_sec = timeout / 1000000;
+  limit.tv_nsec = (timeout % 1000000) * 1000;
+  return semtimedop (semgid, &down, 1, &limit);
+}
+
+/**
+ *  \brief Reading the values of all the semaphores of the set.
+ *
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param val location where the values are stored (indexed by location, 0 .. snum)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semGetAll (int semgid, unsigned short val[])
+{
+  union semun arg;
+
+  arg.array = val;
+  return semctl (semgid, 0, GETALL, arg);
+}
+
+/**
+ *  \brief Setting the values of all the semaphores of the set.
+ *
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *  Processes blocked on the semaphores whose values allow it are woken up.
+ *
+ *  \param semgid set identifier
+ *  \param val values (indexed by location, 0 .. snum)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+int semSetAll (int semgid, unsigned short val[])
+{
+  union semun arg;
+
+  arg.array = val;
+  return semctl (semgid, 0, SETALL, arg);
+}
+
+/**
+ *  \brief Setting functions to be called around every <em>down</em>.
+ *
+ *  They are called with the set identifier and the semaphore location, and may themselves call semDown.
+ *
+ *  \param before function called before the operation (NULL for none)
+ *  \param after function called after the operation succeeds (NULL for none)
+ */
+
+void semSetHooks (void (*before) (int, unsigned int), void (*after) (int, unsigned int))
+{
+  beforeDown = before;
+  afterDown = after;
+}
+
+/**
+ *  \brief Measuring the time from an <em>up</em> until the <em>down</em> it unblocks returns.
+ *
+ *  Each <em>up</em> of a semaphore of the set saves its time in <tt>stamps</tt>, which should be in shared
+ *  memory so every process sees the <em>ups</em> of the others. When a <em>down</em> that had to block returns,
+ *  <tt>record</tt> is called with the time elapsed since the last <em>up</em>: the cost of waking up the
+ *  process, not the time it waited. If several <em>ups</em> are made before the process runs, only the
+ *  last one is taken.
+ *
+ *  \param semgid set identifier (-1 to stop measuring)
+ *  \param stamps time of the last up of each semaphore (ns, indexed by location)
+ *  \param snum number of locations in <tt>stamps</tt>
+ *  \param record function given the semaphore location and the time (ns)
+ */
+
+void semSetTiming (int semgid, long long *stamps, unsigned int snum, void (*record) (unsigned int, long long))
+{
+  timedgid = semgid;
+  upStamp = stamps;
+  timedNum = snum;
+  wakeup = record;
+}
+
+/**
+ *  \brief Yielding, instead of blocking, on a <em>down</em>.
+ *
+ *  Meant for a process that runs several coroutines: from then on, a <em>down</em> that would block calls
+ *  <tt>yield</tt>, which should switch to another coroutine and return when the operation is worth trying
+ *  again.
+ *
+ *  \param yield function given the semaphore location (NULL to block again)
+ */
+
+void semSetYield (void (*yield) (unsigned int))
+{
+  yieldDown = yield;
+}
+
+/**
+ *  \brief Notifying the <em>ups</em> of a semaphore to the processes that host coroutines waiting on it.
+ *
+ *  Host h has a semaphore of its own, at location <tt>base + h</tt>, on which it blocks when none of its
+ *  coroutines can run. It sets bit h of <tt>mask[sindex]</tt>, which should be in shared memory, before
+ *  its last try of a <em>down</em> of semaphore sindex; after every <em>up</em> of semaphore sindex the semaphores
+ *  of the hosts whose bits are set are <em>upped</em> as well. As the mask is read after the <em>up</em>,
+ *  either the last try of the host succeeds or the host is notified.
+ *
+ *  To be called by every process that makes <em>ups</em> on the set.
+ *
+ *  \param semgid set identifier (-1 to stop notifying)
+ *  \param mask hosts to notify of the ups of each semaphore (bit mask, indexed by location)
+ *  \param snum number of locations in <tt>mask</tt>
+ *  \param base location of the semaphore of host 0
+ */
+
+void semSetNotify (int semgid, unsigned int *mask, unsigned int snum, unsigned int base)
+{
+  notifygid = semgid;
+  notifyMask = mask;
+  notifyNum = snum;
+  notifyBase = base;
 }
@@ -9,7 +9,13 @@
  *     \li destruction of a previously created set of semaphores
  *     \li signalling start of operations
  *     \li <em>down</em> of a semaphore within the set
- *     \li <em>up</em> of a semaphore within the set.
+ *     \li <em>up</em> of a semaphore within the set
+ *     \li <em>down</em> of a semaphore within the set, with a time limit
+ *     \li reading and setting the values of all the semaphores of the set
+ *     \li setting functions to be called around every <em>down</em>
+ *     \li measuring the time from an <em>up</em> until the <em>down</em> it unblocks returns
+ *     \li yielding, instead of blocking, on a <em>down</em> (coroutines)
+ *     \li notifying the <em>ups</em> of a semaphore to the processes that host coroutines waiting on it.
  *
  *  \author António Rui Borges - October 1995
  */
@@ -75,6 +81,10 @@ extern int semSignal (int semgid);
  *  \brief <em>Down</em> of a semaphore within the set.
  *
  *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *  The operation is resumed if it is interrupted by a signal handler.
+ *  The functions set by semSetHooks are called before the operation and after it succeeds.
+ *  If the set is timed (see semSetTiming), the operation is first tried without blocking; if it has to
+ *  block, the time since the last <em>up</em> is reported once it returns.
  *
  *  \param semgid set identifier
  *  \param sindex semaphore location in the set (1 .. snum)
@@ -89,6 +99,7 @@ extern int semDown (int semgid, unsigned int sindex);
  *  \brief <em>Up</em> of a semaphore within the set.
  *
  *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *  If the set is timed (see semSetTiming), the time of the operation is saved.
  *
  *  \param semgid set identifier
  *  \param sindex semaphore location in the set (1 .. snum)
@@ -99,4 +110,110 @@ extern int semDown (int semgid, unsigned int sindex);
 
 extern int semUp (int semgid, unsigned int sindex);
 
+/**
+ *  \brief <em>Down</em> of a semaphore within the set, with a time limit.
+ *
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *  It is not resumed if it is interrupted by a signal handler, and no function set by semSetHooks,
+ *  semSetTiming or semSetYield is called.
+ *
+ *  \param semgid set identifier
+ *  \param sindex semaphore location in the set (1 .. snum)
+ *  \param timeout time limit (us, 0 to return at once if the operation would block)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>, EAGAIN if the
+ *  time limit expired, EINTR if interrupted)
+ */
+
+extern int semTimedDown (int semgid, unsigned int sindex, long long timeout);
+
+/**
+ *  \brief Reading the values of all the semaphores of the set.
+ *
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *
+ *  \param semgid set identifier
+ *  \param val location where the values are stored (indexed by location, 0 .. snum)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+extern int semGetAll (int semgid, unsigned short val[]);
+
+/**
+ *  \brief Setting the values of all the semaphores of the set.
+ *
+ *  The function fails if there is no semaphore set with an identifier equal to <tt>semgid</tt>.
+ *  Processes blocked on the semaphores whose values allow it are woken up.
+ *
+ *  \param semgid set identifier
+ *  \param val values (indexed by location, 0 .. snum)
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+
+extern int semSetAll (int semgid, unsigned short val[]);
+
+/**
+ *  \brief Setting functions to be called around every <em>down</em>.
+ *
+ *  They are called with the set identifier and the semaphore location, and may themselves call semDown.
+ *
+ *  \param before function called before the operation (NULL for none)
+ *  \param after function called after the operation succeeds (NULL for none)
+ */
+
+extern void semSetHooks (void (*before) (int semgid, unsigned int sindex), void (*after) (int semgid, unsigned int sindex));
+
+/**
+ *  \brief Measuring the time from an <em>up</em> until the <em>down</em> it unblocks returns.
+ *
+ *  Each <em>up</em> of a semaphore of the set saves its time in <tt>stamps</tt>, which should be in shared
+ *  memory so every process sees the <em>ups</em> of the others. When a <em>down</em> that had to block returns,
+ *  <tt>record</tt> is called with the time elapsed since the last <em>up</em>: the cost of waking up the
+ *  process, not the time it waited. If several <em>ups</em> are made before the process runs, only the
+ *  last one is taken.
+ *
+ *  \param semgid set identifier (-1 to stop measuring)
+ *  \param stamps time of the last up of each semaphore (ns, indexed by location)
+ *  \param snum number of locations in <tt>stamps</tt>
+ *  \param record function given the semaphore location and the time (ns)
+ */
+
+extern void semSetTiming (int semgid, long long *stamps, unsigned int snum, void (*record) (unsigned int sindex, long long ns));
+
+/**
+ *  \brief Yielding, instead of blocking, on a <em>down</em>.
+ *
+ *  Meant for a process that runs several coroutines: from then on, a <em>down</em> that would block calls
+ *  <tt>yield</tt>, which should switch to another coroutine and return when the operation is worth trying
+ *  again.
+ *
+ *  \param yield function given the semaphore location (NULL to block again)
+ */
+
+extern void semSetYield (void (*yield) (unsigned int sindex));
+
+/**
+ *  \brief Notifying the <em>ups</em> of a semaphore to the processes that host coroutines waiting on it.
+ *
+ *  Host h has a semaphore of its own, at location <tt>base + h</tt>, on which it blocks when none of its
+ *  coroutines can run. It sets bit h of <tt>mask[sindex]</tt>, which should be in shared memory, before
+ *  its last try of a <em>down</em> of semaphore sindex; after every <em>up</em> of semaphore sindex the semaphores
+ *  of the hosts whose bits are set are <em>upped</em> as well. As the mask is read after the <em>up</em>,
+ *  either the last try of the host succeeds or the host is notified.
+ *
+ *  To be called by every process that makes <em>ups</em> on the set.
+ *
+ *  \param semgid set identifier (-1 to stop notifying)
+ *  \param mask hosts to notify of the ups of each semaphore (bit mask, indexed by location)
+ *  \param snum number of locations in <tt>mask</tt>
+ *  \param base location of the semaphore of host 0
+ */
+
+extern void semSetNotify (int semgid, unsigned int *mask, unsigned int snum, unsigned int base);
+
 #endif /* SEMAPHORE_H_ */
@@ -11,6 +11,12 @@
  *  Both the format of the shared data, which represents the full state of the problem, and the identification of
  *  the different semaphores, which carry out the synchronization among the intervening entities, are provided.
  *
+ *  The semaphores used to notify a seated group are per group, not per table, as a table may be
+ *  shared by several groups. When groups are hosted as coroutines, each host has a semaphore on
+ *  which it waits while none of its groups can run (see semSetNotify), and the groups have no
+ *  semaphores of their own: notices are posted to them instead (see notice.h), so the size of the
+ *  set does not grow with the number of group slots.
+ *
  *  \author Nuno Lau - December 2023
  */
 
@@ -36,7 +42,7 @@ typedef struct
           unsigned int receptionistRequestPossible;
           /** \brief identification of semaphore used by waiter to wait for requests – val = 0  */
           unsigned int waiterRequest;
-          /** \brief identification of semaphore used by groups and chef to wait before issuing waiter request - val = 1 */
+          /** \brief identification of semaphore used by groups to wait before issuing waiter request - val = 1 */
           unsigned int waiterRequestPossible;
           /** \brief identification of semaphore used by chef to wait for order – val = 0  */
           unsigned int waitOrder;
@@ -45,16 +51,27 @@ typedef struct
           /** \brief identification of semaphore used by groups to wait for table – val = 0 */
           unsigned int waitForTable[MAXGROUPS];
           /** \brief identification of semaphore used by groups to wait for waiter ackowledge – val = 0  */
-          unsigned int requestReceived[NUMTABLES];
+          unsigned int requestReceived[MAXGROUPS];
           /** \brief identification of semaphore used by groups to wait for food – val = 0 */
-          unsigned int foodArrived[NUMTABLES];
+          unsigned int foodArrived[MAXGROUPS];
           /** \brief identification of semaphore used by groups to wait for payment completed – val = 0 */
-          unsigned int tableDone[NUMTABLES];
+          unsigned int tableDone[MAXGROUPS];
+          /** \brief identification of semaphore used by each host to wait while none of its groups can run – val = 0 */
+          unsigned int groupHost[MAXHOSTS];
 
         } SHARED_DATA;
 
+/** \brief set if the groups of a restaurant run as coroutines, with no semaphores of their own */
+#define COROUTINES(f)        (((f)->groupHosts > 0) && ((f)->launch == LAUNCH_EXEC))
+
+/** \brief number of semaphores of each array of the groups */
+#define GROUPSEMS(f)         (COROUTINES (f) ? 0 : (f)->nGroups)
+
+/** \brief number of semaphores in the set of a restaurant */
+#define SEMS(f)              ( 7 + 4*GROUPSEMS (f) + (f)->groupHosts )
+
 /** \brief number of semaphores in the set */
-#define SEM_NU               ( 7 + sh->fSt.nGroups + 3*NUMTABLES )
+#define SEM_NU               SEMS (&sh->fSt)
 
 #define MUTEX                  1
 #define RECEPTIONISTREQ        2
@@ -64,8 +81,9 @@ typedef struct
 #define WAITORDER              6
 #define ORDERRECEIVED          7
 #define WAITFORTABLE           8
-#define FOODARRIVED            (WAITFORTABLE+sh->fSt.nGroups)
-#define REQUESTRECEIVED        (FOODARRIVED+NUMTABLES)
-#define TABLEDONE              (REQUESTRECEIVED+NUMTABLES)
+#define FOODARRIVED            (WAITFORTABLE+GROUPSEMS (&sh->fSt))
+#define REQUESTRECEIVED        (FOODARRIVED+GROUPSEMS (&sh->fSt))
+#define TABLEDONE              (REQUESTRECEIVED+GROUPSEMS (&sh->fSt))
+#define GROUPHOST              (TABLEDONE+GROUPSEMS (&sh->fSt))
 
 #endif /* SHAREDDATASYNC_H_ */
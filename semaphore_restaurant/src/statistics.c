@@ -0,0 +1,248 @@
+/**
+ *  \file statistics.c (implementation file)
+ *
+ *  \brief Problem name: Restaurant
+ *
+ *  \brief Time measurement and latency histograms.
+ *
+ *  Histograms are log-linear: values below HISTSUB have a bucket of their own, larger values
+ *  share HISTSUB buckets per power of two. They have a fixed size, so they can live in the
+ *  shared memory region and be updated by any entity inside the critical region.
+ *
+ *  Defined operations:
+ *     \li reading the monotonic clock
+ *     \li initialization of a histogram
+ *     \li adding a sample to a histogram
+ *     \li adding a sample to a histogram shared by several processes
+ *     \li computing the mean and percentiles of a histogram
+ *     \li initialization, update and merging of a timeline
+ *     \li recording the wakeup latency of a server
+ *     \li measuring the wakeup latency of every semaphore
+ *     \li recording the startup latency of an entity.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "probConst.h"
+#include "probDataStruct.h"
+#include "sharedDataSync.h"
+#include "semaphore.h"
+#include "statistics.h"
+
+/** \brief full state of the problem whose semaphores are timed */
+static FULL_STAT *timed;
+
+/* internal functions */
+
+static unsigned int semKind (unsigned int sindex)
+{
+    unsigned int n = GROUPSEMS (timed);
+
+    if (sindex < WAITFORTABLE) {
+        return sindex;                                                                 /* the servers */
+    }
+    if (sindex < WAITFORTABLE + 4 * n) {
+        return WAITFORTABLE + (sindex - WAITFORTABLE) / n;                             /* an array of the groups */
+    }
+    return SEMKINDS - 1;                                                                          /* the hosts */
+}
+
+static void semWakeup (unsigned int sindex, long long ns)
+{
+    histAddShared (&timed->semWakeup[semKind (sindex)], ns);
+}
+
+static int timelineAt (TIMELINE *tl, int k)
+{
+    return (k < tl->n) ? tl->max[k] : tl->last;
+}
+
+static void timelineCoarsen (TIMELINE *tl)
+{
+    int k;
+
+    for (k = 0; k < (tl->n + 1) / 2; k++) {                  /* past the last slot, the depth stays the last one */
+        tl->max[k] = (tl->max[2 * k] > timelineAt (tl, 2 * k + 1)) ? tl->max[2 * k] : timelineAt (tl, 2 * k + 1);
+    }
+    tl->n = (tl->n + 1) / 2;
+    tl->slot *= 2;
+}
+
+static int bucketOf (long long v)
+{
+    int e, b;
+
+    if (v < HISTSUB) {
+        return (int) v;
+    }
+    e = 63 - __builtin_clzll ((unsigned long long) v);                         /* position of the leading one */
+    b = (e - HISTSUBBITS + 1) * HISTSUB + (int) ((v >> (e - HISTSUBBITS)) & (HISTSUB - 1));
+    return (b < HISTBUCKETS) ? b : HISTBUCKETS - 1;
+}
+
+static long long bucketTop (int b)
+{
+    int e;
+
+    if (b < HISTSUB) {
+        return b;
+    }
+    e = b / HISTSUB + HISTSUBBITS - 1;
+    return ((long long) (HISTSUB + b % HISTSUB + 1) << (e - HISTSUBBITS)) - 1;
+}
+
+/* external functions */
+
+long long timeNow (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (long long) ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+void histInit (HISTOGRAM *h)
+{
+    memset (h, 0, sizeof (HISTOGRAM));
+}
+
+void histAdd (HISTOGRAM *h, long long v)
+{
+    if (v < 0) {
+        v = 0;
+    }
+    h->count++;
+    h->sum += (double) v;
+    if (v > h->max) {
+        h->max = v;
+    }
+    h->bucket[bucketOf (v)]++;
+}
+
+void histAddShared (HISTOGRAM *h, long long v)
+{
+    long long max = __atomic_load_n (&h->max, __ATOMIC_RELAXED);
+    double sum = h->sum, next;
+
+    if (v < 0) {
+        v = 0;
+    }
+    __atomic_fetch_add (&h->count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add (&h->bucket[bucketOf (v)], 1, __ATOMIC_RELAXED);
+    do {
+        next = sum + (double) v;
+    } while (!__atomic_compare_exchange (&h->sum, &sum, &next, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    while ((v > max) && !__atomic_compare_exchange_n (&h->max, &max, v, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+void histMerge (HISTOGRAM *dst, HISTOGRAM *src)
+{
+    int b;
+
+    dst->count += src->count;
+    dst->sum += src->sum;
+    if (src->max > dst->max) {
+        dst->max = src->max;
+    }
+    for (b = 0; b < HISTBUCKETS; b++) {
+        dst->bucket[b] += src->bucket[b];
+    }
+}
+
+double histMean (HISTOGRAM *h)
+{
+    return (h->count == 0) ? 0.0 : h->sum / h->count;
+}
+
+long long histPercentile (HISTOGRAM *h, double p)
+{
+    unsigned long rank, acc = 0;
+    int b;
+
+    if (h->count == 0) {
+        return 0;
+    }
+    rank = (unsigned long) (p / 100.0 * h->count + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+    for (b = 0; b < HISTBUCKETS; b++) {
+        acc += h->bucket[b];
+        if (acc >= rank) {
+            return (bucketTop (b) < h->max) ? bucketTop (b) : h->max;
+        }
+    }
+    return h->max;
+}
+
+void timelineInit (TIMELINE *tl)
+{
+    tl->slot = 1000LL * TIMESLOT;
+    tl->n = 0;
+    tl->last = 0;
+}
+
+void timelineSet (TIMELINE *tl, long long t, int v)
+{
+    int k, s;
+
+    if (t < 0) {
+        t = 0;
+    }
+    while (t / tl->slot >= TIMESLOTS) {
+        timelineCoarsen (tl);
+    }
+    s = (int) (t / tl->slot);
+    for (k = tl->n; k <= s; k++) {
+        tl->max[k] = tl->last;
+    }
+    if (s >= tl->n) {
+        tl->n = s + 1;
+    }
+    if (v > tl->max[s]) {
+        tl->max[s] = v;
+    }
+    tl->last = v;
+}
+
+void timelineMerge (TIMELINE *dst, TIMELINE *src)
+{
+    TIMELINE t = *src;
+    int k, n;
+
+    while (dst->slot < t.slot) {
+        timelineCoarsen (dst);
+    }
+    while (t.slot < dst->slot) {
+        timelineCoarsen (&t);
+    }
+    n = (dst->n > t.n) ? dst->n : t.n;
+    for (k = 0; k < n; k++) {
+        dst->max[k] = timelineAt (dst, k) + timelineAt (&t, k);
+    }
+    dst->n = n;
+    dst->last += t.last;
+}
+
+void wakeupRecord (FULL_STAT *p_fSt, int server, long long waitStart)
+{
+    long long stamp = p_fSt->wakeupStamp[server];
+
+    if (stamp >= waitStart) {
+        histAdd (&p_fSt->wakeup[server], timeNow () - stamp);
+    }
+}
+
+void semTimingStart (FULL_STAT *p_fSt, int semgid)
+{
+    timed = p_fSt;
+    semSetTiming (semgid, p_fSt->semUpTime, MAXSEMS, semWakeup);
+}
+
+void startupRecord (FULL_STAT *p_fSt, int entity, long long spawn, long long gate)
+{
+    histAddShared (&p_fSt->startup[entity], timeNow () - spawn - gate);
+}
@@ -0,0 +1,156 @@
+/**
+ *  \file statistics.h (interface file)
+ *
+ *  \brief Problem name: Restaurant
+ *
+ *  \brief Time measurement and latency histograms.
+ *
+ *  Defined operations:
+ *     \li reading the monotonic clock
+ *     \li initialization of a histogram
+ *     \li adding a sample to a histogram
+ *     \li adding a sample to a histogram shared by several processes
+ *     \li computing the mean and percentiles of a histogram
+ *     \li initialization, update and merging of a timeline
+ *     \li recording the wakeup latency of a server
+ *     \li measuring the wakeup latency of every semaphore
+ *     \li recording the startup latency of an entity.
+ */
+
+#ifndef STATISTICS_H_
+#define STATISTICS_H_
+
+#include "probDataStruct.h"
+
+/**
+ *  \brief Reading the monotonic clock.
+ *
+ *  \return current time in microseconds
+ */
+extern long long timeNow (void);
+
+/**
+ *  \brief Histogram initialization.
+ *
+ *  \param h pointer to the histogram
+ */
+extern void histInit (HISTOGRAM *h);
+
+/**
+ *  \brief Adding a sample to a histogram.
+ *
+ *  Negative samples are counted as zero.
+ *
+ *  \param h pointer to the histogram
+ *  \param v sample value
+ */
+extern void histAdd (HISTOGRAM *h, long long v);
+
+/**
+ *  \brief Adding a sample to a histogram shared by several processes.
+ *
+ *  Same as histAdd, with atomic updates, so it may be used outside the critical region.
+ *
+ *  \param h pointer to the histogram
+ *  \param v sample (negative values are taken as 0)
+ */
+extern void histAddShared (HISTOGRAM *h, long long v);
+
+/**
+ *  \brief Adding the samples of a histogram to another.
+ *
+ *  \param dst pointer to the histogram that gets the samples
+ *  \param src pointer to the histogram whose samples are added
+ */
+extern void histMerge (HISTOGRAM *dst, HISTOGRAM *src);
+
+/**
+ *  \brief Mean of the samples in a histogram.
+ *
+ *  \param h pointer to the histogram
+ *
+ *  \return mean value (0 if the histogram is empty)
+ */
+extern double histMean (HISTOGRAM *h);
+
+/**
+ *  \brief Percentile of the samples in a histogram.
+ *
+ *  The result is the upper bound of the bucket holding the percentile, so its relative error
+ *  is bounded by the bucket width (1/HISTSUB of the value).
+ *
+ *  \param h pointer to the histogram
+ *  \param p percentile (0 .. 100)
+ *
+ *  \return percentile value (0 if the histogram is empty)
+ */
+extern long long histPercentile (HISTOGRAM *h, double p);
+
+/**
+ *  \brief Timeline initialization.
+ *
+ *  \param tl pointer to the timeline
+ */
+extern void timelineInit (TIMELINE *tl);
+
+/**
+ *  \brief Changing the value of a timeline.
+ *
+ *  The slots since the last change get the previous value, the slot of the change the largest of both.
+ *
+ *  \param tl pointer to the timeline
+ *  \param t time of the change, from the start of operations (us)
+ *  \param v new value
+ */
+extern void timelineSet (TIMELINE *tl, long long t, int v);
+
+/**
+ *  \brief Adding a timeline to another.
+ *
+ *  The finer timeline is brought to the slots of the coarser one, then the values of each slot are
+ *  added (an upper bound of the largest value of the sum).
+ *
+ *  \param dst pointer to the timeline that gets the values
+ *  \param src pointer to the timeline whose values are added
+ */
+extern void timelineMerge (TIMELINE *dst, TIMELINE *src);
+
+/**
+ *  \brief Recording the wakeup latency of a server.
+ *
+ *  To be called by the server once the down of its request semaphore returns. The time since the last
+ *  up (see wakeupStamp) is added to its histogram only if the up came while it was waiting, so
+ *  requests that were already pending are not counted.
+ *
+ *  \param p_fSt pointer to the location where the full internal state of the problem is stored
+ *  \param server server id (SRV_*)
+ *  \param waitStart time at which the server started waiting (us)
+ */
+extern void wakeupRecord (FULL_STAT *p_fSt, int server, long long waitStart);
+
+/**
+ *  \brief Measuring the wakeup latency of every semaphore.
+ *
+ *  From then on, the ups of the calling process on the semaphore set are stamped in semUpTime and the
+ *  downs that block add their wakeup latency to semWakeup, by kind of semaphore (see SEMKINDS and
+ *  semSetTiming).
+ *
+ *  \param p_fSt pointer to the location where the full internal state of the problem is stored
+ *  \param semgid semaphore set access identifier
+ */
+extern void semTimingStart (FULL_STAT *p_fSt, int semgid);
+
+/**
+ *  \brief Recording the startup latency of an entity.
+ *
+ *  To be called by the entity once it is ready to run its life cycle. The time since it was launched,
+ *  less the time it was blocked waiting for the start of operations, is added to its histogram.
+ *
+ *  \param p_fSt pointer to the location where the full internal state of the problem is stored
+ *  \param entity entity (SRV_* or ENT_GROUPS)
+ *  \param spawn time at which the entity was launched (us)
+ *  \param gate time the entity was blocked waiting for the start of operations (us)
+ */
+extern void startupRecord (FULL_STAT *p_fSt, int entity, long long spawn, long long gate);
+
+#endif /* STATISTICS_H_ */
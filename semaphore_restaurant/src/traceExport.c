@@ -0,0 +1,239 @@
+/**
+ *  \file traceExport.c (implementation file)
+ *
+ *  \brief Problem name: Restaurant
+ *
+ *  Conversion of a trace file (see logging.c) into Chrome Trace Event JSON, to be opened in
+ *  Perfetto or chrome://tracing.
+ *
+ *  Upon execution, one or two parameters are requested:
+ *    \li name of the trace file
+ *    \li name of the JSON file (stdout if missing).
+ *
+ *  Each entity (chef, waiter, receptionist, group slot) is a track and each state it goes through
+ *  is a span named after the state. Groups have no span while they are gone (LEAVING).
+ *  The handoffs of a food order are drawn as flow arrows, inferred from the order of the states:
+ *    \li group FOOD_REQUEST -> waiter INFORM_CHEF (requests are taken in order)
+ *    \li waiter INFORM_CHEF -> chef COOK
+ *    \li chef COOK -> waiter TAKE_TO_TABLE (one trip takes all food ready)
+ *    \li waiter TAKE_TO_TABLE -> group EAT.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "probConst.h"
+
+/** \brief number of entities: chef, waiter, receptionist and group slots */
+#define  NENT           (3 + MAXGROUPS)
+
+/** \brief maximum length of a trace line (the time, then a space and up to 10 digits per entity) */
+#define  LINELEN        (32 + 11 * NENT)
+
+/** \brief entity ids (track ids are entity id + 1) */
+#define  CH             0
+#define  WT             1
+#define  RT             2
+#define  GR             3
+
+/** \brief maximum number of pending handoffs of a kind */
+#define  MAXPEND        (4 * MAXGROUPS)
+
+/**
+ *  \brief Definition of a queue of pending handoffs (flow start points).
+ */
+typedef struct {
+    /** \brief track of each flow start */
+    int tid[MAXPEND];
+    /** \brief time of each flow start (us) */
+    long long ts[MAXPEND];
+    /** \brief first pending handoff */
+    int head;
+    /** \brief number of pending handoffs */
+    int n;
+} PENDING;
+
+/** \brief names of the states of each kind of entity */
+static const char *chefNames[] = { "wait for order", "cook", "rest" };
+static const char *waiterNames[] = { "wait for request", "inform chef", "take to table" };
+static const char *receptionistNames[] = { "wait for request", "assign table", "receive payment" };
+static const char *groupNames[GROUPSTATES] = { "?", "go to restaurant", "at reception", "food request",
+                                               "wait for food", "eat", "checkout", "leaving" };
+
+/** \brief output file */
+static FILE *out;
+
+/** \brief true until the first event is written */
+static bool first = true;
+
+/** \brief last flow id */
+static int flowId;
+
+/* internal functions */
+
+static const char *stateName (int e, unsigned int st)
+{
+    switch (e) {
+        case CH: return (st < 3) ? chefNames[st] : "?";
+        case WT: return (st < 3) ? waiterNames[st] : "?";
+        case RT: return (st < 3) ? receptionistNames[st] : "?";
+        default: return (st < GROUPSTATES) ? groupNames[st] : "?";
+    }
+}
+
+static void event (const char *fmt, const char *name, int tid, long long ts, long long arg)
+{
+    fprintf (out, first ? "\n  " : ",\n  ");
+    first = false;
+    fprintf (out, fmt, name, tid, ts, arg);
+}
+
+/** \brief span of an entity in a state */
+static void span (int e, unsigned int st, long long ts, long long dur)
+{
+    if ((e >= GR) && ((st == LEAVING) || (st == 0))) {
+        return;
+    }
+    event ("{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%lld,\"dur\":%lld}", stateName (e, st), e + 1, ts, dur);
+}
+
+/** \brief flow arrow from a pending handoff to a track */
+static void flow (int fromTid, long long fromTs, int toTid, long long toTs)
+{
+    flowId++;
+    event ("{\"name\":\"%s\",\"ph\":\"s\",\"cat\":\"handoff\",\"pid\":1,\"tid\":%d,\"ts\":%lld,\"id\":%lld}",
+           "handoff", fromTid, fromTs, flowId);
+    event ("{\"name\":\"%s\",\"ph\":\"f\",\"bp\":\"e\",\"cat\":\"handoff\",\"pid\":1,\"tid\":%d,\"ts\":%lld,\"id\":%lld}",
+           "handoff", toTid, toTs, flowId);
+}
+
+static void push (PENDING *q, int tid, long long ts)
+{
+    if (q->n == MAXPEND) {                                                          /* drop the oldest */
+        q->head = (q->head + 1) % MAXPEND;
+        q->n--;
+    }
+    q->tid[(q->head + q->n) % MAXPEND] = tid;
+    q->ts[(q->head + q->n) % MAXPEND] = ts;
+    q->n++;
+}
+
+static bool pop (PENDING *q, int *tid, long long *ts)
+{
+    if (q->n == 0) {
+        return false;
+    }
+    *tid = q->tid[q->head];
+    *ts = q->ts[q->head];
+    q->head = (q->head + 1) % MAXPEND;
+    q->n--;
+    return true;
+}
+
+/**
+ *  \brief Main program.
+ */
+int main (int argc, char *argv[])
+{
+    FILE *in;
+    static char line[LINELEN];
+    char *p, name[32];
+    unsigned int st[NENT], cur[NENT], prev;
+    long long since[NENT], t, t0 = -1, last = 0, ts;
+    int nEnt = 0, n, e, offs, tid;
+    static PENDING orders, toChef, ready;                                  /* handoffs waiting for their target */
+    long long delivery = -1;                                          /* start of the last trip to the tables */
+
+    if ((argc < 2) || (argc > 3)) {
+        fprintf (stderr, "USAGE: %s «trace file» [«json file»]\n", argv[0]);
+        exit (EXIT_FAILURE);
+    }
+    if ((in = fopen (argv[1], "r")) == NULL) {
+        perror ("error on opening the trace file");
+        exit (EXIT_FAILURE);
+    }
+    out = stdout;
+    if ((argc == 3) && ((out = fopen (argv[2], "w")) == NULL)) {
+        perror ("error on creating the JSON file");
+        exit (EXIT_FAILURE);
+    }
+
+    fprintf (out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    while (fgets (line, LINELEN, in) != NULL) {
+        if ((line[0] == '#') || (sscanf (line, "%lld%n", &t, &offs) != 1)) {
+            continue;
+        }
+        for (p = line + offs, n = 0; (n < NENT) && (sscanf (p, "%u%n", &cur[n], &offs) == 1); n++) {
+            p += offs;
+        }
+        if (t0 == -1) {                                                                     /* first state */
+            t0 = t;
+            nEnt = n;
+            for (e = 0; e < nEnt; e++) {
+                st[e] = cur[e];
+                since[e] = 0;
+                if (e >= GR) {
+                    sprintf (name, "group %02d", e - GR);
+                }
+                else strcpy (name, (e == CH) ? "chef" : (e == WT) ? "waiter" : "receptionist");
+                event ("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%2$d,\"args\":{\"name\":\"%1$s\"}}",
+                       name, e + 1, 0, 0);
+                event ("{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%2$d,\"args\":{\"sort_index\":%2$d}}",
+                       name, e + 1, 0, 0);
+            }
+            continue;
+        }
+        ts = t - t0;
+        last = ts;
+        for (e = 0; (e < nEnt) && (e < n); e++) {
+            if (cur[e] == st[e]) {
+                continue;
+            }
+            span (e, st[e], since[e], ts - since[e]);
+            prev = st[e];
+            st[e] = cur[e];
+            since[e] = ts;
+
+            /* handoffs of a food order */
+            if ((e >= GR) && (cur[e] == FOOD_REQUEST)) {
+                push (&orders, e + 1, ts);
+            }
+            else if ((e == WT) && (cur[e] == INFORM_CHEF)) {
+                if (pop (&orders, &tid, &t)) {
+                    flow (tid, t, WT + 1, ts);
+                }
+                push (&toChef, WT + 1, ts);
+            }
+            else if ((e == CH) && (cur[e] == COOK)) {
+                if (pop (&toChef, &tid, &t)) {
+                    flow (tid, t, CH + 1, ts);
+                }
+            }
+            else if ((e == CH) && (prev == COOK)) {                                       /* food is ready */
+                push (&ready, CH + 1, ts - 1);
+            }
+            else if ((e == WT) && (cur[e] == TAKE_TO_TABLE)) {
+                while (pop (&ready, &tid, &t)) {
+                    flow (tid, t, WT + 1, ts);
+                }
+                delivery = ts;
+            }
+            else if ((e >= GR) && (cur[e] == EAT) && (delivery >= 0)) {
+                flow (WT + 1, delivery, e + 1, ts);
+            }
+        }
+    }
+    for (e = 0; e < nEnt; e++) {                                                 /* states until the end */
+        span (e, st[e], since[e], last - since[e]);
+    }
+    fprintf (out, "\n]}\n");
+    fclose (in);
+    if (fclose (out) == EOF) {
+        perror ("error on writing the JSON file");
+        exit (EXIT_FAILURE);
+    }
+
+    return EXIT_SUCCESS;
+}
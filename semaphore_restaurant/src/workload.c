@@ -0,0 +1,77 @@
+/**
+ *  \file workload.c (implementation file)
+ *
+ *  \brief Problem name: Restaurant
+ *
+ *  \brief Open-loop workload generation.
+ *
+ *  Arrivals are generated independently of the state of the restaurant:
+ *     \li Poisson: exponential inter-arrival times with mean 1/rate
+ *     \li bursty: Poisson arrivals during on periods, none during off periods
+ *     \li diurnal: Poisson arrivals with rate <tt>rate * (1 + amplitude * sin(2 pi t / period))</tt>,
+ *         generated by thinning a Poisson process of the peak rate.
+ *
+ *  Defined operations:
+ *     \li sampling the next arrival time of a group
+ *     \li sampling the meal time of a group
+ *     \li sampling the size of a group.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "probConst.h"
+#include "probDataStruct.h"
+#include "rng.h"
+
+/* external functions */
+
+long long nextArrival (GENERATOR *gen, RNG *rng, long long t)
+{
+    double meanGap = 1000000.0 / gen->rate;                                           /* mean gap at base rate (us) */
+    long long cycle;
+
+    switch (gen->arrivals) {
+        case ARRIVALS_BURSTY:
+            t += (long long) rngExp (rng, meanGap);
+            cycle = 1000LL * (gen->onTime + gen->offTime);
+            while (t % cycle >= 1000LL * gen->onTime) {   /* shift past the off period, keeping the rest of the gap */
+                t += 1000LL * gen->offTime;
+            }
+            return t;
+        case ARRIVALS_DIURNAL:
+            do {
+                t += (long long) rngExp (rng, meanGap / (1.0 + gen->amplitude));
+            } while (rngUniform (rng) * (1.0 + gen->amplitude) >
+                     1.0 + gen->amplitude * sin (2.0 * M_PI * t / (1000.0 * gen->period)));
+            return t;
+        default:
+            return t + (long long) rngExp (rng, meanGap);
+    }
+}
+
+int sampleMealTime (GENERATOR *gen, RNG *rng)
+{
+    double v;
+
+    switch (gen->meal) {
+        case MEAL_UNIFORM:
+            v = gen->mealA + rngUniform (rng) * (gen->mealB - gen->mealA);
+            break;
+        case MEAL_NORMAL:
+            v = gen->mealA + gen->mealB * rngNormal (rng);
+            break;
+        case MEAL_EXP:
+            v = rngExp (rng, gen->mealA);
+            break;
+        default:
+            v = gen->mealA;
+    }
+    return (v > 0.0) ? (int) v : 0;
+}
+
+int sampleGroupSize (GENERATOR *gen, RNG *rng)
+{
+    return gen->minSize + (int) (rngUniform (rng) * (gen->maxSize - gen->minSize + 1));
+}
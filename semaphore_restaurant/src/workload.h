@@ -0,0 +1,51 @@
+/**
+ *  \file workload.h (interface file)
+ *
+ *  \brief Problem name: Restaurant
+ *
+ *  \brief Open-loop workload generation.
+ *
+ *  Defined operations:
+ *     \li sampling the next arrival time of a group
+ *     \li sampling the meal time of a group
+ *     \li sampling the size of a group.
+ */
+
+#ifndef WORKLOAD_H_
+#define WORKLOAD_H_
+
+#include "probDataStruct.h"
+#include "rng.h"
+
+/**
+ *  \brief Sampling the next arrival time.
+ *
+ *  \param gen pointer to the generator parameters
+ *  \param rng pointer to the random number stream
+ *  \param t time of the previous arrival (us since start of simulation)
+ *
+ *  \return time of next arrival (us since start of simulation)
+ */
+extern long long nextArrival (GENERATOR *gen, RNG *rng, long long t);
+
+/**
+ *  \brief Sampling the meal time of a group.
+ *
+ *  \param gen pointer to the generator parameters
+ *  \param rng pointer to the random number stream
+ *
+ *  \return meal time (us, not negative)
+ */
+extern int sampleMealTime (GENERATOR *gen, RNG *rng);
+
+/**
+ *  \brief Sampling the size of a group.
+ *
+ *  \param gen pointer to the generator parameters
+ *  \param rng pointer to the random number stream
+ *
+ *  \return group size, uniformly distributed between minSize and maxSize
+ */
+extern int sampleGroupSize (GENERATOR *gen, RNG *rng);
+
+#endif /* WORKLOAD_H_ */
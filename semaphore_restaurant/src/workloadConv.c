@@ -0,0 +1,123 @@
+/**
+ *  \file workloadConv.c (implementation file)
+ *
+ *  \brief Problem name: Restaurant
+ *
+ *  Conversion of a text workload into a binary workload file.
+ *
+ *  Upon execution, two parameters are requested:
+ *    \li name of the text file
+ *    \li name of the binary workload file.
+ *
+ *  The text file has one line per group, <tt>startTime timeToEat [groupSize]</tt> (us, size GROUPSIZE
+ *  by default). If it has section headers, as the configuration file does, only the lines of the
+ *  <tt>#startTime</tt> section are converted. Groups are written sorted by start time, which becomes
+ *  their arrival time.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdbool.h>
+
+#include "probConst.h"
+#include "workloadFile.h"
+
+/** \brief maximum length of a text line */
+#define  LINELEN        256
+
+/** \brief records read, growing array */
+static WL_RECORD *rec;
+/** \brief number of records read */
+static size_t nRec;
+/** \brief number of records allocated */
+static size_t maxRec;
+
+/**
+ *  \brief Ordering of records by arrival time.
+ */
+static int byArrival (const void *a, const void *b)
+{
+    const WL_RECORD *ra = a, *rb = b;
+
+    return (ra->arrival > rb->arrival) - (ra->arrival < rb->arrival);
+}
+
+/**
+ *  \brief Main program.
+ */
+int main (int argc, char *argv[])
+{
+    FILE *fp;
+    char line[LINELEN], section[LINELEN];
+    char *p;
+    long long start;
+    int eat, size, n, nLine = 0;
+    bool rows = true;                                                 /* no section header: every line is a group */
+    WL_HEADER hd;
+
+    if (argc != 3) {
+        fprintf (stderr, "USAGE: %s «text workload» «binary workload»\n", argv[0]);
+        exit (EXIT_FAILURE);
+    }
+
+    if ((fp = fopen (argv[1], "r")) == NULL) {
+        perror ("error on opening the text workload");
+        exit (EXIT_FAILURE);
+    }
+    while (fgets (line, LINELEN, fp) != NULL) {
+        nLine++;
+        for (p = line; isspace ((unsigned char) *p); p++);
+        if (*p == '\0') {
+            continue;
+        }
+        if (*p == '#') {
+            rows = (sscanf (p + 1, "%s", section) == 1) && (strcmp (section, "startTime") == 0);
+            continue;
+        }
+        if (!rows) {
+            continue;
+        }
+        n = sscanf (p, "%lld %d %d", &start, &eat, &size);
+        if (n == 2) {
+            size = GROUPSIZE;
+        }
+        if ((n < 2) || (start < 0) || (eat < 0) || (size < 1)) {
+            fprintf (stderr, "%s:%d: expected <startTime> <timeToEat> [<groupSize>]\n", argv[1], nLine);
+            exit (EXIT_FAILURE);
+        }
+        if (nRec == maxRec) {
+            maxRec = (maxRec == 0) ? 4096 : 2 * maxRec;
+            if ((rec = realloc (rec, maxRec * sizeof (WL_RECORD))) == NULL) {
+                perror ("error on allocating the workload");
+                exit (EXIT_FAILURE);
+            }
+        }
+        rec[nRec].arrival = start;
+        rec[nRec].eatTime = eat;
+        rec[nRec].size = size;
+        nRec++;
+    }
+    fclose (fp);
+
+    qsort (rec, nRec, sizeof (WL_RECORD), byArrival);
+
+    hd.magic = WL_MAGIC;
+    hd.version = WL_VERSION;
+    hd.count = nRec;
+    if ((fp = fopen (argv[2], "wb")) == NULL) {
+        perror ("error on creating the binary workload");
+        exit (EXIT_FAILURE);
+    }
+    if ((fwrite (&hd, sizeof (hd), 1, fp) != 1) || (fwrite (rec, sizeof (WL_RECORD), nRec, fp) != nRec) ||
+        (fclose (fp) != 0)) {
+        perror ("error on writing the binary workload");
+        exit (EXIT_FAILURE);
+    }
+    free (rec);
+
+    printf ("%zu groups written to %s\n", nRec, argv[2]);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,95 @@
+/**
+ *  \file workloadFile.c (implementation file)
+ *
+ *  \brief Problem name: Restaurant
+ *
+ *  \brief Binary workload files.
+ *
+ *  The file is mapped read-only and read sequentially. Every WL_WINDOW bytes the part already read
+ *  is dropped from the process (the kernel is advised of both), so a workload of millions of
+ *  groups is consumed with a bounded amount of memory.
+ *
+ *  Defined operations:
+ *     \li opening a workload file as a read-only stream
+ *     \li reading the next group of the stream
+ *     \li closing the stream.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "workloadFile.h"
+
+/** \brief amount of the mapping that is read before it is released (bytes, multiple of the page size) */
+#define  WL_WINDOW      (1 << 20)
+
+/* external functions */
+
+int wlOpen (char nFic[], WL_STREAM *ws)
+{
+    struct stat st;
+    const WL_HEADER *hd;
+    int fd;
+
+    if ((fd = open (nFic, O_RDONLY)) == -1) {
+        return -1;
+    }
+    if (fstat (fd, &st) == -1) {
+        close (fd);
+        return -1;
+    }
+    if ((size_t) st.st_size < sizeof (WL_HEADER)) {
+        close (fd);
+        errno = EINVAL;
+        return -1;
+    }
+    ws->len = (size_t) st.st_size;
+    ws->map = mmap (NULL, ws->len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close (fd);                                                               /* the mapping keeps the file */
+    if (ws->map == MAP_FAILED) {
+        return -1;
+    }
+
+    hd = (const WL_HEADER *) ws->map;
+    if ((hd->magic != WL_MAGIC) || (hd->version != WL_VERSION) ||
+        (hd->count > (ws->len - sizeof (WL_HEADER)) / sizeof (WL_RECORD))) {
+        munmap (ws->map, ws->len);
+        errno = EINVAL;
+        return -1;
+    }
+    madvise (ws->map, ws->len, MADV_SEQUENTIAL);
+    ws->rec = (const WL_RECORD *) (ws->map + sizeof (WL_HEADER));
+    ws->count = hd->count;
+    ws->next = 0;
+    ws->released = 0;
+
+    return 0;
+}
+
+bool wlNext (WL_STREAM *ws, WL_RECORD *rec)
+{
+    size_t pos;
+
+    if (ws->next >= ws->count) {
+        return false;
+    }
+    *rec = ws->rec[ws->next++];
+
+    pos = sizeof (WL_HEADER) + ws->next * sizeof (WL_RECORD);
+    if (pos - ws->released >= 2 * WL_WINDOW) {                       /* keep the window being read */
+        madvise (ws->map + ws->released, WL_WINDOW, MADV_DONTNEED);
+        ws->released += WL_WINDOW;
+    }
+    return true;
+}
+
+void wlClose (WL_STREAM *ws)
+{
+    munmap (ws->map, ws->len);
+    ws->map = NULL;
+}
@@ -0,0 +1,104 @@
+/**
+ *  \file workloadFile.h (interface file)
+ *
+ *  \brief Problem name: Restaurant
+ *
+ *  \brief Binary workload files.
+ *
+ *  A workload file is a header followed by one record per group, sorted by arrival time.
+ *  All fields are in the byte order of the machine that wrote the file.
+ *
+ *  Defined operations:
+ *     \li opening a workload file as a read-only stream
+ *     \li reading the next group of the stream
+ *     \li closing the stream.
+ */
+
+#ifndef WORKLOADFILE_H_
+#define WORKLOADFILE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** \brief magic number of a workload file ("RWLF") */
+#define  WL_MAGIC         0x464c5752
+/** \brief version of the workload file format */
+#define  WL_VERSION       1
+
+/**
+ *  \brief Header of a workload file.
+ */
+typedef struct {
+    /** \brief WL_MAGIC */
+    uint32_t magic;
+    /** \brief WL_VERSION */
+    uint32_t version;
+    /** \brief number of records */
+    uint64_t count;
+} WL_HEADER;
+
+/**
+ *  \brief Record of a workload file: one group.
+ */
+typedef struct {
+    /** \brief arrival time (us since start of simulation) */
+    int64_t arrival;
+    /** \brief meal time (us) */
+    int32_t eatTime;
+    /** \brief group size */
+    int32_t size;
+} WL_RECORD;
+
+/**
+ *  \brief Workload file opened as a stream.
+ */
+typedef struct {
+    /** \brief start of the mapping */
+    unsigned char *map;
+    /** \brief length of the mapping (bytes) */
+    size_t len;
+    /** \brief records */
+    const WL_RECORD *rec;
+    /** \brief number of records */
+    size_t count;
+    /** \brief next record to read */
+    size_t next;
+    /** \brief bytes of the mapping already released */
+    size_t released;
+} WL_STREAM;
+
+/**
+ *  \brief Opening a workload file as a read-only stream.
+ *
+ *  The file is mapped, not read: opening takes constant time whatever its size.
+ *  The function fails if the file can not be mapped or is not a workload file (<tt>errno</tt> is \c EINVAL).
+ *
+ *  \param nFic name of the workload file
+ *  \param ws pointer to the stream
+ *
+ *  \return \c 0, upon success
+ *  \return -\c 1, when an error occurs (the actual situation is reported in <tt>errno</tt>)
+ */
+extern int wlOpen (char nFic[], WL_STREAM *ws);
+
+/**
+ *  \brief Reading the next record of a workload stream.
+ *
+ *  Pages already read are released, so that the memory used stays bounded.
+ *
+ *  \param ws pointer to the stream
+ *  \param rec pointer to the location where the record is stored
+ *
+ *  \return true if a record was read, false at the end of the stream
+ */
+extern bool wlNext (WL_STREAM *ws, WL_RECORD *rec);
+
+/**
+ *  \brief Closing a workload stream.
+ *
+ *  \param ws pointer to the stream
+ */
+extern void wlClose (WL_STREAM *ws);
+
+#endif /* WORKLOADFILE_H_ */